@@ -202,7 +202,8 @@ class AudioBlock : public Asset {
     static AudioBlock * CreateHit(float pitch, float impact, float roughness, uint8_t volume, int compound);
 
   private:
-
+    // replaces the sample data, taking ownership of it.
+    void setData(char * data, uint32_t size);
 
 
     std::string path;
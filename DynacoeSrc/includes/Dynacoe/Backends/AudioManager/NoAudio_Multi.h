@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 #define H_DC_NOAUDIO_INCLUDED
 
 #include <Dynacoe/Backends/AudioManager/AudioManager.h>
+#include <atomic>
 
 namespace Dynacoe {
 class NoAudioManager : public AudioManager {
@@ -54,6 +55,10 @@ class NoAudioManager : public AudioManager {
     std::string Version();
     bool Valid();
 
+  private:
+    // 0 until SetSampleRate() is called, which keeps the mixer idle.
+    // Otherwise, mixed audio is accepted and thrown away.
+    std::atomic<uint32_t> sampleRate{0};
 };
 }
 
@@ -31,75 +31,100 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #ifdef DC_BACKENDS_PIXMAP_X11
+#ifndef H_DC_DISPLAY_PIXMAP_X11
+#define H_DC_DISPLAY_PIXMAP_X11
 
-#ifndef H_DC_PIXMAP_X11_BACKENDS
-#define H_DC_PIXMAP_X11_BACKENDS
+/*
+    PixmapDisplay
+
+    An X11 window that shows RGBA pixel array framebuffers, such as 
+    the ones the software renderer draws into, by copying them to the 
+    window with XPutImage. No GL context is needed.
 
+ */
 
 #include <X11/X.h>
 #include <X11/Xlib.h>
+#include <X11/Xutil.h>
 typedef Display X11Display; 
 
-#include <Dynacoe/Shader.h>
 #include <vector>
 #include <Dynacoe/Backends/Display/Display.h>
 
 
+namespace Dynacoe {
 
 
+class PixmapDisplay : public Dynacoe::Display {
+  public:
+    PixmapDisplay();
+    ~PixmapDisplay();
 
-namespace Dynacoe {
-struct DisplayImpl {
-    
 
-    DisplayImpl();
+    std::string Name();
+    std::string Version();
+    bool Valid();
 
 
+    void Resize(int, int);
+    void SetPosition(int, int);
+    void Fullscreen(bool);
+    void Hide(bool);
+    bool HasInputFocus();
+    void LockClientResize(bool);
+    void LockClientPosition(bool);
+    void SetViewPolicy(ViewPolicy);
+    
+    int Width();
+    int Height();
+    int X();
+    int Y();
+
+    void SetName(const std::string &);
+    void AddResizeCallback(ResizeCallback *);
+    void RemoveResizeCallback(ResizeCallback *);
+    void AddCloseCallback(CloseCallback *);
+    void RemoveCloseCallback(CloseCallback *);
+
+    bool IsCapable(Dynacoe::Display::Capability);
+    void Update();
+    void AttachSource(Dynacoe::Framebuffer *);
+    std::vector<Dynacoe::Framebuffer::Type> SupportedFramebuffers();
+    Dynacoe::Framebuffer * GetSource();
+    
+
+    void * GetSystemHandle();
+    DisplayHandleType GetSystemHandleType();
+    void * GetLastSystemEvent();
+    DisplayEventType GetSystemEventType();
+    
+  private:
     std::vector<Display::ResizeCallback *> resizeCBs;
     std::vector<Display::CloseCallback *> closeCBs;
     
     bool valid;
-    uint32_t flags;
-    int viewX;
-    int viewY;
-    int viewW;
-    int viewH;
-    
-    bool realize();    
-    bool spawnWindow(const char *, int, int);
-    bool createContext();
-    bool queryCapabilities();
-    void drawFrame(int, int);
-
-    GLfloat transformResult[16];
-    unsigned int  winH, winW;
-        
-
-
+    Display::ViewPolicy policy;
+    Dynacoe::Framebuffer * framebuffer;
+    unsigned int winW, winH;
+    int winX, winY;
 
-    X11Display              *dpy;
-    Colormap                cmap;
-    XSetWindowAttributes    swa;
+    X11Display *            dpy;
     Window                  win;
-    Window                  root;
-    XWindowAttributes       gwa;
-    XEvent                  xev;
-    uint8_t                *frame;    
+    GC                      gc;
+    Atom                    deleteMessage;
+    std::vector<XEvent>     lastEvents;
 
+    // window-sized image in the screen's pixel format, and where 
+    // each color channel (red, green, blue) goes in a pixel.
+    XImage *                image;
+    int                     channelShift[3];
+    int                     channelBits[3];
 
-    Pixmap pixmap;
-    XImage * framebuffer;
-    GC gcontext;
-
-    int winX, winY;
-    
     void updateDims();
-
-
-
+    void drawFrame();
 };
-}
 
+}
 
 #endif
 #endif
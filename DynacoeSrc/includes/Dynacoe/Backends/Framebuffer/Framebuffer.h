@@ -131,6 +131,10 @@ class Framebuffer : public Backend {
 
     // Called when SetFilteredHint  is called
     virtual void OnFilterChange(bool) = 0;
+
+    // For children whose handle is the storage itself and
+    // has to be replaced when resized.
+    void SetHandle(void * newData) {data = newData;}
   private:
     int w;
     int h;
@@ -0,0 +1,71 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#ifndef H_DC_BACKENDS_PIXELFB_INCLUDED
+#define H_DC_BACKENDS_PIXELFB_INCLUDED
+
+#include "Framebuffer.h"
+#include <cstdint>
+
+
+// Framebuffer held in system memory as a plain RGBA pixel array,
+// top row first. Used by renderers that draw on the CPU, which also
+// keep their depth values in it.
+
+namespace Dynacoe {
+class PixelFB : public Dynacoe::Framebuffer {
+  public:
+    PixelFB();
+    ~PixelFB();
+
+    bool GetRawData(uint8_t *);
+
+    // One depth value per pixel, for renderers that need it.
+    float * GetDepthData() {return depth;}
+
+    std::string Name();
+    std::string Version();
+    bool Valid();
+
+  private:
+    uint8_t * pixels;
+    float * depth;
+
+  protected:
+    bool OnResize(void *, int, int);
+    void OnFilterChange(bool){}
+};
+
+}
+
+#endif
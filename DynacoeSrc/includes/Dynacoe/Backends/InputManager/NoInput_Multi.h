@@ -34,10 +34,13 @@ DEALINGS IN THE SOFTWARE.
 #define H_DC_NOINPUT_INLCUDED
 
 #include <Dynacoe/Backends/InputManager/InputManager.h>
+#include <vector>
 
 namespace Dynacoe {
 class NoInputManager : public InputManager {
   public:
+    NoInputManager();
+    ~NoInputManager();
 
     // standard interface
     bool IsSupported(InputType);
@@ -54,6 +57,9 @@ class NoInputManager : public InputManager {
     Display * GetFocus();
     void SetFocus(Display*);
 
+  private:
+    // default devices that never receive input
+    std::vector<InputDevice*> devices;
 };
 }
 
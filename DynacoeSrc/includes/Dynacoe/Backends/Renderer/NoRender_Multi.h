@@ -57,6 +57,7 @@ class NoRenderer : public Renderer {
     void Set2DObjectParameters(uint32_t object, Render2DObjectParameters);
     void Render2DVertices(const Render2DStaticParameters &);
     void Clear2DQueue();
+    void Render2DSprites(uint32_t object, const Sprite2D *, uint32_t count, const Render2DStaticParameters &);
     
     void RenderStatic(StaticState *){}
     void ClearRenderedData(){}
@@ -92,11 +93,11 @@ class NoRenderer : public Renderer {
     ProgramID ProgramAdd(const std::string&, const std::string &, std::string &){return ProgramID();}
 
 
-    bool IsSupported(Capability){return false;}
+    bool IsSupported(Capability c){return c == Capability::AnyThread;}
     void SetDrawingMode(Polygon, Dimension, AlphaRule){}
     void GetDrawingMode(Polygon *, Dimension *, AlphaRule *){}
-    void AttachTarget(Dynacoe::Framebuffer *){}
-    Dynacoe::Framebuffer * GetTarget(){return nullptr;}
+    void AttachTarget(Dynacoe::Framebuffer * f){target = f;}
+    Dynacoe::Framebuffer * GetTarget(){return target;}
     std::vector<Dynacoe::Framebuffer::Type> SupportedFramebuffers(){
         return std::vector<Dynacoe::Framebuffer::Type>({
             Dynacoe::Framebuffer::Type::RGBA_PixelArray,
@@ -104,6 +105,12 @@ class NoRenderer : public Renderer {
         });
     }
 
+  private:
+    std::vector<Vertex2D> vertices;
+    std::vector<uint32_t> deadVertices;
+    uint32_t objectCount = 0;
+    std::vector<uint32_t> deadObjects;
+    Dynacoe::Framebuffer * target = nullptr;
 };
 }
 
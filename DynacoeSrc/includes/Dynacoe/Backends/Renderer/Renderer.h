@@ -159,7 +159,11 @@ class Renderer : public Backend {
 
     enum class Capability {
         Lighting,
-        UserShaders
+        UserShaders,
+
+        // The renderer may be driven from a thread other than the 
+        // one that created it, one thread at a time.
+        AnyThread
 
     };
 
@@ -199,6 +203,18 @@ class Renderer : public Backend {
         
     };
 
+    // One textured quad for Render2DSprites.
+    struct Sprite2D {
+        // Affine transform from the unit square to the object's space:
+        // x' = transform[0]*x + transform[2]*y + transform[4]
+        // y' = transform[1]*x + transform[3]*y + transform[5]
+        float transform[6];
+
+        float uvs[4];     // left, top, right, bottom in texture coordinates (0, 0 is topleft)
+        float tint[4];    // multiplies the texture, scale from 0.f to 1.f (red, green, blue, and alpha)
+        float texture;    // texture id, or -1 for a flat tint
+    };
+
 
 
 
@@ -240,6 +256,17 @@ class Renderer : public Backend {
     // Clears all requests queued before the last RenderDynamicQueue
     virtual void Clear2DQueue() = 0;
 
+    // Draws the sprites as triangles, transformed by the given object's parameters 
+    // and then the context, as with Render2DVertices. The sprites are only read during the call
+    // and nothing is kept for them, so this suits large numbers of quads that change every frame.
+    // The 2D queue is left untouched.
+    virtual void Render2DSprites(
+        uint32_t object,
+        const Sprite2D * sprites,
+        uint32_t count,
+        const Render2DStaticParameters &
+    ) = 0;
+
 
 
 
@@ -67,6 +67,7 @@ DEALINGS IN THE SOFTWARE.
 namespace Dynacoe {
 
 enum {
+    GL_Version3_3           =0b100000,
     GL_Version3_0           =0b10000,
     GL_Version3_1           =0b01000,
     GL_Version2_1           =0b00100,
@@ -70,6 +70,9 @@ class RenderBuffer_Tex1D : public RenderBuffer {
     float * data;
     uint32_t length;
     int size;
+    int uploadedSize;
+    int dirtyFirst;
+    int dirtyLast;
 };
 }
 
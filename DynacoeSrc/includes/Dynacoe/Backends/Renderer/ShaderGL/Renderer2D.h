@@ -88,6 +88,13 @@ class Renderer2D {
 
     // Clears all requests queued before the last RenderDynamicQueue
     void Clear2DQueue();
+
+    // Draws the sprites in one draw call. Returns the number drawn.
+    uint32_t Render2DSprites(uint32_t object, const Renderer::Sprite2D *, uint32_t count, const Renderer::Render2DStaticParameters &);
+
+    // Returns the bytes and the number of calls used to send changed vertices 
+    // and objects since the last time this was called.
+    void TakeUploadCounts(uint32_t & bytes, uint32_t & calls);
   private:
     Renderer2DData * data;
     
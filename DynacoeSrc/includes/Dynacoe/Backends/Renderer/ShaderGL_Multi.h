@@ -87,6 +87,7 @@ struct ShaderGLRenderer : public Dynacoe::Renderer {
     void Set2DObjectParameters(uint32_t object, Render2DObjectParameters);
     void Render2DVertices(const Render2DStaticParameters &);
     void Clear2DQueue();
+    void Render2DSprites(uint32_t object, const Sprite2D *, uint32_t count, const Render2DStaticParameters &);
     
     void RenderStatic(StaticState *);
     void ClearRenderedData();
@@ -139,6 +140,8 @@ struct ShaderGLRenderer : public Dynacoe::Renderer {
     uint32_t diagnostic_dynamic_vtex_render_per_frame;
     uint32_t diagnostic_dynamic_vtex_render_last;
     time_t   diagnostic_dynamic_vtex_render_frame_time;
+    uint32_t diagnostic_dynamic_upload_bytes_last;
+    uint32_t diagnostic_dynamic_upload_calls_last;
     uint32_t diagnostic_static_object_count_per_second;
     time_t   diagnostic_static_object_count_time;
     uint32_t diagnostic_static_object_count_per_second_last;
@@ -0,0 +1,145 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+#ifndef H_DC_BACKENDS_SOFTRASTERIZER
+#define H_DC_BACKENDS_SOFTRASTERIZER
+
+#include <Dynacoe/Backends/Renderer/Renderer.h>
+#include <Dynacoe/Backends/Renderer/SoftRender/SoftTextureStore.h>
+#include <vector>
+#include <cstdint>
+
+
+/* SoftRasterizer,
+   Draws clip-space triangles and lines into a memory color and depth buffer.
+
+   The target is split into square tiles. Each draw is clipped, set up and
+   binned on the calling thread, then the tiles are shaded by a pool of
+   worker threads. A tile is only ever touched by one thread and always
+   draws its primitives in submission order, so the output does not depend
+   on the number of threads or on how they are scheduled.
+
+   Coverage uses integer edge functions with 4 bits of subpixel precision
+   and a top-left fill rule, so edges shared by two triangles are drawn
+   exactly once. With SSE2, 4 pixels are tested at a time.
+*/
+
+namespace Dynacoe {
+struct SoftRasterizerData;
+class SoftRasterizer {
+  public:
+    static const int TileSize    = 64;
+    static const int MaxVaryings = 8;
+
+    // A transformed vertex. pos is in clip space (before the divide by w).
+    // Varyings are interpolated perspective-correctly.
+    struct Vertex {
+        float pos[4];
+        float var[MaxVaryings];
+    };
+
+    // How fragments get their color. Matches the GL backend's programs.
+    enum class Shading {
+        // var: r, g, b, a, u, v. The texture comes from each primitive.
+        Vertex2D,
+
+        // Basic built-in program. var: u, v
+        Basic,
+
+        // Light material built-in program.
+        // var: u, v, view position xyz, normal xyz
+        LightMaterial
+    };
+
+    struct Light {
+        float pos[3];
+        float color[3];
+        float intensity;
+        bool  directional;
+    };
+
+    // Everything a draw needs besides its geometry.
+    struct State {
+        Shading shading;
+        Renderer::AlphaRule alpha;
+        bool depthTest;
+        bool linearFilter;
+
+        // Static programs: slot 0 is color, slot 1 is shininess.
+        const SoftTexture * textures[2];
+
+        // Framebuffer available for sampling, if any.
+        const uint8_t * sample;
+        int sampleW;
+        int sampleH;
+
+        // Material block: ambient, diffuse (w amount), specular (w amount), shininess
+        float material[16];
+
+        // View transform (column-major) for placing point lights.
+        float view[16];
+        const std::vector<Light> * lights;
+    };
+
+    SoftRasterizer();
+    ~SoftRasterizer();
+
+    // Sets where to draw. The depth buffer holds one float per pixel.
+    void SetTarget(uint8_t * color, float * depth, int w, int h);
+
+    // Fills the color and depth of the target.
+    void Clear(const uint8_t rgba[4], float depth);
+
+    // Draws triangles (every 3 indices) or lines (every 2 indices).
+    // textures, if given, holds one texture per primitive for Vertex2D shading.
+    // Returns once the target holds the result.
+    void Draw(
+        const State & state,
+        const Vertex * vertices,
+        const uint32_t * indices,
+        uint32_t count,
+        bool lines,
+        const SoftTexture * const * textures = nullptr
+    );
+
+    // Number of threads drawing tiles, including the caller.
+    int GetThreadCount() const;
+
+    // Number of primitives drawn after clipping, since creation.
+    uint64_t GetPrimitiveCount() const;
+
+  private:
+    SoftRasterizerData * data;
+};
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+#ifndef H_DC_BACKENDS_SOFTTEXTURESTORE
+#define H_DC_BACKENDS_SOFTTEXTURESTORE
+
+#include <cstdint>
+#include <vector>
+
+namespace Dynacoe {
+
+// A texture kept in system memory: RGBA with no padding, top row first.
+struct SoftTexture {
+    int w;
+    int h;
+    uint8_t * data;
+};
+
+
+// Holds the textures of the software renderer. Unlike the GL backend's
+// atlas, each texture keeps its own storage, so texture coordinates
+// never need remapping.
+class SoftTextureStore {
+  public:
+    SoftTextureStore();
+    ~SoftTextureStore();
+
+    // Add new texture, id is returned. A null data leaves the contents cleared.
+    int NewTexture(int w, int h, const uint8_t * data);
+
+    // Remove texture
+    void DeleteTexture(int tex);
+
+    // Update data of an existing texture
+    void UpdateTexture(int tex, const uint8_t * data);
+
+    // Copies out the texture's pixels.
+    void GetTextureData(int tex, uint8_t *);
+
+    // Returns the texture, or nullptr if the id is not in use.
+    const SoftTexture * Get(int tex) const {
+        return (tex >= 0 && tex < (int)textures.size()) ? textures[tex] : nullptr;
+    }
+
+    int GetCount() const {return textures.size() - dead.size();}
+
+  private:
+    std::vector<SoftTexture*> textures;
+    std::vector<int> dead;
+};
+}
+
+#endif
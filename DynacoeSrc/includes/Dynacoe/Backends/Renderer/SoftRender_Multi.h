@@ -0,0 +1,175 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+#ifndef H_DC_BACKENDS_SOFTRENDER_INCLUDED
+#define H_DC_BACKENDS_SOFTRENDER_INCLUDED
+
+#include <Dynacoe/Backends/Renderer/Renderer.h>
+#include <Dynacoe/Backends/Renderer/SoftRender/SoftRasterizer.h>
+#include <Dynacoe/Backends/Renderer/SoftRender/SoftTextureStore.h>
+#include <vector>
+
+
+/* SoftRenderer,
+   Renderer that draws on the CPU into RGBA_PixelArray framebuffers.
+   It needs no GPU and gives the same image on every machine, which
+   makes it usable for headless runs and for comparing against reference
+   images. 2D vertices, the built-in static programs, lights, blending
+   and the depth test follow the GL backend; user shader programs are not
+   supported.
+*/
+
+namespace Dynacoe {
+class SoftRenderer : public Renderer {
+  public:
+    SoftRenderer();
+    ~SoftRenderer();
+
+    std::string Name();
+    std::string Version();
+    bool Valid();
+
+
+    void Queue2DVertices(
+        const uint32_t * indices,
+        uint32_t count
+    );
+
+    uint32_t Add2DObject();
+    void Remove2DObject(uint32_t);
+    uint32_t Add2DVertex();
+    void Remove2DVertex(uint32_t object);
+    void Set2DVertex(uint32_t vertex, Vertex2D);
+    Vertex2D Get2DVertex(uint32_t vertex);
+    void Set2DObjectParameters(uint32_t object, Render2DObjectParameters);
+    void Render2DVertices(const Render2DStaticParameters &);
+    void Clear2DQueue();
+    void Render2DSprites(uint32_t object, const Sprite2D *, uint32_t count, const Render2DStaticParameters &);
+
+    void RenderStatic(StaticState *);
+    void ClearRenderedData();
+    RenderBufferID GetStaticViewingMatrixID();
+    RenderBufferID GetStaticProjectionMatrixID();
+
+    int AddTexture(int w, int h, const uint8_t * rgbaTextureData);
+    void UpdateTexture(int tex, const uint8_t * newData);
+    void RemoveTexture(int tex);
+    void GetTexture(int tex, uint8_t *);
+    void SetTextureFilter(TexFilter);
+    TexFilter GetTextureFilter();
+    int GetTextureWidth(int tex);
+    int GetTextureHeight(int tex);
+    int MaxSimultaneousTextures();
+
+    RenderBufferID AddBuffer(float * data, int numElements);
+    void UpdateBuffer(RenderBufferID bufferID, float * newData, int offset, int numElements);
+    void ReadBuffer(RenderBufferID bufferID, float * ouputData, int offset, int numELements);
+    int BufferSize(RenderBufferID bufferID);
+    void RemoveBuffer(RenderBufferID bufferID);
+
+    std::string ProgramGetLanguage();
+    ProgramID ProgramAdd(const std::string & vertexSrc, const std::string & fragSrc, std::string & log);
+    ProgramID ProgramGetBuiltIn(BuiltInShaderMode);
+
+    LightID AddLight(LightType);
+    void UpdateLightAttributes(LightID, float *);
+    void EnableLight(LightID, bool doIt);
+    void RemoveLight(LightID);
+    int MaxEnabledLights();
+    int NumLights();
+
+    bool IsSupported(Capability);
+    void SetDrawingMode(Polygon, Dimension, AlphaRule);
+    void GetDrawingMode(Polygon *, Dimension *, AlphaRule *);
+    void AttachTarget(Framebuffer *);
+    Framebuffer * GetTarget();
+    std::vector<Framebuffer::Type> SupportedFramebuffers();
+
+
+    // diagnostics
+    uint64_t diagnostic_dynamic_vtex_per_render_avg;
+    uint64_t diagnostic_dynamic_vtex_per_render_acc;
+    uint64_t diagnostic_dynamic_vtex_per_render_ct;
+    uint64_t diagnostic_static_object_count;
+    SoftRasterizer * GetRasterizer() {return raster;}
+    SoftTextureStore * GetTextureStore() {return textures;}
+
+  private:
+    struct Light {
+        LightType type;
+        bool enabled;
+        SoftRasterizer::Light data;
+    };
+
+    void targetCheck();
+    void syncLights();
+    SoftRasterizer::State baseState();
+
+    SoftRasterizer * raster;
+    SoftTextureStore * textures;
+
+    // 2D
+    std::vector<Vertex2D> vertices;
+    std::vector<uint32_t> deadVertices;
+    std::vector<Render2DObjectParameters> objects;
+    std::vector<uint32_t> deadObjects;
+    std::vector<uint32_t> queued;
+
+    // static
+    Table<std::vector<float>*> buffers;
+    Table<BuiltInShaderMode> programs;
+    RenderBufferID viewID;
+    RenderBufferID projectionID;
+    ProgramID basicProgramID;
+    ProgramID lightProgramID;
+
+    Table<Light*> lights;
+    std::vector<SoftRasterizer::Light> enabledLights;
+    bool lightsDirty;
+
+    // drawing state
+    Polygon polygon;
+    Dimension dimension;
+    AlphaRule alpha;
+    TexFilter filter;
+
+    Framebuffer * target;
+    std::vector<float> depthFallback; // for pixel arrays other than PixelFB
+
+    // scratch space, kept to avoid reallocating
+    std::vector<SoftRasterizer::Vertex> transformed;
+    std::vector<uint32_t> order;
+    std::vector<const SoftTexture*> primTextures;
+};
+}
+
+#endif
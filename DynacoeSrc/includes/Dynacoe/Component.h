@@ -34,6 +34,8 @@ DEALINGS IN THE SOFTWARE.
 #define H_DCOMPONENT_INCLUDED
 
 #include <Dynacoe/Entity.h>
+#include <initializer_list>
+#include <new>
 
 
 namespace Dynacoe {
@@ -61,6 +63,10 @@ class Entity;
  * component is bound to its host. and on-detach, right before the removal sequence is started 
  * for a host.
  *
+ * Event names are interned into EventIDs. For events that are emitted 
+ * often, look up the EventID once with GetEventID() and emit with it; 
+ * this skips the name lookup entirely.
+ *
  *
  */
 class Component {
@@ -75,8 +81,111 @@ class Component {
     ///   argument 1 (Component *) -> "component"
     ///   argument 2 (Entity::ID)  -> "self"
     ///   argument 3 (Entity::ID)  -> "source"
+    ///   argument 4 (EventArgs)   -> "args"
+    ///
+    #define DynacoeEvent(_Name_) bool _Name_(void * functionData, Dynacoe::Component * component, Dynacoe::Entity::ID self, Dynacoe::Entity::ID source, const Dynacoe::Component::EventArgs & args)
+
+
+
+    /// \brief Interned identifier for an event name.
     ///
-    #define DynacoeEvent(_Name_) bool _Name_(void * functionData, Dynacoe::Component * component, Dynacoe::Entity::ID self, Dynacoe::Entity::ID source, const std::vector<std::string> & args)
+    /// The same name always yields the same EventID, regardless of 
+    /// which component it is used with.
+    using EventID = uint32_t;
+
+
+    /// \brief A list of string arguments for an event.
+    ///
+    /// Up to 4 arguments are held inline without any allocations of 
+    /// its own. It can be read like a std::vector<std::string> and 
+    /// converted into one.
+    class EventArgs {
+      public:
+        EventArgs() : count(0) {}
+        EventArgs(std::initializer_list<std::string> list) : count(0) {
+            for(auto i = list.begin(); i != list.end(); ++i) Push(*i);
+        }
+        EventArgs(const std::vector<std::string> & list) : count(0) {
+            for(size_t i = 0; i < list.size(); ++i) Push(list[i]);
+        }
+        EventArgs(const EventArgs & other) : count(0) {
+            for(size_t i = 0; i < other.size(); ++i) Push(other[i]);
+        }
+        EventArgs & operator=(const EventArgs & other) {
+            if (this == &other) return *this;
+            Clear();
+            for(size_t i = 0; i < other.size(); ++i) Push(other[i]);
+            return *this;
+        }
+        ~EventArgs() { Clear(); }
+
+        /// \brief Adds an argument to the end.
+        ///
+        void Push(const std::string & str) {
+            if (count < inlineCount_c) {
+                new (&inlineArgs()[count]) std::string(str);
+            } else {
+                overflow.push_back(str);
+            }
+            count++;
+        }
+
+        /// \brief Removes all arguments.
+        ///
+        void Clear() {
+            for(size_t i = 0; i < count && i < inlineCount_c; ++i) {
+                inlineArgs()[i].~basic_string();
+            }
+            overflow.clear();
+            count = 0;
+        }
+
+        size_t size() const { return count; }
+        bool  empty() const { return !count; }
+
+        const std::string & operator[](size_t i) const {
+            return i < inlineCount_c ? inlineArgs()[i] : overflow[i - inlineCount_c];
+        }
+
+        operator std::vector<std::string>() const {
+            std::vector<std::string> out;
+            out.reserve(count);
+            for(size_t i = 0; i < count; ++i) out.push_back((*this)[i]);
+            return out;
+        }
+
+        class const_iterator {
+          public:
+            const_iterator(const EventArgs * a, size_t i) : args(a), index(i) {}
+            const std::string & operator*() const { return (*args)[index]; }
+            const std::string * operator->() const { return &(*args)[index]; }
+            const_iterator & operator++() { index++; return *this; }
+            bool operator==(const const_iterator & o) const { return index == o.index; }
+            bool operator!=(const const_iterator & o) const { return index != o.index; }
+          private:
+            const EventArgs * args;
+            size_t index;
+        };
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end()   const { return const_iterator(this, count); }
+
+        /// \brief Returns an empty argument list.
+        ///
+        static const EventArgs & Empty() {
+            static EventArgs empty;
+            return empty;
+        }
+
+      private:
+        static const size_t inlineCount_c = 4;
+
+        std::string * inlineArgs() { return reinterpret_cast<std::string*>(storage); }
+        const std::string * inlineArgs() const { return reinterpret_cast<const std::string*>(storage); }
+
+        alignas(std::string) unsigned char storage[inlineCount_c * sizeof(std::string)];
+        size_t count;
+        std::vector<std::string> overflow;
+    };
 
 
 
@@ -89,10 +198,35 @@ class Component {
 
     //virtual Component * Clone() {return nullptr;}
 
+    /// \brief Identifies a kind of component. Every distinct tag 
+    /// is interned to its own TypeID.
+    using TypeID = uint32_t;
+
     /// \brief Returns a string identifier belonging to the component.
     /// Each component implementation should have a unique name.
     ///
-    std::string GetTag() { return tag; };
+    const std::string & GetTag() const { return GetTypeName(typeID); };
+
+    /// \brief Returns the interned ID of the component's tag.
+    ///
+    TypeID GetTypeID() const { return typeID; }
+
+    /// \brief Returns the TypeID for the given tag.
+    ///
+    /// The first request for a tag registers it.
+    static TypeID GetTypeID(const std::string & tag);
+
+    /// \brief Returns the tag that the given TypeID was registered with.
+    ///
+    /// If the TypeID is unknown, an empty string is returned.
+    static const std::string & GetTypeName(TypeID);
+
+    /// \brief Returns every component of the given type that 
+    /// is currently attached to an Entity, in no particular order.
+    ///
+    /// The list is kept up to date as components are added and removed,
+    /// so no search is made.
+    static const std::vector<Component *> & GetAllOfType(TypeID);
 
     /// \brief Returns the set host of the component. If no host is set,
     /// nullptr is returned.
@@ -129,7 +263,24 @@ class Component {
     ///
     /// The return value tells the event system to propogate the event
     /// thats currently being processed.
-    using EventHandler = bool (*)(void *, Component * component, Entity::ID self, Entity::ID source, const std::vector<std::string> & args);
+    using EventHandler = bool (*)(void *, Component * component, Entity::ID self, Entity::ID source, const EventArgs & args);
+
+
+    /// \brief Returns the EventID for the given event name.
+    ///
+    /// The first request for a name registers it.
+    static EventID GetEventID(const std::string & eventName);
+
+    /// \brief Returns the EventID for the given event name without registering it.
+    ///
+    /// If the name was never registered, 0 is returned, which 
+    /// matches no event.
+    static EventID FindEventID(const std::string & eventName);
+
+    /// \brief Returns the name that the given EventID was registered with.
+    ///
+    /// If the EventID is unknown, an empty string is returned.
+    static const std::string & GetEventName(EventID);
 
 
 
@@ -142,11 +293,18 @@ class Component {
     /// @param eventName Name of the event. This should match the name that was installed.
     /// @param source Optional ID that indicates the source of the event. For example, in a collision, this may be the object collided with.
     /// @param args Optional string vector with additional information to be used by the event.
-    bool EmitEvent(const std::string & eventName, Entity::ID source = Entity::ID(), const std::vector<std::string> & args = {});
+    bool EmitEvent(const std::string & eventName, Entity::ID source = Entity::ID(), const EventArgs & args = EventArgs::Empty());
+
+    /// \brief Same as EmitEvent(const std::string &, ...), but 
+    /// using the interned event ID.
+    ///
+    /// No allocations or name lookups are made to find the event.
+    bool EmitEvent(EventID event, Entity::ID source = Entity::ID(), const EventArgs & args = EventArgs::Empty());
 
     /// \brief Returns whether there exists at least one handler for the given event
     ///
     bool CanHandleEvent(const std::string & eventName);
+    bool CanHandleEvent(EventID event);
 
 
     /// \brief Adds a hook to the event. 
@@ -176,7 +334,11 @@ class Component {
     ///
     std::vector<std::string> GetKnownEvents() const;
     ///\}
-	virtual ~Component(){}
+
+    /// \brief Returns the allocator that all Components are created from.
+    ///
+    static const SlabAllocator & GetAllocator();
+	virtual ~Component();
   protected:
     Component(const std::string &);
 
@@ -211,21 +373,34 @@ class Component {
     Component();
     void * operator new(std::size_t);
     void * operator new[](std::size_t);
-    void operator delete(void * ptr);
+    void operator delete(void * ptr, std::size_t);
     void operator delete[](void * ptr);
     
   private:
     void SetHost(Entity *);
+    static uint32_t releaseEmptySlabs();
       
     friend class Entity;
-    std::string tag;
+    friend class EntityLimbo;
+    TypeID typeID;
     Entity * host;
 
+    // position within the GetAllOfType() list while attached.
+    uint32_t typeListIndex;
+    void AddToTypeList();
+    void RemoveFromTypeList();
+
+    // Each component only knows a handful of events, so they are
+    // kept in a flat list and found with a short scan by EventID.
+    // An uninstalled event keeps its slot with an event ID of 0 
+    // so that indices stay stable while an event is being emitted.
     struct EventSet {
+        EventID event;
         std::vector<std::pair<EventHandler, void*>> hooks;
         std::vector<std::pair<EventHandler, void*>> handlers;
     };
-    std::unordered_map<std::string, EventSet> handlers;
+    std::vector<EventSet> events;
+    int findEvent(EventID) const;
 };
 }
 
@@ -105,6 +105,18 @@ class Clock : public Component {
     ///
     bool IsPaused();
 
+    /// \brief Sets whether the clock keeps real time rather than game time.
+    ///
+    /// Clocks normally keep time with Time::GameMsSinceStartup(), which 
+    /// stands still between frames when the virtual clock is in use.
+    /// Clocks that time the program itself should keep real time instead.
+    /// The default is false.
+    void SetRealTime(bool);
+
+    /// \brief Returns whether the clock keeps real time. See SetRealTime().
+    ///
+    bool IsRealTime();
+
 
     std::string GetInfo();
 
@@ -125,6 +137,7 @@ class Clock : public Component {
     long getMS();
 
     bool paused;
+    bool realTime;
 
 
 };
@@ -64,10 +64,21 @@ class Render2D : public Component, public Spatial {
     ///
     bool absolute;
 
+    /// \brief The layer to draw in. Objects in lower layers are always drawn 
+    /// before, i.e. under, those in higher layers. The default is 0.
+    ///
+    /// Within a layer, Graphics may reorder objects with different modes or 
+    /// polygons to draw them in fewer batches. See Graphics::SetSorted2D().
+    int layer;
+
     /// \brief Returns the raw vertices compiled for the renderable object 
     ///
     /// See Renderer.h
     std::vector<Renderer::Vertex2D> GetVertices() const;    
+
+    /// \brief Same as GetVertices(), without copying them.
+    ///
+    const std::vector<Renderer::Vertex2D> & GetVertexData() const;
     
     uint32_t GetObjectID() const;
     
@@ -82,12 +93,15 @@ class Render2D : public Component, public Spatial {
   protected:
     Render2D(const std::string &);
 
+    // Only the vertices that differ from the last call are sent to the renderer,
+    // and existing vertex slots are reused.
     void SetVertices(const std::vector<Renderer::Vertex2D> &);
     void SetPolygon(Renderer::Polygon);
     void OnUpdateTransform();
 
   private:
      std::vector<uint32_t> vertexSrc;
+     std::vector<Renderer::Vertex2D> vertexData; // as last given to the renderer
      int objectID;
      
      Renderer::Polygon polygon;
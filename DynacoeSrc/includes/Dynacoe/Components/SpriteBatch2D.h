@@ -0,0 +1,111 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#ifndef H_DC_SPRITEBATCH2D_INCLUDED
+#define H_DC_SPRITEBATCH2D_INCLUDED
+
+#include <Dynacoe/Components/Render2D.h>
+#include <Dynacoe/Image.h>
+#include <Dynacoe/Color.h>
+namespace Dynacoe {
+
+/** \brief Draws many images at once.
+ *
+ * Each sprite is an image frame with its own position, rotation, scale and 
+ * color, kept as one small record. All the sprites of a batch are sent to the 
+ * renderer together and drawn in a single call, so a batch can hold far more 
+ * images than would be practical as separate Shape2D components. Sprites are
+ * placed relative to the batch's own transform.
+ *
+ */
+class SpriteBatch2D : public Render2D {
+  public:
+    SpriteBatch2D();
+    ~SpriteBatch2D();
+
+    /// \brief Adds a sprite showing a frame of an image. 
+    ///
+    /// The sprite starts at the origin, unrotated and at the frame's size.
+    /// If image does not refer to a valid Image, the sprite is a 
+    /// 1-by-1 square of its color. Returns the index of the new sprite.
+    uint32_t Add(AssetID image, int frame = 0);
+
+    /// \brief Removes the sprite at the given index. 
+    ///
+    /// So that the sprites stay packed, the last sprite is moved to 
+    /// take its index.
+    void Remove(uint32_t index);
+
+    /// \brief Removes all sprites.
+    ///
+    void Clear();
+
+    /// \brief Returns the number of sprites in the batch.
+    ///
+    uint32_t Count() const;
+
+
+    /// \brief Places a sprite.
+    ///
+    /// @param index The sprite to place.
+    /// @param position Where the center of the sprite goes, in pixels.
+    /// @param rotation Rotation about the center in degrees.
+    /// @param scale Scale of the sprite as a ratio of its frame's size.
+    void Set(uint32_t index, const Vector & position, float rotation = 0.f, const Vector & scale = Vector(1.f, 1.f));
+
+    /// \brief Sets the color that a sprite's image is multiplied by.
+    ///
+    void SetColor(uint32_t index, const Color &);
+
+    /// \brief Changes the image frame a sprite shows, keeping its placement.
+    ///
+    void SetFrame(uint32_t index, AssetID image, int frame = 0);
+
+    /// \brief Returns the raw sprite records, Count() of them.
+    ///
+    /// See Renderer.h
+    const Renderer::Sprite2D * GetSprites() const;
+
+
+    void OnDraw();
+    std::string GetInfo();
+
+  private:
+    std::vector<Renderer::Sprite2D> sprites;
+    std::vector<float> sizes; // width, height of each sprite's frame
+};
+}
+
+
+
+#endif
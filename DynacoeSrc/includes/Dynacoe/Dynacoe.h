@@ -41,6 +41,8 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Dynacoe/Components/Clock.h>
 #include <Dynacoe/Entity.h>
+#include <Dynacoe/Util/FramePacer.h>
+#include <Dynacoe/Util/MemoryStats.h>
 #include <cstdlib>
 #include <sstream>
 #include <iostream>
@@ -86,6 +88,32 @@ class Engine {
     /// debugging features such as the console and Entity debugger.
     static int Run();
 
+    /// \brief How long the parts of a single frame took, in real time.
+    ///
+    struct FrameTiming {
+        float stepMS;       ///< Stepping modules and Entities, including any catch-up steps.
+        float drawMS;       ///< Drawing and committing the frame.
+        float reclaimMS;    ///< Destroying removed Entities.
+        float totalMS;
+    };
+
+    /// \brief Runs a number of frames as fast as possible and returns how long each took.
+    ///
+    /// Each frame goes through the same modules and Entities as with Run(), 
+    /// but without waiting for the frame rate. Instead of following 
+    /// the real clock, game time (see Time::GameMsSinceStartup()) moves forward by 
+    /// exactly dtMS each frame, so Clock, Scheduler, Mutator, Sequencer and 
+    /// fixed-rate steps behave the same from run to run no matter how fast 
+    /// the frames actually go. This is meant for headless servers, tests and benchmarks.
+    ///
+    /// If Quit() is called, the remaining frames are skipped. The request to quit 
+    /// is cleared on return, so RunFrames() may be called again.
+    static std::vector<FrameTiming> RunFrames(int count, double dtMS);
+
+    /// \brief Returns how long the parts of the last finished frame took.
+    ///
+    static const FrameTiming & GetLastFrameTiming();
+
     /// \brief Returns the toplevel Entity. 
     ///
     /// From here, you can 
@@ -106,7 +134,8 @@ class Engine {
     ///
     /// @param FPS  The target FPS; useful for loops.
     ///
-    /// The actual resolution is machine-dependent, but it tends to be millisecond resolution.
+    /// Frames are paced against a monotonic clock on a fixed schedule (see FramePacer), 
+    /// so lateness in one frame is made up in the next ones.
     static void Wait(int FPS);
 
 
@@ -119,6 +148,51 @@ class Engine {
     ///
     static int GetMaxFPS();
 
+    /// \brief Sets the rate at which Entities are stepped, in steps per second.
+    ///
+    /// With a step rate, the simulation advances in fixed increments 
+    /// of 1/hz seconds independent of how often frames are drawn: a frame 
+    /// runs as many steps as the elapsed time calls for (see SetMaxCatchUpSteps()), 
+    /// and Spatial render transforms are interpolated between the last 
+    /// two steps so that motion stays smooth. Modules are run alongside 
+    /// each step, not each frame.
+    /// A rate of 0 or less (the default) steps exactly once per frame.
+    static void SetStepRate(int hz);
+
+    /// \brief Returns the step rate set with SetStepRate().
+    ///
+    static int GetStepRate();
+
+    /// \brief Sets the most steps that may be run within a single frame 
+    /// when a step rate is set.
+    ///
+    /// If stepping cannot keep up with the step rate, the time that could 
+    /// not be stepped within this limit is dropped, so that the simulation 
+    /// slows down rather than falling further and further behind. The default is 5.
+    static void SetMaxCatchUpSteps(int);
+
+    /// \brief Returns the limit set with SetMaxCatchUpSteps().
+    ///
+    static int GetMaxCatchUpSteps();
+
+    /// \brief Returns how far the current frame is between the last
+    /// step and the next one, from 0 to 1.
+    ///
+    /// This is always 1 when no step rate is set.
+    static float GetStepAlpha();
+
+    /// \brief Sets how long the Engine may spend destroying removed 
+    /// Entities at the end of each frame.
+    ///
+    /// Removing a large number of Entities at once can otherwise stall 
+    /// a single frame; with a budget, the work is spread over several.
+    /// A budget of 0 or less (the default) destroys them all right away.
+    static void SetReclaimBudget(float ms);
+
+    /// \brief Returns the reclaim budget set with SetReclaimBudget().
+    ///
+    static float GetReclaimBudget();
+
     /// \brief Returns the starting directory of Dynacoe.
     ///
     /// Reutrns an empty string if unavailable.
@@ -135,7 +209,12 @@ class Engine {
         float stepTimeMS;
         float systemTimeMS;
         float engineRealTimeMS;        
+        float reclaimTimeMS;    ///< Time spent destroying removed Entities.
         int currentFPS;
+        int stepsPerSecond;     ///< How many times the Entities were stepped over the last second.
+        int reclaimPending;     ///< Removed Entities left for later frames by the reclaim budget.
+        FramePacer::JitterStats frameJitter; ///< How late each frame started over the last second.
+        MemoryStats::Usage memory[MemoryStats::CategoryCount]; ///< Memory held by each MemoryStats::Category, indexed by category.
     };
     
     static const Diagnostics & GetDiagnostics();
@@ -145,8 +224,6 @@ class Engine {
 
 
 
-    static double frameStart;
-    static double frameEnd;
 
     static bool EXIT;
 
@@ -157,27 +234,13 @@ class Engine {
 
     static std::vector<Module*> modules;
 
-    static Dynacoe::Clock drawTime;
-    static Dynacoe::Clock runTime;
-    static Dynacoe::Clock sysTime;
-    static Dynacoe::Clock debugTime;
-    static Dynacoe::Clock frameTime;
-
-    static float lastDrawTime;
-    static float lastRunTime;
-    static float lastSysTime;
-    static float lastDebugTime;
-
-    static float curDrawTime;
-    static float curRunTime;
-    static float curSysTime;
-    static float curDebugTime;
-
     static int frameCount;
     static int valid;
 
     static void render();
     static void update();
+    static void advance();
+    static void frame();
 
     static std::vector<Entity*> worlds;
     static Entity::ID universe;
@@ -37,15 +37,19 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/AssetID.h>
 #include <Dynacoe/Variable.h>
 #include <Dynacoe/Spatial.h>
+#include <Dynacoe/Util/SlabAllocator.h>
 #include <set>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
 #include <stack>
+#include <atomic>
 
 namespace Dynacoe {
 class Component;
 class UintToID;
+class EntitySlotTable;
+class EntityLimbo;
 /// \brief Basic interactive object.
 ///
 /// Entity s are the main classes that are extended to meet abstractions for your 
@@ -64,14 +68,17 @@ class Entity : public Spatial {
   public:
       /// \brief Uniquely identifies an Entity 
       ///
+      /// IDs are plain values: copying one is free and does not 
+      /// keep the Entity alive. Internally, an ID is an index into the 
+      /// entity slot table paired with the generation of that slot. 
+      /// When an Entity is removed, its slot's generation is advanced, 
+      /// so any IDs still referring to it become invalid even if the slot 
+      /// is later reused by a new Entity.
       class ID {
         public:
-          ~ID();
-          ID() : id(nullptr){};
+          ID() : id(0){};
           ID(const std::string & str);
           ID(uint64_t value);
-          ID(const ID &);
-          ID & operator=(const ID & other);
 
           bool operator==(const ID & other) const {
               return other.id == id;
@@ -81,15 +88,23 @@ class Entity : public Spatial {
           }
           /// \brief Returns a value that unique ientifies the Entity.
           ///
-          uint64_t Value() const { return (uint64_t)id; }
+          /// The value may be given back to ID(uint64_t) to 
+          /// retrieve the same ID.
+          uint64_t Value() const { return id; }
 
           /// \brief Returns the entity referred to by this ID
           ///
-          Entity * Identify() const;
+          /// If the Entity no longer exists, nullptr is returned.
+          Entity * Identify() const {
+              const uint32_t index = (uint32_t)id;
+              if (index >= slotCount) return nullptr;
+              const Slot & slot = slots[index];
+              return slot.generation == (uint32_t)(id >> 32) ? slot.entity : nullptr;
+          }
           
           /// \brief Returns the ID in string form 
           ///
-          const std::string & String() const;
+          std::string String() const;
 
           /// \brief Convenience function for .Identify()->QueryComponent<T>()
           ///
@@ -110,12 +125,22 @@ class Entity : public Spatial {
           template<typename T>
           T * IdentifyAs() const { return dynamic_cast<T*>(Identify()); }
 
-          bool Valid() const;
+          bool Valid() const { return Identify(); }
 
         private:
-          void * id;
+          // one entry in the entity slot table. 
+          struct Slot {
+              Entity * entity;
+              uint32_t generation;
+              uint32_t nextFree;
+          };
+          static Slot *   slots;
+          static uint32_t slotCount;
+
+          uint64_t id;
 
           friend class Entity;
+          friend class EntitySlotTable;
 
       };
 
@@ -130,6 +155,9 @@ class Entity : public Spatial {
     /// Entities are ordered by priority, where the first entity
     /// is guaranteed to be the one with the lowest Priority value.
     /// If unsuccessful, the EntityID will be invalid.
+    /// While this Entity is in the middle of its Step() or Draw(), 
+    /// child changes are deferred until the update finishes, so the list 
+    /// reflects the children as they were when the update began.
     const std::vector<Entity::ID> & GetChildren() const;
 
 
@@ -144,7 +172,9 @@ class Entity : public Spatial {
 
     /// \brief Returns all bound Entities with the name equivalent to the one given within 
     /// this Entity's hierarchy.
-    /// The Entity's IDs are returned.
+    /// The Entity's IDs are returned in no particular order.
+    /// Names are indexed as they are set, so the cost depends on the 
+    /// number of Entities sharing the name rather than the size of the hierarchy.
     std::vector<Entity::ID> FindChildByName(const std::string &);
 
     /// \brief Updates all attached Entities.
@@ -158,11 +188,17 @@ class Entity : public Spatial {
     /// \brief Binds an entity to the World. If bound, an Entity will be
     /// updated when the World is updated.
     ///
+    /// The child's parent is changed immediately. If this Entity is 
+    /// currently updating its children, the child will start being 
+    /// updated on the next Step() / Draw().
     void Attach(Entity::ID);
     void Attach(Entity &);
 
     /// \brief Unbinds an Entity.
     ///
+    /// The child's parent is changed immediately and it will not be 
+    /// updated by this Entity again, even if this Entity is currently 
+    /// updating its children.
     void Detach(Entity::ID);
 
 
@@ -214,12 +250,14 @@ class Entity : public Spatial {
     /// Entity, iedentified by id, to complete its run cycle. A run cycle consists of the Entities
     /// Run function and any attached components' run.
     ///
+    /// This is only measured while the Profiler is enabled. Otherwise, it is 0.
     double StepDuration();
 
     /// \brief Returns the last recorded amount of milliseconds it took the
     /// Entity, iedentified by id, to complete its draw cycle. A draw cycle consists of the Entities
     /// Draw function and any attached components' draw.
     ///
+    /// This is only measured while the Profiler is enabled. Otherwise, it is 0.
     double DrawDuration();
 
 
@@ -272,6 +310,9 @@ class Entity : public Spatial {
     /// Priorty determines the order in which this
     /// entity is updated. A lower priority means it will be drawn and updated earlier.
     /// It is undefined which entity is updated first if both have the same priority.
+    /// The parent re-orders its children once before its next Step() or Draw(),
+    /// so changing the priority of many children at a time is cheap. 
+    /// OnEnter() / OnDepart() are not called.
     /// @param p The new priority.
     void SetPriority(Priority p);
 
@@ -301,28 +342,89 @@ class Entity : public Spatial {
     ///\{
 
 
+    /// \brief A bool that keeps its Entity's IsStepping() / IsDrawing() 
+    /// state up to date as it is assigned.
+    ///
+    /// It reads and assigns like the plain bool that step and draw used 
+    /// to be, but it is not one: code that took a bool * or bool & to 
+    /// step or draw has to use Get() / Set() or the flag itself instead.
+    class ActiveFlag {
+      public:
+        ActiveFlag & operator=(bool);
+        ActiveFlag & operator=(const ActiveFlag & other) {return *this = (bool)other;}
+        operator bool() const {return value;}
+
+        /// \brief Same as reading the flag.
+        bool Get() const {return value;}
+
+        /// \brief Same as assigning to the flag.
+        void Set(bool v) {*this = v;}
+
+      private:
+        friend class Entity;
+        ActiveFlag(Entity * o) : value(true), owner(o) {}
+        ActiveFlag(const ActiveFlag &) = delete;
+        bool value;
+        Entity * owner;
+    };
+
     /// \brief Whether the engine should call Step() automatically for this entity.
     /// Note that Step() calls also manage components and child entities.
     /// The default is true.
     ///
-    bool step;
+    ActiveFlag step;
 
     /// \brief Whether the engine should call Draw() automatically for this entity.
     /// Note that Draw() calls also manage components and child entities.
     /// The default is true.
     ///
-    bool draw;
+    ActiveFlag draw;
 
 
     /// \brief Returns wether or not the Engine is handling calling Step() automatically,
     /// taking into account the Entity's hierarchy.
     ///
-    bool IsStepping();
+    /// The result is cached and kept current as step flags and parents 
+    /// change, so this is cheap enough to call per object per frame, 
+    /// for example to skip work for inactive subtrees.
+    bool IsStepping() const {return activeStep;}
+
+    /// \brief Sets whether this Entity's children may be stepped in parallel.
+    ///
+    /// When enabled, children are stepped on a pool of worker threads. 
+    /// Children with lower priority still finish before children with a 
+    /// higher priority begin; children that share a priority may run at the 
+    /// same time. Each child's own subtree is stepped on a single thread 
+    /// in priority order unless it also enables parallel children.
+    ///
+    /// Children marked this way must be independent of each other: they 
+    /// should not touch each other or shared engine state during their step.
+    /// Attach(), Detach(), SetPriority(), Remove() and RemoveComponent() 
+    /// are safe to call from a parallel step; they are queued and applied 
+    /// on the main thread once the parallel step finishes. 
+    /// ReclaimRemoved() is ignored with an error. Creating entities or 
+    /// adding components from a parallel step is not supported: it is 
+    /// reported and the program is stopped, since it would corrupt 
+    /// shared state. Drawing is never done in parallel.
+    /// The default is false.
+    void SetParallelChildren(bool);
+
+    /// \brief Returns whether this Entity's children may be stepped in parallel.
+    ///
+    bool GetParallelChildren() const;
 
     /// \brief Returns wether or not the Engine is handling calling Draw() automatically,
     /// taking into account the Entity's hierarchy.
     ///
-    bool IsDrawing();
+    /// Like IsStepping(), the result is cached.
+    bool IsDrawing() const {return activeDraw;}
+
+    /// \brief Recomputes the cached IsStepping() / IsDrawing() state for 
+    /// this Entity and everything below it.
+    ///
+    /// Assigning step or draw does this automatically. It is only needed
+    /// after those flags have been written to through a watched Variable.
+    void RefreshActiveState();
     ///\}
 
 
@@ -361,6 +463,7 @@ class Entity : public Spatial {
     /// @param when When to step and draw this component in relation to the hosts own step/draw. The default is "before"
     template <typename T>
     T * AddComponent(UpdateClass when = UpdateClass::Before) {
+        checkCanAddComponent();
         T * c = new T;
         AddComponentInternal(c, when);
         return c;
@@ -425,6 +528,32 @@ class Entity : public Spatial {
     /// generated every time
     static std::vector<Entity::ID> GetAll();
 
+    /// \brief Destroys Entities that have been Remove()d.
+    ///
+    /// Removed Entities are not freed right away; they are kept until 
+    /// this is called, which the Engine does once at the end of each frame.
+    /// Entities are destroyed newest first. If budgetMS is positive, 
+    /// destruction stops once roughly that much time has passed and 
+    /// resumes on the next call.
+    /// Returns the number of Entities still waiting to be destroyed.
+    static uint32_t ReclaimRemoved(double budgetMS = 0);
+
+    /// \brief Returns all Entities with the given name, attached or not, 
+    /// in no particular order.
+    static std::vector<Entity::ID> FindByName(const std::string &);
+
+    /// \brief Returns every distinct name that has been given to an Entity.
+    ///
+    /// Names are only ever appended, so callers may cache work done 
+    /// per name and only look at the entries added since.
+    static const std::vector<std::string> & GetKnownNames();
+
+    /// \brief Returns the allocator that all Entities are created from.
+    ///
+    /// Its counters show how many Entities of each size are alive 
+    /// and the most that have been alive at once.
+    static const SlabAllocator & GetAllocator();
+
 
 
     virtual ~Entity();
@@ -493,7 +622,7 @@ class Entity : public Spatial {
 
     void * operator new(std::size_t);
     void * operator new[](std::size_t);
-    void operator delete(void * ptr);
+    void operator delete(void * ptr, std::size_t);
     void operator delete[](void * ptr);
 
 
@@ -503,6 +632,7 @@ class Entity : public Spatial {
 
 
      void AddComponentInternal(Component * c, UpdateClass);
+     static void checkCanAddComponent();
     friend class Engine;
 
      bool WasDetachedMidExecution(Entity::ID id);
@@ -510,14 +640,42 @@ class Entity : public Spatial {
      void priorityListQueueRemove(Entity::ID);
      void priorityListAdd(Entity::ID);
      void priorityListRemove(int);
-     void initBase();
-     int getNewEntID();
+     void applyChildJournal();
+     bool stepChildrenParallel(const Entity::ID & idSelf);
+     void getCurrentChildren(std::vector<Entity::ID> &) const;
+     void sortChildren();
+     void updateActiveState();
+     bool getChildPriorityRange(Priority & low, Priority & high) const;
+     void addToNameIndex();
+     void removeFromNameIndex();
+     void updateAncestorNames(bool add);
+     bool isWithin(const Entity *) const;
 
 
 
      std::vector<Entity::ID> PriorityList;     // normal entity list
 
 
+     // Attach / Detach requests made while PriorityList is 
+     // being walked. They are applied once the walk is finished 
+     // so that Step() and Draw() can iterate the list in place.
+     struct ChildJournalEntry {
+         Entity::ID id;
+         bool attach;
+     };
+     std::vector<ChildJournalEntry> childJournal;
+     uint32_t traversalDepth;
+     class ChildWalk;
+
+     // Set when a child's priority changes; PriorityList is re-sorted 
+     // before it is next walked or searched.
+     bool priorityDirty;
+
+     // Children are stepped on the worker pool (see SetParallelChildren())
+     bool parallelChildren;
+     std::vector<Entity *> parallelBatch;
+
+
 
 
      std::set<Variable> watchList;
@@ -526,6 +684,12 @@ class Entity : public Spatial {
      std::string name;
      Entity * world;
 
+     // Name index (see FindChildByName()). nameID is 0 while unnamed.
+     uint32_t nameID;
+     uint32_t nameListIndex;
+     // Number of Entities below this one carrying each name.
+     std::unordered_map<uint32_t, uint32_t> subtreeNames;
+
 
 
 
@@ -533,19 +697,35 @@ class Entity : public Spatial {
 
 
 
-     void * idTable;
      bool protectd;
      bool removed;
 
+     // order of construction, used to reclaim newest first.
+     uint64_t creationIndex;
+
+     // step / draw with every ancestor's taken into account.
+     bool activeStep;
+     bool activeDraw;
+
      double stepTime;
      double drawTime;
-     static uint64_t idPool;
+
+     // the name as the profiler sees it.
+     const char * zoneName;
+
+     // Smoothed step / draw times and the index into SlowestEntities' 
+     // heap, or -1 if not in it.
+     float stepCost;
+     float drawCost;
+     std::atomic<int32_t> costSlot;
+     friend class SlowestEntities;
 
 
      std::vector<Component *> componentsBefore;
      std::vector<Component *> componentsAfter;
      std::vector<Component *> components;
      friend void EntityErase(Entity * e);
+     friend class EntityLimbo;
 };
 
 
@@ -46,8 +46,10 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Modules/Assets.h>
 #include <Dynacoe/Modules/Input.h>
 #include <Dynacoe/Modules/ViewManager.h>
+#include <Dynacoe/Modules/Stats.h>
 
 #include <Dynacoe/Components/Shape2D.h>
+#include <Dynacoe/Components/SpriteBatch2D.h>
 #include <Dynacoe/Components/Text2D.h>
 #include <Dynacoe/Components/RenderMesh.h>
 #include <Dynacoe/Components/RenderLight.h>
@@ -39,6 +39,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Util/Chain.h>
 #include <Dynacoe/Component.h>
 #include <map>
+#include <atomic>
 
 class ConsoleInputStream;
 namespace Dynacoe {
@@ -47,12 +48,46 @@ class DebugMessage;
 class Shape2D;
 
 
+/// \brief Limits how many messages one place in the code may post per second.
+///
+/// Normally used through DC_CONSOLE_RATE_LIMIT(), which keeps one 
+/// of these for each place it is written. Messages over the limit are 
+/// dropped before they are formatted, and the next message let through 
+/// says how many were dropped.
+class ConsoleRateLimit {
+  public:
+    ConsoleRateLimit(uint32_t maxPerSecond);
+
+    /// \brief Returns whether a message may be posted now. If so, 
+    /// suppressed is set to the number held back since the last one.
+    ///
+    bool Allow(uint32_t & suppressed);
+
+  private:
+    uint32_t limit;
+    std::atomic<uint64_t> windowStart;
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> held;
+};
+
+/// \brief Limits the message it is streamed into to the given number per second 
+/// for this place in the code, i.e. 
+/// Console::Warning() << DC_CONSOLE_RATE_LIMIT(2) << "Underrun!" << Console::End;
+#define DC_CONSOLE_RATE_LIMIT(maxPerSecond) \
+    ([]() -> Dynacoe::ConsoleRateLimit & { static Dynacoe::ConsoleRateLimit site(maxPerSecond); return site; }())
+
+
 
 /// \brief Streams output to the console. Normally not directly needed.
+///
+/// Text is gathered in a buffer reused by the calling thread and handed 
+/// over in one piece once the stream is destroyed, so building a message 
+/// from many parts stays cheap. Streams whose type is below 
+/// Console::GetMinimumLevel() skip formatting altogether.
 class ConsoleStream {
   public:
   
-    ///\brief Message classifications. For now, just determines the color of the message.
+    ///\brief Message classifications, from least to most severe. Determines the color of the message.
     ///
     enum class MessageType{
         Normal, ///< A normal message
@@ -66,20 +101,30 @@ class ConsoleStream {
     using FinishedCallback = void (*)(const std::string & text, ConsoleStream::MessageType i); 
 
     ConsoleStream(const ConsoleStream &);
-    ConsoleStream(FinishedCallback);
+    ConsoleStream(FinishedCallback, MessageType = MessageType::Normal);
     ~ConsoleStream(); // calls finished callback with the formatted string
     /// \name Stream Output
     /// 
     /// \{
-    ConsoleStream operator<<(const Chain&);
-    ConsoleStream operator<<(MessageType);
+    ConsoleStream & operator<<(const Chain&);
+    ConsoleStream & operator<<(MessageType);
+    ConsoleStream & operator<<(ConsoleRateLimit &);
     ///\}
 
+    /// \brief Returns whether anything streamed will be output.
+    ///
+    /// This is false when the type is filtered out or a rate limit 
+    /// dropped the message, so callers can skip expensive formatting.
+    bool IsActive() const;
+
   private:
+    void updateActive();
 
-    static MessageType type;
-    std::string str;
+    MessageType type;
+    std::string * str; // borrowed from the thread's buffers once written to
     FinishedCallback finish;
+    bool active;
+    bool limited;
 };
 
 
@@ -122,6 +167,29 @@ class Console : public Module {
     static ConsoleStream Warning();
     ///\}
 
+
+    /// \brief Sets the least severe type of message that is output. Messages 
+    /// below it are dropped before they are formatted.
+    ///
+    /// The default is ConsoleStream::MessageType::Normal, which outputs everything.
+    static void SetMinimumLevel(ConsoleStream::MessageType);
+
+    /// \brief Returns the least severe type of message that is output.
+    ///
+    static ConsoleStream::MessageType GetMinimumLevel();
+
+    /// \brief Also writes all output to the given file. An empty 
+    /// path stops writing to the file. Returns whether the file could be opened.
+    ///
+    static bool SetLogFile(const std::string & path);
+
+    /// \brief Waits until all messages posted so far have been written out.
+    ///
+    /// Messages are queued and written by a background thread, so that 
+    /// posting them is safe and cheap from any thread, including the 
+    /// audio thread. Fatal messages are flushed right away.
+    static void Flush();
+
     // State
 
     /// \brief Returns whether or not the console is showing.
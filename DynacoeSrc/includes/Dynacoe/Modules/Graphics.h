@@ -51,6 +51,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Modules/Assets.h>
 #include <Dynacoe/Components/Render2D.h>
 #include <Dynacoe/Components/RenderMesh.h>
+#include <Dynacoe/Components/SpriteBatch2D.h>
 #include <Dynacoe/Camera.h>
 
 #include <string>
@@ -103,6 +104,12 @@ class Graphics : public Module {
     ///
     static void Draw(Render2D &);
 
+    /// \brief Draws all the sprites of a batch in one call.
+    ///
+    /// The batch is read when the 2D drawing is sent to the renderer, 
+    /// so changes made to it before then are still drawn.
+    static void Draw(SpriteBatch2D &);
+
 
 
     ///\}
@@ -164,6 +171,66 @@ class Graphics : public Module {
     /// , but it may come in handy.
     static void SetRenderer(Renderer *);
 
+    /// \brief Sets whether drawing should overlap with stepping.
+    ///
+    /// When enabled, the renderer commands produced while drawing a frame
+    /// are recorded, and Commit() hands them to a separate render thread
+    /// which submits them and updates the display. Meanwhile, the
+    /// next frame is stepped, so a frame takes about as long as the
+    /// longer of stepping and rendering rather than both together.
+    /// What is shown on the display then lags the simulation by one frame.
+    ///
+    /// The renderer and display are used from the render thread
+    /// while this is enabled, so their backends must allow being driven 
+    /// from a thread other than the one that created them. Renderers 
+    /// that don't (Renderer::Capability::AnyThread), such as the OpenGL 
+    /// renderer, are refused with an error and drawing stays as it is.
+    /// Renderer calls that return results, such as creating 
+    /// textures or reading buffers, have to wait for the render 
+    /// thread to catch up.
+    /// The default is disabled.
+    static void SetPipelined(bool);
+
+    /// \brief Returns whether drawing is pipelined. See SetPipelined().
+    ///
+    static bool GetPipelined();
+
+
+    /// \brief Sets whether 2D drawing may be reordered to draw in fewer batches.
+    ///
+    /// 2D objects are not drawn right away: they are collected until 
+    /// something needs them drawn, such as Commit(), a camera change or Flush2D(). 
+    /// When sorting is enabled, the collected objects are then ordered by 
+    /// Render2D::layer, then by blending mode, then by polygon, so that 
+    /// each combination is drawn in one batch no matter how they were 
+    /// interleaved. Objects that share all three keep the order they were drawn in, 
+    /// but otherwise, drawing order is only kept across layers.
+    /// RenderMesh instances are drawn immediately, so 2D objects 
+    /// end up over 3D ones drawn in the same frame unless Flush2D() is called before them.
+    ///
+    /// When disabled, everything is drawn in the order it was requested, 
+    /// with a new batch every time the state changes.
+    /// The default is enabled.
+    static void SetSorted2D(bool);
+
+    /// \brief Returns whether 2D drawing may be reordered. See SetSorted2D().
+    ///
+    static bool GetSorted2D();
+
+
+    /// \brief What was drawn in a frame.
+    ///
+    struct FrameStats {
+        uint32_t meshes;        ///< Static (3D) objects drawn.
+        uint32_t objects2D;     ///< 2D objects drawn.
+        uint32_t vertices2D;    ///< Vertices of the 2D objects drawn.
+        uint32_t batches2D;     ///< Batches the 2D objects were sent to the renderer in.
+    };
+
+    /// \brief Returns what was drawn up to the last Commit().
+    ///
+    static const FrameStats & GetLastFrameStats();
+
 
 
 
@@ -220,6 +287,7 @@ class Graphics : public Module {
     friend class Assets;
     friend class GraphicsResizeCallback;
     friend class Image;
+    friend class SpriteBatch2D;
 
     static Renderer * drawBuffer;
 
@@ -228,6 +296,12 @@ class Graphics : public Module {
     /* Drawing state and display management */
 	static void setDisplayMode(Renderer::Polygon p, Renderer::Dimension, Renderer::AlphaRule a);
 
+    // sends all collected 2D drawing to the renderer
+    static void submit2D();
+
+    // drops pending draws of a batch being destroyed
+    static void forgetSprites2D(const SpriteBatch2D *);
+
     // draw immediates
     static float * transformResult;
     static float * transformResult2;
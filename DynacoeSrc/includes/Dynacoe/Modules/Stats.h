@@ -0,0 +1,135 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+#ifndef H_DC_STATS_INCLUDED
+#define H_DC_STATS_INCLUDED
+
+#include <Dynacoe/Modules/Module.h>
+#include <Dynacoe/Util/MemoryStats.h>
+#include <atomic>
+#include <string>
+
+namespace Dynacoe {
+
+/// \brief Sends the engine's statistics to a separate monitoring program.
+///
+/// Once a frame, the module records a handful of numbers: frame, step and draw 
+/// times, what was drawn, whether audio underran, and so on. These are handed to a 
+/// background thread, which combines them and, every interval, publishes 
+/// the result as statsd-style UDP packets, into shared memory, or both. 
+/// Unlike the Debugger, nothing is drawn, so watching a long test 
+/// does not change how it performs.
+///
+/// While not publishing, which is the default, the only cost is a check 
+/// of a flag each frame.
+///
+/// Publishing is only available on Linux.
+class Stats : public Module {
+  public:
+
+    /// \brief What is published each interval.
+    ///
+    /// This is also the layout of the shared memory, so another program can 
+    /// map it and read it. The writer increments sequence before and 
+    /// after each update, so a reader should copy the snapshot and accept 
+    /// the copy only if sequence was the same even number before and after.
+    struct Snapshot {
+        uint32_t magic;         ///< Always Stats::SnapshotMagic.
+        uint32_t version;       ///< Always Stats::SnapshotVersion.
+        std::atomic<uint32_t> sequence;
+        uint32_t intervalMS;    ///< How often snapshots are published.
+
+        uint64_t timeMS;        ///< Milliseconds since startup when this was published.
+        uint32_t frames;        ///< Frames sampled in this interval.
+        float fps;
+
+        float frameMS;          ///< Average time a frame took.
+        float frameMaxMS;       ///< The longest time a frame took.
+        float stepMS;           ///< Average time spent stepping per frame.
+        float stepMaxMS;
+        float drawMS;           ///< Average time spent drawing per frame.
+        float drawMaxMS;
+        float systemMS;         ///< Time spent in modules per frame, averaged over the last second.
+        float reclaimMS;        ///< Average time spent destroying removed Entities per frame.
+
+        float meshes;           ///< Average static objects drawn per frame.
+        float objects2D;        ///< Average 2D objects drawn per frame.
+        float vertices2D;       ///< Average 2D vertices drawn per frame.
+
+        uint32_t audioUnderruns;///< Frames in this interval in which the audio was underrunning.
+        uint32_t droppedSamples;///< Frames that could not be sampled because the publisher fell behind.
+
+        uint64_t memoryLive[MemoryStats::CategoryCount]; ///< Bytes held by each MemoryStats::Category.
+    };
+
+    static const uint32_t SnapshotMagic   = 0x54534344; // "DCST"
+    static const uint32_t SnapshotVersion = 1;
+
+
+    /// \brief Starts sending statsd-style UDP packets to the given address.
+    ///
+    /// Each interval sends gauges (and a counter for audio underruns) 
+    /// named prefix + the statistic, i.e. "dynacoe.frame_ms:16.6|g".
+    /// Returns whether the socket could be set up.
+    static bool PublishUDP(const std::string & host = "127.0.0.1", int port = 8125, const std::string & prefix = "dynacoe.");
+
+    /// \brief Starts publishing a Snapshot into the named POSIX shared memory object.
+    ///
+    /// Returns whether the shared memory could be set up.
+    static bool PublishSharedMemory(const std::string & name = "/dynacoe-stats");
+
+    /// \brief Stops all publishing and releases the socket and shared memory.
+    ///
+    static void Stop();
+
+    /// \brief Returns whether anything is being published.
+    ///
+    static bool IsPublishing();
+
+    /// \brief Sets how often the statistics are published, in milliseconds. The default is 1000.
+    ///
+    static void SetInterval(uint32_t ms);
+
+
+
+  private:
+    static std::atomic<bool> publishing;
+
+  public:
+    std::string GetName() { return "Stats";}
+    void Init(); void InitAfter(); void RunBefore(); void RunAfter(); void DrawBefore(); void DrawAfter();
+    Backend * GetBackend();
+};
+}
+
+
+#endif
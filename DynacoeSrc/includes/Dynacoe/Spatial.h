@@ -47,7 +47,7 @@ namespace Dynacoe{
  *
  *
  */
-class SpatialTransformUpdate;
+class SpatialSystem;
 class Spatial {
   public:
     Spatial();
@@ -60,7 +60,16 @@ class Spatial {
     // Gets the transform matrix that represets this Transform and its 
     // child parent transforms. If changes have been queued for children 
     // transforms or this one, those changes are applied.
-    TransformMatrix & GetGlobalTransform();
+    // A copy is returned, since the matrices are stored together 
+    // and move whenever a Spatial is created.
+    TransformMatrix GetGlobalTransform();
+
+    // Gets the transform matrix that this object should be drawn with.
+    // When interpolation is enabled, this is a blend between the global
+    // transform at the last SnapshotTransforms() and the current one,
+    // weighted by the interpolation alpha. Otherwise, it is the 
+    // global transform. Like GetGlobalTransform(), a copy is returned.
+    TransformMatrix GetRenderTransform();
 
     // Swaps the built in transform for the given transform 
     // pass nullptr to return the transform back to the default.
@@ -79,6 +88,28 @@ class Spatial {
     //This is intended for quick renderer upload. This will always
     //reflect the global transform
     void UpdateModelTransforms(RenderBufferID id);
+
+    // Brings every global transform up to date in one pass over 
+    // the hierarchy, parents before children. OnUpdateTransform() is called
+    // for each spatial object whose global transform changed.
+    // The engine calls this once per frame before drawing.
+    static void UpdateAll();
+
+    // Records every current global transform as the starting point 
+    // for interpolation. The engine calls this before each fixed step.
+    // Does nothing while interpolation is disabled.
+    static void SnapshotTransforms();
+
+    // Enables or disables interpolation of render transforms.
+    // The default is disabled.
+    static void SetInterpolation(bool);
+    static bool GetInterpolation();
+
+    // Sets how far between the last snapshot (0) and the current 
+    // state (1) render transforms should be. The value is clamped 
+    // to [0, 1].
+    static void SetInterpolationAlpha(float);
+    static float GetInterpolationAlpha();
 	
 	
     
@@ -86,13 +117,11 @@ class Spatial {
     virtual void OnUpdateTransform(){}
     
   private:
-    Spatial * parent;
-    std::vector<Spatial*> children;
-    Transform * transformOwned;
-    TransformMatrix global;
-    bool needsUpdate;
-    SpatialTransformUpdate * transformUpdate;
-    void SendUpdateSignal();
+    friend class SpatialSystem;
+
+    // index of this object's matrices within the SpatialSystem.
+    uint32_t slot;
+    Transform transformOwned;
 	Transform * node;
 };
 }
@@ -0,0 +1,126 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#ifndef H_DC_FRAME_PACER_INCLUDED
+#define H_DC_FRAME_PACER_INCLUDED
+
+#include <cstdint>
+
+namespace Dynacoe {
+
+/** \brief Keeps a loop running at a steady rate.
+ *
+ * Frame deadlines are scheduled on an absolute timeline: each deadline 
+ * is exactly one period after the last, rather than one period after 
+ * whenever the previous wait happened to return. Small delays are 
+ * therefore made up on the following frames instead of accumulating.
+ * If the loop falls more than a whole frame behind, the schedule is 
+ * restarted from the current time so that it doesn't rush through a 
+ * burst of frames to catch up.
+ *
+ * Waiting is done with an absolute-deadline sleep followed by a 
+ * short spin (see Time::SleepUntilNs()). How late each wakeup 
+ * was is recorded in a histogram.
+ */
+class FramePacer {
+  public:
+    /// \brief Number of buckets in JitterStats::buckets.
+    ///
+    static const int JitterBuckets = 16;
+
+    /// \brief How far past their deadlines the waits returned.
+    ///
+    struct JitterStats {
+        /// \brief Bucket 0 counts wakeups less than 1 microsecond late.
+        /// Bucket i counts wakeups between 2^(i-1) and 2^i microseconds 
+        /// late. The last bucket also counts anything later.
+        uint32_t buckets[JitterBuckets];
+
+        /// \brief Number of waits recorded.
+        uint32_t frames;
+
+        /// \brief Number of frames that began after their deadline had 
+        /// already passed, so no wait was made.
+        uint32_t missed;
+
+        /// \brief The latest wakeup, in nanoseconds.
+        uint64_t maxNs;
+
+        /// \brief The sum of all recorded lateness, in nanoseconds.
+        uint64_t totalNs;
+    };
+
+    FramePacer();
+
+    /// \brief Sets the rate to pace to. 
+    ///
+    /// 0 or less disables waiting. Changing the rate restarts the schedule.
+    void SetTargetFPS(int fps);
+
+    /// \brief Returns the rate set with SetTargetFPS().
+    ///
+    int GetTargetFPS() const { return fps; }
+
+    /// \brief Sets how long before each deadline to stop sleeping and spin instead.
+    ///
+    /// The default is 200 microseconds.
+    void SetSpinMargin(uint64_t ns) { spinNs = ns; }
+
+    /// \brief Waits until the next frame should begin.
+    ///
+    void Wait();
+
+    /// \brief Returns the lateness recorded since the last ResetJitter().
+    ///
+    const JitterStats & GetJitter() const { return jitter; }
+
+    /// \brief Clears the recorded lateness.
+    ///
+    void ResetJitter();
+
+  private:
+    void record(uint64_t lateNs);
+
+    int fps;
+    uint64_t periodNs;
+    uint64_t periodRemainder;
+    uint64_t remainder;
+    uint64_t deadline;
+    uint64_t spinNs;
+    bool started;
+    JitterStats jitter;
+};
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#ifndef H_DC_MEMORY_STATS_INCLUDED
+#define H_DC_MEMORY_STATS_INCLUDED
+
+#include <cstdint>
+
+namespace Dynacoe {
+
+/** \brief Keeps count of the memory held by each part of Dynacoe.
+ *
+ * Each category keeps how many bytes it holds now, the most it has 
+ * held, and how many objects or buffers those bytes are in. This covers 
+ * renderer-side storage, such as the texture atlas and vertex buffers, 
+ * as well as CPU memory.
+ *
+ * A budget can be set for each category. The engine warns once 
+ * whenever a category goes over its budget.
+ *
+ * The counts are updated atomically, so any thread may call Track().
+ */
+class MemoryStats {
+  public:
+
+    enum class Category {
+        Entities,       ///< Entity objects.
+        Components,     ///< Component objects.
+        Assets,         ///< Stored assets. Their decoded data is counted under its own category.
+        AudioData,      ///< Decoded sound held by AudioBlocks.
+        AudioChannels,  ///< The mixer's effect channel buffers.
+        Textures,       ///< Texture storage held by the renderer.
+        RenderBuffers   ///< Vertex and other buffers held by the renderer.
+    };
+
+    /// \brief The number of categories.
+    ///
+    static const int CategoryCount = 7;
+
+    /// \brief A category's current and highest use.
+    ///
+    struct Usage {
+        uint64_t liveBytes;     ///< Bytes held now.
+        uint64_t peakBytes;     ///< The most bytes held since the last ResetPeaks().
+        uint64_t count;         ///< Objects or buffers held now.
+        uint64_t budgetBytes;   ///< The budget set with SetBudget(), or 0 if none.
+    };
+
+
+    /// \brief Records memory being taken (positive) or given back (negative) by a category.
+    ///
+    /// @param bytes The change in bytes held.
+    /// @param count The change in objects or buffers held.
+    static void Track(Category, int64_t bytes, int64_t count = 0);
+
+    /// \brief Returns the usage of a category.
+    ///
+    static Usage Get(Category);
+
+    /// \brief Returns a short, readable name for a category.
+    ///
+    static const char * GetName(Category);
+
+    /// \brief Returns the bytes held by all categories together.
+    ///
+    static uint64_t GetTotalLive();
+
+    /// \brief Sets the peaks to what is held now.
+    ///
+    static void ResetPeaks();
+
+    /// \brief Sets the most bytes that a category is expected to hold. 
+    ///
+    /// 0, the default, means no budget.
+    static void SetBudget(Category, uint64_t bytes);
+
+    /// \brief Returns whether a category holds more than its budget.
+    ///
+    static bool IsOverBudget(Category);
+};
+
+}
+
+#endif
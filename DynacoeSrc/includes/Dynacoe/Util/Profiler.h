@@ -0,0 +1,210 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#ifndef H_DC_PROFILER_INCLUDED
+#define H_DC_PROFILER_INCLUDED
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace Dynacoe {
+
+/** \brief Records how long named sections of code take.
+ *
+ * A section being timed is a zone: a name, a category, and the times 
+ * it began and ended. Zones are usually opened with DC_PROFILE_ZONE(), 
+ * which times the rest of the enclosing scope. The engine already 
+ * opens zones for the frame, each module, each Entity's step and draw, 
+ * components, renderer flushes and audio mixing.
+ *
+ * Each thread writes its zones into its own fixed-size ring, so 
+ * recording never takes a lock. EndFrame(), which the engine calls 
+ * once per frame, gathers the rings into the last frame's zones and 
+ * the running totals. If a ring fills up before it is gathered, 
+ * further zones from that thread are dropped and counted.
+ *
+ * While disabled, which is the default, opening a zone costs a single 
+ * check of a flag and nothing is timed or recorded. Defining 
+ * DC_NO_PROFILER removes the zone macros entirely.
+ *
+ * Zone names and categories are not copied: they must outlive the 
+ * profiler. String literals are fine; other strings can be made 
+ * so with Intern().
+ */
+class Profiler {
+  public:
+
+    /// \brief A recorded zone.
+    ///
+    struct Zone {
+        const char * name;
+        const char * category;
+        uint64_t beginNs;       ///< When the zone was opened, in Profiler::Now() time.
+        uint64_t endNs;         ///< When the zone was closed.
+        uint32_t thread;        ///< Index of the thread that recorded the zone.
+        uint32_t depth;         ///< How many zones were open around it on that thread.
+    };
+
+
+    /// \brief Times the scope it is declared in as a zone.
+    ///
+    class Scope {
+      public:
+        Scope(const char * name_, const char * category_) :
+            name(name_), 
+            category(category_),
+            begin(IsEnabled() ? Profiler::begin() : 0) {}
+
+        ~Scope() { if (begin) End(); }
+
+        /// \brief Closes the zone early and returns how long it was open
+        /// in milliseconds. 
+        ///
+        /// If the profiler was disabled when the zone was opened, or it has 
+        /// already been closed, nothing is recorded and 0 is returned.
+        double End() {
+            if (!begin) return 0.0;
+            uint64_t end = Profiler::end(name, category, begin);
+            double out = (end - begin) / 1000000.0;
+            begin = 0;
+            return out;
+        }
+
+      private:
+        const char * name;
+        const char * category;
+        uint64_t begin;
+    };
+
+
+    /// \brief Enables or disables recording.
+    ///
+    /// Zones already open when the profiler is disabled are still recorded.
+    static void SetEnabled(bool);
+
+    /// \brief Returns whether zones are being recorded.
+    ///
+    static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /// \brief Returns the time that zones are recorded in, in nanoseconds.
+    ///
+    /// This is a raw monotonic clock that, unlike Time::NsSinceStartup(),
+    /// isn't slewed to match the system time. 
+    static uint64_t Now();
+
+    /// \brief Returns a copy of the given string that lives as long as the program.
+    ///
+    /// Interning the same string again returns the same copy.
+    static const char * Intern(const std::string &);
+
+    /// \brief Names the calling thread in exported traces.
+    ///
+    /// The name must outlive the profiler.
+    static void SetThreadName(const char *);
+
+
+
+    /// \brief Gathers the zones recorded by all threads since the 
+    /// last call. The engine calls this once per frame.
+    ///
+    static void EndFrame();
+
+    /// \brief Returns the zones gathered by the last EndFrame().
+    ///
+    static const std::vector<Zone> & GetLastFrame();
+
+    /// \brief Returns the time spent in zones with the given category and name 
+    /// per frame, in milliseconds, averaged over the frames since the last 
+    /// ResetTotals().
+    ///
+    /// Time in nested zones with the same name and category is counted 
+    /// for each of them.
+    static double GetAverageMS(const char * category, const char * name);
+
+    /// \brief Returns the number of frames gathered since the last ResetTotals().
+    ///
+    static uint32_t GetTotalFrames();
+
+    /// \brief Returns the number of zones dropped since the last ResetTotals()
+    /// because a thread's ring was full.
+    ///
+    static uint64_t GetDroppedCount();
+
+    /// \brief Clears the running totals.
+    ///
+    static void ResetTotals();
+
+
+
+    /// \brief Starts keeping every gathered zone for ExportTrace().
+    ///
+    /// Any zones kept from an earlier capture are discarded.
+    static void BeginCapture();
+
+    /// \brief Stops keeping gathered zones.
+    ///
+    static void EndCapture();
+
+    /// \brief Returns whether a capture is in progress.
+    ///
+    static bool IsCapturing();
+
+    /// \brief Writes the captured zones to a file in Chrome's trace event 
+    /// format, which chrome://tracing and Perfetto can open.
+    ///
+    /// Returns whether the file could be written.
+    static bool ExportTrace(const std::string & path);
+
+  private:
+    static uint64_t begin();
+    static uint64_t end(const char * name, const char * category, uint64_t begin);
+    static std::atomic<bool> enabled;
+};
+
+}
+
+
+#define DC_PROFILE_CONCAT_(a, b) a##b
+#define DC_PROFILE_CONCAT(a, b) DC_PROFILE_CONCAT_(a, b)
+
+#ifndef DC_NO_PROFILER
+    /// \brief Times the rest of the enclosing scope as a Profiler zone.
+    ///
+    #define DC_PROFILE_ZONE(name, category) Dynacoe::Profiler::Scope DC_PROFILE_CONCAT(dcProfileZone, __LINE__)(name, category)
+#else
+    #define DC_PROFILE_ZONE(name, category)
+#endif
+
+#endif
@@ -0,0 +1,136 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#ifndef H_DC_SLAB_ALLOCATOR_INCLUDED
+#define H_DC_SLAB_ALLOCATOR_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace Dynacoe {
+
+/** \brief Pooled allocator for many small, short-lived objects.
+ *
+ * Requests are rounded up to a size class (a multiple of 16 bytes).
+ * Each size class carves its blocks out of large slabs and keeps
+ * freed blocks in a free list, so allocating and freeing
+ * is constant-time and never reaches the system allocator once
+ * the pool has warmed up. Objects of the same size class
+ * are packed together in memory. Requests larger than 
+ * GetMaxBlockSize() go to the system allocator.
+ *
+ * Entity and Component each own a SlabAllocator that backs their operator new.
+ * A SlabAllocator is not thread-safe.
+ *
+ * If the environment variable DYNACOE_NO_SLAB is set when the first
+ * allocation is made, every request is sent to the system allocator instead.
+ * This is helpful when using external memory debugging tools.
+ */
+class SlabAllocator {
+  public:
+    /// \brief Usage counters for a single size class.
+    ///
+    struct SizeClassStats {
+        /// \brief The size in bytes of each block in this class.
+        uint32_t blockSize;
+
+        /// \brief The number of blocks currently in use.
+        uint64_t live;
+
+        /// \brief The highest number of blocks ever in use at once.
+        uint64_t peak;
+
+        /// \brief The number of slabs reserved for this class.
+        uint64_t slabs;
+    };
+
+    /// \brief Creates an allocator. 
+    ///
+    /// @param name A short name for the allocator, used for reporting.
+    SlabAllocator(const char * name);
+
+    /// \brief Returns a block of at least the given size.
+    ///
+    void * Allocate(std::size_t size);
+
+    /// \brief Returns a block given by Allocate() to the pool.
+    ///
+    /// @param size The same size that was given to Allocate().
+    void Free(void * ptr, std::size_t size);
+
+    /// \brief Gives back to the system every slab whose blocks are all free.
+    ///
+    /// One empty slab per size class is kept for the next allocations.
+    /// This is meant to be called after many objects have been freed 
+    /// together; it costs nothing when too few blocks are free for 
+    /// any slab beyond the spare to be empty. Returns the number of 
+    /// slabs released.
+    uint32_t ReleaseEmptySlabs();
+
+    /// \brief Returns the counters for each size class that has been used.
+    ///
+    std::vector<SizeClassStats> GetStats() const;
+
+    /// \brief Returns the name of this allocator.
+    ///
+    const char * GetName() const { return name; }
+
+    /// \brief Returns the largest request that is served from slabs.
+    ///
+    static std::size_t GetMaxBlockSize();
+
+  private:
+    struct FreeBlock {
+        FreeBlock * next;
+    };
+
+    struct SizeClass {
+        FreeBlock * freeList;
+        uint64_t live;
+        uint64_t peak;
+        std::vector<char *> slabs;
+    };
+
+    void refill(uint32_t index);
+    uint32_t releaseEmptySlabs(uint32_t index);
+
+    const char * name;
+    std::vector<SizeClass> classes;
+    int enabled;
+    std::vector<uint32_t> freeCounts; // per slab, while releasing
+};
+
+}
+
+#endif
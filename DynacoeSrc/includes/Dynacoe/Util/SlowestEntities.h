@@ -0,0 +1,108 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#ifndef H_DC_SLOWEST_ENTITIES_INCLUDED
+#define H_DC_SLOWEST_ENTITIES_INCLUDED
+
+#include <Dynacoe/Entity.h>
+#include <vector>
+
+namespace Dynacoe {
+
+/** \brief Keeps the Entities that take the longest to step and draw.
+ *
+ * Each Entity keeps a smoothed (exponentially decayed) average of how 
+ * long its Step() and Draw() take, subtree included. Whenever one 
+ * finishes, that Entity is checked against a small min-heap of the 
+ * slowest Entities seen so far, so finding the slowest never needs a 
+ * scan of every Entity. Entities faster than the fastest in the heap 
+ * are turned away without taking a lock.
+ *
+ * Times come from the Profiler, so it must be enabled as well. Both 
+ * are disabled by default; the Debugger enables them while it is shown.
+ */
+class SlowestEntities {
+  public:
+
+    /// \brief An Entity in the list.
+    ///
+    struct Entry {
+        Entity::ID id;
+        float stepMS;   ///< Smoothed time taken by Step(), in milliseconds.
+        float drawMS;   ///< Smoothed time taken by Draw(), in milliseconds.
+    };
+
+    /// \brief Sets whether Entities are checked as they finish. 
+    ///
+    /// Disabling also clears the list.
+    static void SetEnabled(bool);
+    static bool IsEnabled();
+
+    /// \brief Sets how many Entities are kept. The default is 40.
+    ///
+    static void SetCount(uint32_t);
+
+    /// \brief Sets how much of each new time goes into the averages, from 
+    /// 0 to 1. Lower values give a steadier list. The default is .1.
+    ///
+    static void SetSmoothing(float);
+
+    /// \brief Only keeps the given Entity and those below it. 
+    ///
+    /// An invalid ID, the default, keeps Entities from anywhere. 
+    /// Changing the subtree clears the list.
+    static void SetSubtree(Entity::ID);
+    static Entity::ID GetSubtree();
+
+    /// \brief Returns the kept Entities, slowest first.
+    ///
+    static std::vector<Entry> Get();
+
+    /// \brief Empties the list.
+    ///
+    static void Clear();
+
+    /// \brief Decays the averages of kept Entities that did not step or 
+    /// draw this frame. Called by the engine once per frame.
+    ///
+    static void EndFrame();
+
+  private:
+    friend class Entity;
+    static void Report(Entity *, bool draw, double ms);
+    static void Forget(Entity *);
+};
+
+}
+
+#endif
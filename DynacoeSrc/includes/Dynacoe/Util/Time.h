@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 
 #include <cstdlib>
+#include <cstdint>
 
 // Waits on the calling thread for the specifed number of milliseconds */
 namespace Dynacoe {
@@ -50,7 +51,46 @@ class Time {
 
     /// \brief Returns the number of milliseconds past since the program was created.
     ///
+    /// This is NsSinceStartup() in milliseconds.
     static double MsSinceStartup();
+
+    /// \brief Returns the number of nanoseconds past since the program was created.
+    ///
+    /// The clock is monotonic: it is not affected by changes to the 
+    /// system time.
+    static uint64_t NsSinceStartup();
+
+    /// \brief Sleeps on the current thread until NsSinceStartup() reaches 
+    /// the given deadline.
+    ///
+    /// The OS sleep is only trusted to wake up within spinNs of the deadline;
+    /// the rest of the wait is spent spinning. A larger value is more precise 
+    /// but burns more CPU time.
+    static void SleepUntilNs(uint64_t deadline, uint64_t spinNs = 0);
+
+    /// \brief Returns the game time in milliseconds. 
+    ///
+    /// This is the time that Clock, and everything built on it, as well 
+    /// as Sequencer, keep time with. Normally, it moves along with 
+    /// MsSinceStartup(). While the virtual clock is enabled, it only 
+    /// moves when AdvanceVirtualClock() is called.
+    static double GameMsSinceStartup();
+
+    /// \brief Enables or disables the virtual clock.
+    ///
+    /// Game time carries on from where it was when switching 
+    /// either way. Engine::RunFrames() enables the virtual clock 
+    /// while it runs.
+    static void SetVirtualClock(bool);
+
+    /// \brief Returns whether the virtual clock is enabled.
+    ///
+    static bool GetVirtualClock();
+
+    /// \brief Moves game time forward by the given number of milliseconds.
+    ///
+    /// Has no effect unless the virtual clock is enabled.
+    static void AdvanceVirtualClock(double ms);
 };
 }
 
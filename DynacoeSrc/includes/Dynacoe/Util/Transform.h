@@ -123,6 +123,12 @@ class Transform {
     /// \brief Returns whether an update to this transform is 
     /// pending.
     bool NeedsUpdate() const;
+
+    /// \brief Returns a counter that changes every time the 
+    /// transform is flagged for an update. Comparing it against 
+    /// a previously read value tells whether the transform has been 
+    /// modified since.
+    uint32_t GetRevision() const;
   
   private:
 
@@ -133,6 +139,7 @@ class Transform {
 
     bool reverse;
     bool needsUpdate;
+    uint32_t revision;
     Vector position;
     Vector rotation;
     Vector scale;
@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Dynacoe/AudioBlock.h>
 #include <Dynacoe/Util/Math.h>
+#include <Dynacoe/Util/MemoryStats.h>
 
 
 #include <cmath>
@@ -56,17 +57,24 @@ AudioBlock::AudioBlock(const string & n) : Asset(n){
 
 
 AudioBlock::~AudioBlock() {
-    if (data)
+    setData(nullptr, 0);
+}
+
+void AudioBlock::setData(char * newData, uint32_t newSize) {
+    MemoryStats::Track(
+        MemoryStats::Category::AudioData, 
+        (int64_t)newSize - (data ? size : 0),
+        (newData ? 1 : 0) - (data ? 1 : 0)
+    );
     delete[] data;
+    data = newData;
+    size = newSize;
 }
 
 void AudioBlock::Define(AudioSample * src, uint32_t numSamples) {
-    
-
-    if (data) delete[] data;
-    data = (char *)(new AudioSample[numSamples]);
-    memcpy(data, src, numSamples*sizeof(AudioSample));
-    size = numSamples*sizeof(AudioSample);
+    char * newData = new char[numSamples*sizeof(AudioSample)];
+    memcpy(newData, src, numSamples*sizeof(AudioSample));
+    setData(newData, numSamples*sizeof(AudioSample));
 }
 
 void AudioBlock::SetVolume(float v) {
@@ -107,11 +115,12 @@ AudioBlock * AudioBlock::GetSubBlock(uint32_t  begin, uint32_t end) {
     if (end >= NumSamples()) end = NumSamples() - 1;
 
     AudioBlock * out = new AudioBlock(GetAssetName() + "@SubBlock");
-    out->size = (end-begin+1) * sizeof(AudioSample);
-    char * tempData = new char[out->size];
+    uint32_t subSize = (end-begin+1) * sizeof(AudioSample);
+    char * tempData = new char[subSize];
     memcpy(tempData,
            data + sizeof(AudioSample) * begin,
-           out->size);
+           subSize);
+    out->setData(tempData, subSize);
     out->index = AssetID();
     out->path = "";
     return out;
@@ -148,9 +157,7 @@ void AudioBlock::RemoveBlock(uint32_t begin, uint32_t end) {
            data    + (begin) * sizeof(AudioSample) + blockSize,
            newSize - (begin) * sizeof(AudioSample));
 
-    delete[] data;
-    data = newData;
-    size = newSize;
+    setData(newData, newSize);
 }
 
 void AudioBlock::InsertBlock(uint32_t begin, AudioBlock * block) {
@@ -165,9 +172,7 @@ void AudioBlock::InsertBlock(uint32_t begin, AudioBlock * block) {
     memcpy(newData + NumBytes(),
            block->data,
            block->NumBytes());
-    delete[] data;
-    data = newData;
-    size = newSize;
+    setData(newData, newSize);
 
 
 }
@@ -201,12 +206,10 @@ void AudioBlock::Append(AudioSample * nData, uint32_t nData_size) {
     char *   newData = new char[newSize];
     if (size) {
         memcpy(newData, data, size);
-        delete[] data;
     }
     memcpy(newData + size, &nData[0], nData_size*sizeof(AudioSample));
    
-    data = newData;
-    size = newSize;
+    setData(newData, newSize);
 
 }
 
@@ -216,8 +219,7 @@ AudioBlock * AudioBlock::CreateSine(float pitch, float roughness, uint8_t volume
     uint32_t chunkSize = ceil(DYNACOE_SAMPLE_RATE * duration_sec);
     chunkSize += chunkSize % sizeof(AudioSample);
     AudioBlock * sample = new AudioBlock("Internal_AudioSample@??");
-    sample->data = new char[chunkSize];
-    sample->size = chunkSize;
+    sample->setData(new char[chunkSize], chunkSize);
     sample->volume = volume;
 
 
@@ -238,8 +240,7 @@ AudioBlock * AudioBlock::CreateHit(float pitch, float impact, float roughness, u
     uint32_t chunkSize = ceil(DYNACOE_SAMPLE_RATE * 1);
     chunkSize += chunkSize % sizeof(AudioSample);
     AudioBlock * sample = new AudioBlock("Internal_AudioSample@??");
-    sample->data = new char[chunkSize];
-    sample->size = chunkSize;
+    sample->setData(new char[chunkSize], chunkSize);
     sample->volume = volume;
 
 
@@ -38,8 +38,8 @@ using std::string;
 
 
 bool        NoAudioManager::Connect(){ return true; }
-void        NoAudioManager::SetSampleRate(uint32_t){}
-uint32_t    NoAudioManager::GetSampleRate(){return 0;}
+void        NoAudioManager::SetSampleRate(uint32_t i){sampleRate = i;}
+uint32_t    NoAudioManager::GetSampleRate(){return sampleRate;}
 void        NoAudioManager::PushData(float *, uint32_t){}
 uint32_t    NoAudioManager::PendingSamplesCount(){return 0;}
 bool        NoAudioManager::Underrun(){return false;}
@@ -34,6 +34,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Dynacoe/Backends/AudioManager/RtAudio_Multi.h>
 #include <Dynacoe/Util/Math.h>
+#include <Dynacoe/Modules/Console.h>
 #include <iostream>
 
 using namespace Dynacoe;
@@ -315,11 +316,12 @@ int RtAudioManager::StreamCallback(
   void * userData) {
     
 
+    // runs on the audio thread: the console queues these without blocking.
     if (status & RTAUDIO_INPUT_OVERFLOW) {
-        cout << "Audio manager: internal overflow!" << endl;
+        Console::Warning() << DC_CONSOLE_RATE_LIMIT(1) << "Audio manager: internal overflow!" << Console::End;
         return 0;
     } else if (status & RTAUDIO_OUTPUT_UNDERFLOW) {
-        cout << "Audio manager: output underflow! (framerate too low to compensate?): " << nBufferFrames << endl;
+        Console::Warning() << DC_CONSOLE_RATE_LIMIT(1) << "Audio manager: output underflow! (framerate too low to compensate?): " << nBufferFrames << Console::End;
     }
 
 
@@ -37,6 +37,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Dynacoe/Backends/Display/NoDisplay_Multi.h>
 #include <Dynacoe/Backends/Display/OpenGLFramebuffer_Multi.h>
+#include <Dynacoe/Backends/Display/Pixmap_X11.h>
 
 #include <Dynacoe/Backends/InputManager/Gainput_Multi.h>
 #include <Dynacoe/Backends/InputManager/NoInput_Multi.h>
@@ -44,10 +45,12 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Dynacoe/Backends/Renderer/ShaderGL_Multi.h>
 #include <Dynacoe/Backends/Renderer/NoRender_Multi.h>
+#include <Dynacoe/Backends/Renderer/SoftRender_Multi.h>
 
 
 #include <Dynacoe/Backends/Framebuffer/OpenGLFB_Multi.h>
 #include <Dynacoe/Backends/Framebuffer/NOFB_Multi.h>
+#include <Dynacoe/Backends/Framebuffer/PixelFB_Multi.h>
 
 using namespace Dynacoe;
 
@@ -78,7 +81,9 @@ Backend * Backend::CreateDefaultRenderer() {
     #if(defined DC_BACKENDS_SHADERGL_X11 | defined DC_BACKENDS_SHADERGL_WIN32)
     return new ShaderGLRenderer();
     #endif
-
+    #if (defined DC_BACKENDS_SOFTRENDER)
+    return new SoftRenderer();
+    #endif
 
     return new NoRenderer();
 }
@@ -111,6 +116,9 @@ Backend * Backend::CreateDefaultDisplay() {
     #if(defined DC_BACKENDS_OPENGLFRAMEBUFFER_X11 || defined DC_BACKENDS_OPENGLFRAMEBUFFER_WIN32)
     return new OpenGLFBDisplay();
     #endif
+    #if (defined DC_BACKENDS_PIXMAP_X11)
+    return new PixmapDisplay();
+    #endif
     return new NoDisplay();
 }
 
@@ -119,6 +127,9 @@ Backend * Backend::CreateDefaultFramebuffer() {
     #if(defined DC_BACKENDS_SHADERGL_X11 || defined DC_BACKENDS_SHADERGL_WIN32 || DC_BACKENDS_LEGACYGL_WIN32 || DC_BACKENDS_LEGACYGL_X11)
     return new OpenGLFB();
     #endif
+    #if (defined DC_BACKENDS_SOFTRENDER)
+    return new PixelFB();
+    #endif
     return new NoFB();
 }
 
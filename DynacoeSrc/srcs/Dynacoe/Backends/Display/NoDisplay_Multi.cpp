@@ -53,6 +53,7 @@ void NoDisplay::Hide(bool){}
 void NoDisplay::LockClientResize(bool){}
 void NoDisplay::LockClientPosition(bool){}
 void NoDisplay::SetViewPolicy(ViewPolicy){}
+bool NoDisplay::HasInputFocus(){return false;}
 
 
 int NoDisplay::Width(){return 0;}
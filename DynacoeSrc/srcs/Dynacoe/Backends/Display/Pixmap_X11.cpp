@@ -31,346 +31,343 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #ifdef DC_BACKENDS_PIXMAP_X11
+
 #include <Dynacoe/Backends/Display/Pixmap_X11.h>
 #include <X11/Xatom.h>
 
 #include <iostream>
-#include <cassert>
-#include <stack>
-
-#include <Dynacoe/Components/Random.h>
+#include <cstdlib>
+#include <cstring>
 
 
-const int display_default_w_c       =   640;    
+const int display_default_w_c       =   640;
 const int display_default_h_c       =   480;
 
 
 
 using namespace std;
 
-static int xlibErrHandler(Display *, XErrorEvent *);
+static int xlibErrHandler(X11Display *, XErrorEvent *);
 
+// Position and width of the lowest run of set bits in a channel mask.
+static void maskLayout(unsigned long mask, int & shift, int & bits) {
+    shift = 0;
+    bits = 0;
+    if (!mask) return;
+    while(!(mask & 1)) {mask >>= 1; shift++;}
+    while(mask & 1)    {mask >>= 1; bits++;}
+}
 
 
 
-/* Display methods */
 
+/* PixmapDisplay methods */
 
+Dynacoe::PixmapDisplay::PixmapDisplay() {
+    valid = false;
+    policy = ViewPolicy::MatchSize;
+    framebuffer = nullptr;
+    image = nullptr;
+    gc = 0;
+    win = 0;
+    winX = winY = 0;
+    winW = display_default_w_c;
+    winH = display_default_h_c;
 
+    XSetErrorHandler(xlibErrHandler);
+    dpy = XOpenDisplay(NULL);
+    if (!dpy) {
+        cout << "PixmapDisplay[X11]: Could not connect to X server..." << endl;
+        return;
+    }
 
+    int screen = DefaultScreen(dpy);
+    Visual * visual = DefaultVisual(dpy, screen);
+    if (visual->c_class != TrueColor) {
+        cout << "PixmapDisplay[X11]: Only TrueColor visuals are supported." << endl;
+        return;
+    }
+    maskLayout(visual->red_mask,   channelShift[0], channelBits[0]);
+    maskLayout(visual->green_mask, channelShift[1], channelBits[1]);
+    maskLayout(visual->blue_mask,  channelShift[2], channelBits[2]);
+
+    XSetWindowAttributes swa;
+    swa.background_pixel = BlackPixel(dpy, screen);
+    swa.event_mask = ExposureMask | StructureNotifyMask
+		| KeyPressMask | KeyReleaseMask
+		| PointerMotionMask | ButtonPressMask | ButtonReleaseMask;
 
-Dynacoe::Display::Display() {
-    priv = new DisplayImpl;
+    win = XCreateWindow(
+        dpy,
+        DefaultRootWindow(dpy),
+        0,
+        0,
+        winW, winH,
+        0, DefaultDepth(dpy, screen),
+        InputOutput,
+        visual,
+        CWBackPixel | CWEventMask, &swa
+    );
+
+    deleteMessage = XInternAtom(dpy, "WM_DELETE_WINDOW", False);
+    XSetWMProtocols(dpy, win, &deleteMessage, 1);
+    XStoreName(dpy, win, "Dynacoe");
+    XMapWindow(dpy, win);
+    gc = XCreateGC(dpy, win, 0, NULL);
+    XFlush(dpy);
+    valid = true;
 }
 
-Dynacoe::Display::~Display() {
-    delete priv;
+Dynacoe::PixmapDisplay::~PixmapDisplay() {
+    if (!dpy) return;
+    if (image) XDestroyImage(image);
+    if (gc) XFreeGC(dpy, gc);
+    if (win) XDestroyWindow(dpy, win);
+    XCloseDisplay(dpy);
 }
 
+bool Dynacoe::PixmapDisplay::IsCapable(Capability c) {
+    return c != Capability::CanLockSize;
+}
 
-bool Dynacoe::Display::isValid() {return priv->valid;}
+bool Dynacoe::PixmapDisplay::Valid() {return valid;}
 
-void Dynacoe::Display::resize(int w, int h) {
-    XResizeWindow(priv->dpy, priv->win, w, h);
-    XFlush(priv->dpy);
-    priv->winW = w;
-    priv->winH = h;
+void Dynacoe::PixmapDisplay::Resize(int w, int h) {
+    XResizeWindow(dpy, win, w, h);
+    XFlush(dpy);
+    winW = w;
+    winH = h;
 }
 
-void Dynacoe::Display::hide(bool b) {
-    XUnmapWindow(priv->dpy, priv->win);
-    XFlush(priv->dpy);
-
+void Dynacoe::PixmapDisplay::Hide(bool b) {
+    if (b)
+        XUnmapWindow(dpy, win);
+    else
+        XMapWindow(dpy, win);
+    XFlush(dpy);
 }
 
+void Dynacoe::PixmapDisplay::LockClientResize(bool) {}
+void Dynacoe::PixmapDisplay::LockClientPosition(bool) {}
+
 
-void Dynacoe::Display::fullscreen(bool d) {
+void Dynacoe::PixmapDisplay::Fullscreen(bool d) {
     if (d) {
-        Atom atoms[2] = { XInternAtom(priv->dpy, "_NET_WM_STATE_FULLSCREEN", False), None };
-        int status = XChangeProperty(
-          priv->dpy, 
-          priv->win, 
-          XInternAtom(priv->dpy, "_NET_WM_STATE", False),
+        Atom atoms[2] = { XInternAtom(dpy, "_NET_WM_STATE_FULLSCREEN", False), None };
+        XChangeProperty(
+          dpy,
+          win,
+          XInternAtom(dpy, "_NET_WM_STATE", False),
           XA_ATOM, 32, PropModeReplace, (unsigned char *)atoms, 1
         );
-        XFlush(priv->dpy);
-        std::cout << status << std::endl;
+        XFlush(dpy);
     }
 }
 
 
-void Dynacoe::Display::setPos(int x, int y) {
-    XMoveWindow(priv->dpy, priv->win, x, y);
+void Dynacoe::PixmapDisplay::SetPosition(int x, int y) {
+    XMoveWindow(dpy, win, x, y);
+}
+
+int Dynacoe::PixmapDisplay::Width() {
+    return winW;
 }
 
-int Dynacoe::Display::getW() {
-    return priv->winW;
+int Dynacoe::PixmapDisplay::Height() {
+    return winH;
 }
 
-int Dynacoe::Display::getH() {
-    return priv->winH;
+int Dynacoe::PixmapDisplay::X() {
+    return winX;
 }
 
-int Dynacoe::Display::getX() {
-    return priv->winX;
+int Dynacoe::PixmapDisplay::Y() {
+    return winY;
 }
 
-int Dynacoe::Display::getY() {
-    return priv->winY;
+void Dynacoe::PixmapDisplay::SetName(const string & name) {
+    XStoreName(dpy, win, name.c_str());
+    XFlush(dpy);
 }
 
-void Dynacoe::Display::setName(const string & name) {
-    XStoreName(priv->dpy, priv->win, name.c_str());
-    XFlush(priv->dpy);
+bool Dynacoe::PixmapDisplay::HasInputFocus() {
+    Window ret;
+    int unused;
+
+    XGetInputFocus(dpy, &ret, &unused);
+    return ret == win;
 }
 
 
-int Dynacoe::Display::getViewX() {return priv->viewX;}
-int Dynacoe::Display::getViewY() {return priv->viewY;}
-int Dynacoe::Display::getViewW() {return priv->viewW;}
-int Dynacoe::Display::getViewH() {return priv->viewH;}
 
-void Dynacoe::Display::setView(int x, int y, int w, int h) {
-    priv->viewX = x;
-    priv->viewY = y;    
-    priv->viewW = w;
-    priv->viewH = h;
+void Dynacoe::PixmapDisplay::SetViewPolicy(ViewPolicy v) {
+    policy = v;
 }
 
+void Dynacoe::PixmapDisplay::AttachSource(Dynacoe::Framebuffer * f) {
+    if (!f || f->GetHandleType() == Dynacoe::Framebuffer::Type::RGBA_PixelArray)
+        framebuffer = f;
+}
 
-void Dynacoe::Display::updateDisplay(void * data) {
-    priv->frame = (uint8_t*)data;
-    
-    static Random rng;
-    static float patter = 0;
-    patter+=.1;
-    
-    int num = DefaultDepth(priv->dpy, DefaultScreen(priv->dpy));
-
-    // update data in pixmap
-    /*
-    for(int y = 0; y < 30; ++y) { 
-        for(int x = 0; x < 30; ++x) {
-            //XSetForeground(priv->dpy, priv->gcontext, Color(rng.spread(0, 256), rng.spread(0, 256), rng.spread(0, 256), 255).Int());
-            //XDrawPoint(priv->dpy, priv->pixmap, priv->gcontext, x, y); 
-            //XPutPixel(&priv->framebuffer, x, y, Color(rng.spread(0, 256), rng.spread(0, 256), rng.spread(0, 256), 255).Int());
-            priv->framebuffer->data[(x + priv->framebuffer->width*y)*4] =   sin(patter)*255;
-            priv->framebuffer->data[(x + priv->framebuffer->width*y)*4+1] = sin(patter)*255;
-            priv->framebuffer->data[(x + priv->framebuffer->width*y)*4+2] = sin(patter)*255;
-            priv->framebuffer->data[(x + priv->framebuffer->width*y)*4+3] = sin(patter)*255;
-        }
-    }
-    */
-    framebuffer->data = data;
+Dynacoe::Framebuffer * Dynacoe::PixmapDisplay::GetSource() {
+    return framebuffer;
+}
 
-    // consume only configure events to get resizes.
-    // Merely egnore all other event types and put them
-    // back into the event queue.
+std::vector<Dynacoe::Framebuffer::Type> Dynacoe::PixmapDisplay::SupportedFramebuffers() {
+    return std::vector<Dynacoe::Framebuffer::Type>({
+        Dynacoe::Framebuffer::Type::RGBA_PixelArray
+    });
+}
+
+void Dynacoe::PixmapDisplay::Update() {
+    if (!valid) return;
 
-    int numEvs = XEventsQueued(priv->dpy, QueuedAlready);
-    std::stack<XEvent> evtList;
+    // Nothing else reads from the connection, so pending events
+    // are pulled in here.
+    int numEvs = XPending(dpy);
+    lastEvents.clear();
     XEvent evt;
 
     for(int i = 0; i < numEvs; ++i) {
-        XNextEvent(priv->dpy, &evt);
+        XNextEvent(dpy, &evt);
         if (evt.type == ConfigureNotify) {
-            priv->updateDims();
-            for(ResizeCallback * r : priv->resizeCBs) {
-                (*r)(priv->winW, priv->winH);
+            updateDims();
+            for(ResizeCallback * r : resizeCBs) {
+                (*r)(winW, winH);
+            }
+        } else if (evt.type == ClientMessage && (Atom)evt.xclient.data.l[0] == deleteMessage) {
+            for(CloseCallback * c : closeCBs) {
+                (*c)();
             }
-            
-        } else {
-            evtList.push(evt);
         }
+        lastEvents.push_back(evt);
     }
-    while(!evtList.empty()) {
-        XPutBackEvent(priv->dpy, &evtList.top());
-        evtList.pop();
-    }
-    
-
-
-   
 
-    // perhaps query input here if input lib is dependent on the win manager.  
-    int w = getW(),
-        h = getH();
-    priv->drawFrame(w, h);
-    // render tex on this context's framebuffer.
+    drawFrame();
 }
 
 
-void Dynacoe::Display::addResizeCallback(ResizeCallback * cb) {
+void Dynacoe::PixmapDisplay::AddResizeCallback(ResizeCallback * cb) {
     if (cb)
-        priv->resizeCBs.push_back(cb);
+        resizeCBs.push_back(cb);
 }
 
-void Dynacoe::Display::removeResizeCallback(ResizeCallback * cb) {
-    for(int i = 0; i < priv->resizeCBs.size(); ++i) {
-        if (priv->resizeCBs[i] == cb) {
-            priv->resizeCBs.erase(priv->resizeCBs.begin() + i);
+void Dynacoe::PixmapDisplay::RemoveResizeCallback(ResizeCallback * cb) {
+    for(size_t i = 0; i < resizeCBs.size(); ++i) {
+        if (resizeCBs[i] == cb) {
+            resizeCBs.erase(resizeCBs.begin() + i);
         }
     }
 }
 
 
+void Dynacoe::PixmapDisplay::AddCloseCallback(CloseCallback * cb) {
+    if (cb)
+        closeCBs.push_back(cb);
+}
 
-/* Implementation methods */
-
-Dynacoe::DisplayImpl::DisplayImpl() {
-
-    viewX = 0;
-    viewY = 0;
-    viewW = 640;
-    viewH = 480;
-
-    winX = winY = winH = winW = 0;
-    valid = realize();
-
-    
+void Dynacoe::PixmapDisplay::RemoveCloseCallback(CloseCallback * cb) {
+    for(size_t i = 0; i < closeCBs.size(); ++i) {
+        if (closeCBs[i] == cb) {
+            closeCBs.erase(closeCBs.begin() + i);
+        }
+    }
 }
 
-bool Dynacoe::DisplayImpl::realize() {
-    flags = 
-        Dynacoe::Display::Capability::CAN_RESIZE | 
-        Dynacoe::Display::Capability::CAN_MOVE | 
-        Dynacoe::Display::Capability::CAN_FULLSCREEN | 
-        Dynacoe::Display::Capability::CAN_HIDE;
 
-    return 
-        spawnWindow("Dynacoe - OpenGL", 640, 480)
-    ;
+/* Implementation methods */
 
+void Dynacoe::PixmapDisplay::updateDims() {
+    XWindowAttributes gwa;
+    XGetWindowAttributes(dpy, win, &gwa);
+    winW = gwa.width;
+    winH = gwa.height;
+    winX = gwa.x;
+    winY = gwa.y;
 }
 
 
-// Spawns a Win32 window and returns its handle
-bool Dynacoe::DisplayImpl::spawnWindow(const char * name, int _w, int _h) {
-
-    dpy = XOpenDisplay(NULL);
-    XSetErrorHandler(xlibErrHandler);
-     
-    if (!dpy) {
-        cout << "Display[Pixmap-X11]: Could not connect to X server..." << endl;
-        return false;
+// Converts the source's RGBA pixels into the window-sized image, 
+// stretched or not according to the view policy, and puts it up.
+void Dynacoe::PixmapDisplay::drawFrame() {
+    if (!framebuffer || !winW || !winH) return;
+    const uint8_t * src = (const uint8_t *)framebuffer->GetHandle();
+    int srcW = framebuffer->Width();
+    int srcH = framebuffer->Height();
+    if (!src || srcW <= 0 || srcH <= 0) return;
+
+    if (!image || image->width != (int)winW || image->height != (int)winH) {
+        if (image) XDestroyImage(image);
+        int screen = DefaultScreen(dpy);
+        image = XCreateImage(
+            dpy,
+            DefaultVisual(dpy, screen),
+            DefaultDepth(dpy, screen),
+            ZPixmap,
+            0,
+            nullptr,
+            winW, winH,
+            32,
+            0
+        );
+        if (!image) return;
+        // XDestroyImage() releases this with free().
+        image->data = (char*)malloc(image->bytes_per_line * winH);
     }
-            
-    root = DefaultRootWindow(dpy);
-
 
-    swa.colormap = cmap;
-    swa.event_mask = ExposureMask | StructureNotifyMask
-		| KeyPressMask | KeyReleaseMask
-		| PointerMotionMask | ButtonPressMask | ButtonReleaseMask;
-     
-    win = XCreateSimpleWindow(
-        dpy, 
-        root, 
-        0, 
-        0, 
-        _w, _h, 
-        0,
-        0,
-        0
-    );
-
-    XMapWindow(dpy, win);
-    XStoreName(dpy, win, name);
-   
-
-    
-
-    pixmap = XCreatePixmap(dpy, win, _w, _h, DefaultDepth(dpy, DefaultScreen(dpy)));
-
-    unsigned long valuemask = 0;
-    XGCValues values;
-    unsigned int line_width = 1;
-    int line_style = LineSolid;
-    int cap_style = CapButt;
-    int join_style = JoinBevel;
-    int screen_num = DefaultScreen(dpy);
-
-    gcontext = XCreateGC(dpy, win, valuemask, &values);
-    if (gcontext < 0) {
-        cout << "[Display::Pixmap]: Failed to create X11 graphics context!\n" << endl;
+    bool stretch = policy == ViewPolicy::MatchSize;
+    bool direct = image->bits_per_pixel == 32;
+    for(uint32_t y = 0; y < winH; ++y) {
+        int sy = stretch ? (int)((uint64_t)y * srcH / winH) : (int)y;
+        uint32_t * row = (uint32_t*)(image->data + y * image->bytes_per_line);
+        for(uint32_t x = 0; x < winW; ++x) {
+            int sx = stretch ? (int)((uint64_t)x * srcW / winW) : (int)x;
+            unsigned long pixel = 0;
+            if (sx < srcW && sy < srcH) {
+                const uint8_t * p = src + (sy*srcW + sx)*4;
+                for(int c = 0; c < 3; ++c) {
+                    pixel |= (unsigned long)(p[c] >> (8 - channelBits[c])) << channelShift[c];
+                }
+            }
+            if (direct)
+                row[x] = pixel;
+            else
+                XPutPixel(image, x, y, pixel);
+        }
     }
 
-
-
-    XSetForeground(dpy, gcontext, BlackPixel(dpy, screen_num));
-    XSetBackground(dpy, gcontext, WhitePixel(dpy, screen_num));
-    XSetLineAttributes(dpy, gcontext, line_width, line_style, cap_style, join_style);
-
-    XSetFillStyle(dpy, gcontext, FillSolid);
-
-
-    framebuffer = XCreateImage( 
-        dpy,
-        XDefaultVisual( dpy, DefaultScreen(dpy)),
-        XDefaultDepth ( dpy, DefaultScreen(dpy)),
-        ZPixmap,
-        0,
-        new char[_w*_h*4],
-        _w, 
-        _h,
-        32,
-        _w*4
-    );
-
+    XPutImage(dpy, win, gc, image, 0, 0, 0, 0, winW, winH);
     XFlush(dpy);
-    return true;
 }
 
 
 
-// Draws all the information to the screen.
-// All draws from this frame were rendered to this texture.
-void Dynacoe::DisplayImpl::drawFrame(int w, int h) {
-
-    
-    //XCopyArea(dpy, pixmap, win, gcontext, 0, 0, w, h, 0, 0);
-    XPutImage(dpy, win, gcontext, framebuffer, 0, 0, 0, 0, w, h);    
-
-
-    XFlush(dpy);
+Dynacoe::Display::DisplayHandleType Dynacoe::PixmapDisplay::GetSystemHandleType() {
+    return DisplayHandleType::X11Display;
 }
 
-Dynacoe::Display::VisualDataType Dynacoe::Display::requiredDisplayDataClass() {
-    return Dynacoe::Display::VisualDataType::RGBA_PixelArray;
+void * Dynacoe::PixmapDisplay::GetSystemHandle() {
+    return dpy;
 }
 
-void Dynacoe::DisplayImpl::updateDims() {
-    unsigned int depth, border;
-    Window getRoot; 
-    //XGetGeometry(dpy, win, &getRoot, 
-    //    &winX, &winY, &winW, &winH,
-    //    &border, &depth
-    //);
-
-    XGetWindowAttributes(dpy, win, &gwa);
-    winH = gwa.height;
-    winW = gwa.width;
-
-    XFlush(dpy);
-
-
-    XFreePixmap(dpy, pixmap);
-    pixmap = XCreatePixmap(dpy, win, winW, winH, DefaultDepth(dpy, DefaultScreen(dpy)));
-
-
+Dynacoe::Display::DisplayEventType Dynacoe::PixmapDisplay::GetSystemEventType() {
+    return DisplayEventType::X11Event;
 }
 
+void * Dynacoe::PixmapDisplay::GetLastSystemEvent() {
+    return &lastEvents;
+}
 
 
-
-int xlibErrHandler(Display * d, XErrorEvent * e) {
+int xlibErrHandler(X11Display * d, XErrorEvent * e) {
     char bufferErr[4096];
     XGetErrorText(d, e->error_code, bufferErr, 4096);
-    
-
     cout << endl << "Dynacoe::X11 Error: " << bufferErr << endl;
     return 0;
 }
 
-#endif
 
+std::string Dynacoe::PixmapDisplay::Name() {return "PixmapDisplay (For X11)";}
+std::string Dynacoe::PixmapDisplay::Version() {return "v1.0";}
+
+#endif
@@ -0,0 +1,93 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+#include <Dynacoe/Backends/Framebuffer/PixelFB_Multi.h>
+#include <Dynacoe/Util/MemoryStats.h>
+#include <cstring>
+
+using namespace Dynacoe;
+
+
+PixelFB::PixelFB() : Framebuffer(
+        Framebuffer::Type::RGBA_PixelArray,
+        0,
+        0,
+        nullptr
+    ){
+    pixels = nullptr;
+    depth = nullptr;
+    Resize(640, 480);
+}
+
+PixelFB::~PixelFB() {
+    if (pixels)
+        MemoryStats::Track(MemoryStats::Category::Textures, -(int64_t)Width()*Height()*8, -1);
+    delete[] pixels;
+    delete[] depth;
+}
+
+
+// Contents are not kept across a resize, same as a GL render target.
+bool PixelFB::OnResize(void *, int newW, int newH) {
+    if (newW <= 0 || newH <= 0) return false;
+    uint8_t * newPixels = new uint8_t[newW*newH*4]();
+    float * newDepth = new float[newW*newH];
+    for(int i = 0; i < newW*newH; ++i) newDepth[i] = 1.f;
+
+    if (pixels) {
+        MemoryStats::Track(MemoryStats::Category::Textures, ((int64_t)newW*newH - (int64_t)Width()*Height())*8);
+    } else {
+        MemoryStats::Track(MemoryStats::Category::Textures, (int64_t)newW*newH*8, 1);
+    }
+    delete[] pixels;
+    delete[] depth;
+    pixels = newPixels;
+    depth = newDepth;
+    SetHandle(pixels);
+    return true;
+}
+
+
+bool PixelFB::GetRawData(uint8_t * data) {
+    if (!pixels) return false;
+    uint32_t count = Width()*Height();
+    memcpy(data, pixels, count*4);
+    for(uint32_t i = 0; i < count; ++i) {
+        data[i*4+3] = 255;
+    }
+    return true;
+}
+
+std::string PixelFB::Name() {return "Pixel Framebuffer";}
+std::string PixelFB::Version() {return "v1.0";}
+bool        PixelFB::Valid() {return true;}
+
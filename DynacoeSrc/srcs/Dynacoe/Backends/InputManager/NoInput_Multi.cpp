@@ -31,18 +31,41 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <Dynacoe/Backends/InputManager/NoInput_Multi.h> 
+#include <Dynacoe/Backends/InputManager/InputDevice.h>
 
 using namespace std;
 using namespace Dynacoe;
 
 
 
+// The Input module reads the default devices without checking for them,
+// so they are provided here and simply never change.
+NoInputManager::NoInputManager() {
+    devices.resize((int)DefaultDeviceSlots::NumDefaultDevices);
+    devices[(int)DefaultDeviceSlots::Keyboard] = new InputDevice((int)Keyboard::NumButtons, 0);
+    devices[(int)DefaultDeviceSlots::Mouse] = new InputDevice((int)MouseButtons::NumButtons, (int)MouseAxes::NumAxes);
+    devices[(int)DefaultDeviceSlots::Touchpad] = new InputDevice(0, 0);
+    devices[(int)DefaultDeviceSlots::Pad1] = new InputDevice(0, 0);
+    devices[(int)DefaultDeviceSlots::Pad2] = new InputDevice(0, 0);
+    devices[(int)DefaultDeviceSlots::Pad3] = new InputDevice(0, 0);
+    devices[(int)DefaultDeviceSlots::Pad4] = new InputDevice(0, 0);
+}
+
+NoInputManager::~NoInputManager() {
+    for(size_t i = 0; i < devices.size(); ++i) {
+        delete devices[i];
+    }
+}
+
 bool NoInputManager::IsSupported(InputManager::InputType){return false;}
 bool NoInputManager::HandleEvents(){return false;}
-InputDevice * NoInputManager::QueryDevice(int i) {return nullptr;}
-InputDevice * NoInputManager::QueryDevice(DefaultDeviceSlots i) {return nullptr;}
+InputDevice * NoInputManager::QueryDevice(int i) {
+    if (i < 0 || i >= (int)devices.size()) return nullptr;
+    return devices[i];
+}
+InputDevice * NoInputManager::QueryDevice(DefaultDeviceSlots i) {return QueryDevice((int)i);}
 int NoInputManager::QueryAuxiliaryDevices(int *){return 0;}
-int NoInputManager::MaxDevices(){return 0;}
+int NoInputManager::MaxDevices(){return (int)DefaultDeviceSlots::NumDefaultDevices;}
 void NoInputManager::SetFocus(Display*){}
 Display * NoInputManager::GetFocus(){return nullptr;}
 
@@ -0,0 +1,90 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+#include <Dynacoe/Backends/Renderer/NoRender_Multi.h>
+#include <Dynacoe/Util/MemoryStats.h>
+
+
+using namespace Dynacoe;
+
+// Nothing is drawn, but 2D vertices are still stored so that 
+// they read back as they were set.
+
+bool NoRenderer::Valid() {return true;}
+
+
+void NoRenderer::Queue2DVertices(const uint32_t *, uint32_t){}
+
+uint32_t NoRenderer::Add2DObject() {
+    if (deadObjects.size()) {
+        uint32_t out = deadObjects.back();
+        deadObjects.pop_back();
+        return out;
+    }
+    return objectCount++;
+}
+
+void NoRenderer::Remove2DObject(uint32_t object) {
+    deadObjects.push_back(object);
+}
+
+uint32_t NoRenderer::Add2DVertex() {
+    if (deadVertices.size()) {
+        uint32_t out = deadVertices.back();
+        deadVertices.pop_back();
+        return out;
+    }
+    size_t capacity = vertices.capacity();
+    vertices.push_back(Vertex2D());
+    if (vertices.capacity() != capacity)
+        MemoryStats::Track(MemoryStats::Category::RenderBuffers, (vertices.capacity() - capacity)*sizeof(Vertex2D));
+    return vertices.size()-1;
+}
+
+void NoRenderer::Remove2DVertex(uint32_t vertex) {
+    deadVertices.push_back(vertex);
+}
+
+void NoRenderer::Set2DVertex(uint32_t vertex, Vertex2D v) {
+    if (vertex < vertices.size())
+        vertices[vertex] = v;
+}
+
+Renderer::Vertex2D NoRenderer::Get2DVertex(uint32_t vertex) {
+    if (vertex < vertices.size())
+        return vertices[vertex];
+    return Vertex2D();
+}
+
+void NoRenderer::Set2DObjectParameters(uint32_t, Render2DObjectParameters){}
+void NoRenderer::Render2DVertices(const Render2DStaticParameters &){}
+void NoRenderer::Clear2DQueue(){}
+void NoRenderer::Render2DSprites(uint32_t, const Sprite2D *, uint32_t, const Render2DStaticParameters &){}
@@ -90,7 +90,8 @@ class Command_SGR_help : public Interpreter::Command {
             << "    avg :" << ref->diagnostic_dynamic_vtex_per_render_avg << " vtex per render\n"
             << "    low : " << ref->diagnostic_dynamic_vtex_per_render_min << " vtex per render\n"
             << "    high: " << ref->diagnostic_dynamic_vtex_per_render_max << " vtex per render\n" 
-            << "    " << ref->diagnostic_dynamic_vtex_render_last << " draws/s (ideal: ~framerate)\n\n"
+            << "    " << ref->diagnostic_dynamic_vtex_render_last << " draws/s (ideal: ~framerate)\n"
+            << "    " << ref->diagnostic_dynamic_upload_bytes_last << " bytes uploaded last frame in " << ref->diagnostic_dynamic_upload_calls_last << " calls\n\n"
             
             << "Static Renderer:\n"
             << "    avg :" << ref->diagnostic_static_object_avg_indices << " vtex per render\n" 
@@ -217,6 +218,8 @@ ShaderGLRenderer::ShaderGLRenderer() {
     diagnostic_dynamic_vtex_render_last = 0;
     diagnostic_dynamic_vtex_render_frame_time = time(NULL);
     diagnostic_dynamic_vtex_render_per_frame = 0;
+    diagnostic_dynamic_upload_bytes_last = 0;
+    diagnostic_dynamic_upload_calls_last = 0;
     
     diagnostic_static_object_avg_indices = 0;
     diagnostic_static_object_avg_indices_ct = 0;
@@ -369,6 +372,16 @@ void ShaderGLRenderer::Render2DVertices(const Render2DStaticParameters & params)
 
 
 
+void ShaderGLRenderer::Render2DSprites(uint32_t object, const Sprite2D * sprites, uint32_t count, const Render2DStaticParameters & params) {
+    framebufferCheck();
+    if (renderer2D->Render2DSprites(object, sprites, count, params)) {
+        (*(GLRenderTarget**)framebuffer->GetHandle())->Invalidate();
+    }
+}
+
+
+
+
 void ShaderGLRenderer::RemoveTexture(int tex) {
     texture->DeleteTexture(tex);
 }
@@ -381,6 +394,10 @@ void ShaderGLRenderer::GetTexture(int tex, uint8_t * data) {
 
 void ShaderGLRenderer::ClearRenderedData() {
     framebufferCheck();
+
+    // a clear starts the next frame, so what was sent since the last one 
+    // was for the frame before.
+    renderer2D->TakeUploadCounts(diagnostic_dynamic_upload_bytes_last, diagnostic_dynamic_upload_calls_last);
     std::vector<RenderBuffer*> bufs = buffers.List();
     for(RenderBuffer * b : bufs) {
         b->ReclaimIDs();
@@ -715,8 +732,10 @@ std::string ShaderGLRenderer::Version() {return "v1.0 (OpenGL 2.0/3.1)";}
 
 
 
-bool ShaderGLRenderer::IsSupported(Capability) {
-    return true;
+bool ShaderGLRenderer::IsSupported(Capability c) {
+    // the GL context is current on the thread that made it, and 
+    // the display makes it current there again as it needs to.
+    return c != Capability::AnyThread;
 }
 
 
@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Backends/Renderer/ShaderGL/GLVersionQuery.h>
 #include <cassert>
 
+static bool gl_version3_3 = false;
 static bool gl_version3_0 = false;
 static bool gl_version3_1 = false;
 static bool gl_version2_1 = false;
@@ -46,6 +47,7 @@ static bool isInited = false;
 using namespace Dynacoe;
 bool Dynacoe::GLVersionInit() {
     if (glewInit() != GLEW_OK) return false;
+    gl_version3_3 = glewIsSupported("GL_VERSION_3_3");
     gl_version3_0 = glewIsSupported("GL_VERSION_3_0");
     gl_version3_1 = glewIsSupported("GL_VERSION_3_1");
     gl_version2_1 = glewIsSupported("GL_VERSION_2_1");
@@ -59,6 +61,7 @@ bool Dynacoe::GLVersionInit() {
 bool Dynacoe::GLVersionQuery(int mask) {
     bool out = true;
     assert(isInited);
+    if (mask & GL_Version3_3)          out &= gl_version3_3;
     if (mask & GL_Version3_0)          out &= gl_version3_0;
     if (mask & GL_Version3_1)          out &= gl_version3_1;
     if (mask & GL_Version2_1)          out &= gl_version2_1;
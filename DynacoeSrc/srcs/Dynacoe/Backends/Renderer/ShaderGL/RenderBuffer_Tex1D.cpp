@@ -53,6 +53,9 @@ RenderBuffer_Tex1D::RenderBuffer_Tex1D() {
     stateChanged = false;
     size = 0;
     length = 64;
+    uploadedSize = -1;
+    dirtyFirst = 0;
+    dirtyLast = 0;
     
 }
 
@@ -79,11 +82,23 @@ void RenderBuffer_Tex1D::Define(const float * dataSrc, int numElts) {
     
     stateChanged = true;
     size = numElts;
+    uploadedSize = -1;
 }
 
 void RenderBuffer_Tex1D::UpdateData(const float * dataSrc, int offset, int numElts) {
     if (!dataSrc || !data) return;
-    memcpy(data+offset, dataSrc, sizeof(float)*std::min(size, numElts));
+    numElts = std::min(size - offset, numElts);
+    if (offset < 0 || numElts <= 0) return;
+    memcpy(data+offset, dataSrc, sizeof(float)*numElts);
+
+    // only the changed span is sent if the texture keeps its size.
+    if (!stateChanged) {
+        dirtyFirst = offset;
+        dirtyLast  = offset+numElts;
+    } else {
+        dirtyFirst = std::min(dirtyFirst, offset);
+        dirtyLast  = std::max(dirtyLast,  offset+numElts);
+    }
     stateChanged = true;
 }
 
@@ -120,8 +135,15 @@ GLuint RenderBuffer_Tex1D::GenerateBufferID() {
 
         while (length <= size) { length += 128; texResizeNeeded = true; }
 
-        // normalize input data
-        glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, size/4, 0, GL_RGBA, GL_FLOAT, data);    
+        if (uploadedSize == size) {
+            int first = dirtyFirst/4;
+            int last  = (dirtyLast+3)/4;
+            glTexSubImage1D(GL_TEXTURE_1D, 0, first, last-first, GL_RGBA, GL_FLOAT, data+first*4);
+        } else {
+            // normalize input data
+            glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA32F, size/4, 0, GL_RGBA, GL_FLOAT, data);    
+            uploadedSize = size;
+        }
         glBindTexture(GL_TEXTURE_1D, oldTex);
         stateChanged = false;
     }
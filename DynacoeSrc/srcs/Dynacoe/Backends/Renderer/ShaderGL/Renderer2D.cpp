@@ -39,6 +39,8 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Backends/Renderer/ShaderGL/RenderBuffer_Tex1D.h>
 #include <Dynacoe/Backends/Renderer/ShaderGL/RenderBuffer_GL2_1.h>
 #include <Dynacoe/Backends/Renderer/ShaderGL/RenderBuffer.h>
+#include <Dynacoe/Util/MemoryStats.h>
+#include "Renderer2D_DirtyRanges.hpp"
 
 using namespace Dynacoe;
 
@@ -122,6 +124,54 @@ static const char * fragShader_2D =
 
 
 
+
+
+
+// Sprites: one record per quad. Each of the 6 corners of the quad reads 
+// the same record and places itself with the corner attribute.
+const int SPRITE_SLOT__CORNER     = 0;
+const int SPRITE_SLOT__TRANSFORM  = 1;
+const int SPRITE_SLOT__TRANSLATE  = 2;
+const int SPRITE_SLOT__UVS        = 3;
+const int SPRITE_SLOT__TINT       = 4;
+const int SPRITE_SLOT__TEXTURE    = 5;
+
+const int sprite_record_floats = sizeof(Renderer::Sprite2D)/sizeof(float);
+
+static const float spriteCorners[] = {
+    0.f, 0.f,   0.f, 1.f,   1.f, 1.f,
+    0.f, 0.f,   1.f, 1.f,   1.f, 0.f
+};
+
+
+static const char * vertShader_sprite =
+
+"in  vec2  corner;\n"
+"in  vec4  spriteTransform;\n"
+"in  vec2  spriteTranslate;\n"
+"in  vec4  spriteUVs;\n"
+"in  vec4  spriteTint;\n"
+"in  float spriteTexture;\n"
+"uniform float contextWidth;\n"
+"uniform float contextHeight;\n"
+"uniform mat4 transform;\n" // the context's transform with the object's
+
+"out float fragUseTex;\n"
+"out vec4  fragColor;\n"
+"out vec2  fragTexCoord;\n\n"
+
+"void main(void) {\n"
+"   vec2 local = spriteTransform.xy * corner.x + spriteTransform.zw * corner.y + spriteTranslate;\n"
+"   vec4 position = transform * vec4(local.x, local.y, 0, 1.f);\n"
+"   gl_Position = vec4((position.x / contextWidth) * 2.0 - 1.0, -1*((position.y / contextHeight) * 2.0 - 1.0), 0, 1);\n"
+
+"   fragColor    = spriteTint;\n"
+"   fragUseTex   = spriteTexture;\n"
+"   fragTexCoord = mix(spriteUVs.xy, spriteUVs.zw, corner);\n"
+"}\n";
+
+
+
 struct UserVertexData {
     float texX;
     float texY;
@@ -141,6 +191,22 @@ class Renderer2DData {
     std::vector<UserVertexData> userVertexData;
     std::vector<UserObjectData> userObjectData;
 
+    // CPU copies of what the buffers should hold. Changes go here
+    // and are sent at the next draw.
+    std::vector<Renderer::Vertex2D> vertices;
+    std::vector<Renderer::Render2DObjectParameters> objects;
+    Renderer2DDirtyRanges dirtyVertices;
+    Renderer2DDirtyRanges dirtyObjects;
+
+    uint32_t uploadBytes;
+    uint32_t uploadCalls;
+
+    ShaderProgram * spriteProgram;
+    GLuint spriteCornerBuffer;
+    GLuint spriteBuffer;
+    bool spriteInstancing;
+    std::vector<float> spriteStaging;
+
     std::stack<uint32_t> deadObjects;
     std::stack<uint32_t> deadVertices;
     std::vector<uint32_t> queued;
@@ -154,6 +220,8 @@ class Renderer2DData {
     
     
     void RebaseTextures();
+    void Upload();
+    void BindSpriteAttributes(bool instanced);
 };
 
 
@@ -168,6 +236,8 @@ Renderer2D::Renderer2D(TextureManager * textureSrc) {
     data->vertexID = 0;
     data->lastW = 0;
     data->lastH = 0;
+    data->uploadBytes = 0;
+    data->uploadCalls = 0;
 
     
     data->program = new ShaderProgram(
@@ -198,6 +268,44 @@ Renderer2D::Renderer2D(TextureManager * textureSrc) {
         exit(0);
     }
 
+
+
+    data->spriteProgram = new ShaderProgram(
+        vertShader_sprite,
+        fragShader_2D,
+
+        vertShader_sprite,
+        fragShader_2D,
+
+        {
+            {SPRITE_SLOT__CORNER,    "corner"},
+            {SPRITE_SLOT__TRANSFORM, "spriteTransform"},
+            {SPRITE_SLOT__TRANSLATE, "spriteTranslate"},
+            {SPRITE_SLOT__UVS,       "spriteUVs"},
+            {SPRITE_SLOT__TINT,      "spriteTint"},
+            {SPRITE_SLOT__TEXTURE,   "spriteTexture"}
+        }
+    );
+
+    if (!data->spriteProgram->GetSuccess()) {
+        std::cout << "Uh oh! 2D sprite rendering failed!:" << std::endl 
+                  << "_______Vertex_______\n\n"
+                  << data->spriteProgram->GetVertexLog() << "\n"
+                  << "_______Fragment_____\n\n"
+                  << data->spriteProgram->GetFragmentLog() << "\n" 
+                  << "_______Linking______\n\n"
+                  << data->spriteProgram->GetLinkLog() << std::endl;
+                  
+        exit(0);
+    }
+
+    // Without instanced arrays, each record is repeated for the 6 corners instead.
+    data->spriteInstancing = GLVersionQuery(GL_Version3_3);
+    glGenBuffers(1, &data->spriteCornerBuffer);
+    glGenBuffers(1, &data->spriteBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, data->spriteCornerBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(spriteCorners), spriteCorners, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 
@@ -213,16 +321,17 @@ uint32_t Renderer2D::Add2DVertex() {
     }
 
     // already have enough allocated, so return a new ID safely.
-    if (data->vertexID < data->vertexData->Size()/sizeof(Renderer::Vertex2D)) {
+    if (data->vertexID < data->vertices.size()) {
         return data->vertexID++;
     }
     
-    // we have to resize the buffer. We do so in blocks
-    uint32_t newSize = data->vertexData->Size()+resize_block_addition_elements*sizeof(float);
-    float * dataCopy = new float[newSize/sizeof(float)];
-    data->vertexData->GetData(dataCopy, 0, data->vertexData->Size()/sizeof(float));
-    data->vertexData->Define(dataCopy, newSize/sizeof(float));
-    delete[] dataCopy;
+    // we have to resize the buffer. We do so in blocks. The whole 
+    // store is sent again, so nothing pending needs to be.
+    uint32_t newSize = data->vertices.size()*sizeof(Renderer::Vertex2D)+resize_block_addition_elements*sizeof(float);
+    data->vertices.resize(newSize/sizeof(Renderer::Vertex2D));
+    data->vertexData->Define((float*)&data->vertices[0], data->vertices.size()*10);
+    data->dirtyVertices.Clear();
+    MemoryStats::Track(MemoryStats::Category::RenderBuffers, 2*resize_block_addition_elements*sizeof(float));
     return data->vertexID++;
 }
 
@@ -244,16 +353,16 @@ uint32_t Renderer2D::Add2DObject() {
     }
 
     // already have enough allocated, so return a new ID safely.
-    if (data->objectID < data->objectData->Size()/sizeof(Renderer::Render2DObjectParameters)) {
+    if (data->objectID < data->objects.size()) {
         return data->objectID++;
     }
     
     // we have to resize the buffer. We do so in blocks
-    uint32_t newSize = data->objectData->Size()+resize_block_addition_elements*sizeof(float);
-    float * dataCopy = new float[newSize/sizeof(float)];
-    data->objectData->GetData(dataCopy, 0, data->objectData->Size()/sizeof(float));
-    data->objectData->Define(dataCopy, newSize/sizeof(float));
-    delete[] dataCopy;
+    uint32_t newSize = data->objects.size()*sizeof(Renderer::Render2DObjectParameters)+resize_block_addition_elements*sizeof(float);
+    data->objects.resize(newSize/sizeof(Renderer::Render2DObjectParameters));
+    data->objectData->Define((float*)&data->objects[0], data->objects.size()*16);
+    data->dirtyObjects.Clear();
+    MemoryStats::Track(MemoryStats::Category::RenderBuffers, 2*resize_block_addition_elements*sizeof(float));
     return data->objectID++;
 }
 
@@ -264,8 +373,9 @@ void Renderer2D::Remove2DObject(uint32_t datum) {
 
 
 void Renderer2D::Set2DObjectParameters(uint32_t object, Renderer::Render2DObjectParameters params) {
-
-    data->objectData->UpdateData((float*)&params, object*16, 16);
+    if (object >= data->objects.size()) return;
+    data->objects[object] = params;
+    data->dirtyObjects.Mark(object);
 }
 
 
@@ -274,8 +384,10 @@ void Renderer2D::Set2DObjectParameters(uint32_t object, Renderer::Render2DObject
 
 
 void Renderer2D::Set2DVertex(uint32_t object, Renderer::Vertex2D params) {
-    while(data->userVertexData.size() <= object) {
-        data->userVertexData.push_back({});
+    if (data->userVertexData.size() <= object) {
+        size_t capacity = data->userVertexData.capacity();
+        data->userVertexData.resize(object+1);
+        MemoryStats::Track(MemoryStats::Category::RenderBuffers, (data->userVertexData.capacity() - capacity)*sizeof(UserVertexData));
     }
     
     // user's tex coords are in local texture space and need to be converted to atlas space.
@@ -289,15 +401,19 @@ void Renderer2D::Set2DVertex(uint32_t object, Renderer::Vertex2D params) {
         params.texX = data->textureSrc->MapTexCoordsToRealCoordsX(params.texX, (int)params.useTex); 
         params.texY = data->textureSrc->MapTexCoordsToRealCoordsY(params.texY, (int)params.useTex); 
     }
-    data->vertexData->UpdateData((float*)&params, object*10, 10);
+    if (object >= data->vertices.size()) return;
+    data->vertices[object] = params;
+    data->dirtyVertices.Mark(object);
 }
 
 Renderer::Vertex2D Renderer2D::Get2DVertex(uint32_t vertex) {
-    Renderer::Vertex2D vt;
-    data->vertexData->GetData((float*)&vt, vertex*10, 10);
+    if (vertex >= data->vertices.size()) return Renderer::Vertex2D();
+    Renderer::Vertex2D vt = data->vertices[vertex];
     // get user-provided parameters
-    vt.texX  = data->userVertexData[vertex].texX;
-    vt.texY  = data->userVertexData[vertex].texY;
+    if (vertex < data->userVertexData.size()) {
+        vt.texX  = data->userVertexData[vertex].texX;
+        vt.texY  = data->userVertexData[vertex].texY;
+    }
     return vt;
 }
 
@@ -308,19 +424,28 @@ void Renderer2D::Queue2DVertices(const uint32_t * indices, uint32_t count) {
 }
 
 void Renderer2DData::RebaseTextures() {
-    if (!userVertexData.size()) return;
-    Renderer::Vertex2D * copy = new Renderer::Vertex2D[userVertexData.size()];
-    vertexData->GetData((float*)copy, 0, userVertexData.size()*10);
-
-    for(uint32_t i = 0; i < userVertexData.size(); ++i) {
-        if (copy[i].useTex < 0.f) continue;
+    uint32_t count = std::min(userVertexData.size(), vertices.size());
+    for(uint32_t i = 0; i < count; ++i) {
+        if (vertices[i].useTex < 0.f) continue;
         UserVertexData tex = userVertexData[i];
-        copy[i].texX = textureSrc->MapTexCoordsToRealCoordsX(tex.texX, copy[i].useTex);
-        copy[i].texY = textureSrc->MapTexCoordsToRealCoordsY(tex.texY, copy[i].useTex);
+        vertices[i].texX = textureSrc->MapTexCoordsToRealCoordsX(tex.texX, vertices[i].useTex);
+        vertices[i].texY = textureSrc->MapTexCoordsToRealCoordsY(tex.texY, vertices[i].useTex);
+        dirtyVertices.Mark(i);
     }
-    
-    vertexData->UpdateData((float*)copy, 0, userVertexData.size()*10);
-    delete[] copy; 
+}
+
+// Sends everything changed since the last draw, one call per run of changes.
+void Renderer2DData::Upload() {
+    dirtyVertices.Flush([this](uint32_t first, uint32_t count) {
+        vertexData->UpdateData((float*)&vertices[first], first*10, count*10);
+        uploadBytes += count*sizeof(Renderer::Vertex2D);
+        uploadCalls++;
+    });
+    dirtyObjects.Flush([this](uint32_t first, uint32_t count) {
+        objectData->UpdateData((float*)&objects[first], first*16, count*16);
+        uploadBytes += count*sizeof(Renderer::Render2DObjectParameters);
+        uploadCalls++;
+    });
 }
 
 uint32_t Renderer2D::Render2DVertices(GLenum drawMode, const Renderer::Render2DStaticParameters & params) {
@@ -331,6 +456,7 @@ uint32_t Renderer2D::Render2DVertices(GLenum drawMode, const Renderer::Render2DS
         data->lastW = data->textureSrc->GetTextureW();
         data->lastH = data->textureSrc->GetTextureH();
     }
+    data->Upload();
     
     glUseProgram(data->program->GetHandle());
     data->program->UpdateUniform("fragTex",   TextureManager::GetActiveTextureSlot()- GL_TEXTURE0);
@@ -395,6 +521,131 @@ void Renderer2D::Clear2DQueue() {
 
 
 
+void Renderer2DData::BindSpriteAttributes(bool instanced) {
+    // instanced: records advance once per quad, corners come from their own buffer.
+    // otherwise: each vertex is a corner followed by a copy of its record.
+    GLsizei stride = (instanced ? sprite_record_floats : sprite_record_floats+2)*sizeof(GLfloat);
+    size_t  record = instanced ? 0 : 2*sizeof(GLfloat);
+
+    if (instanced) {
+        glBindBuffer(GL_ARRAY_BUFFER, spriteCornerBuffer);
+        glVertexAttribPointer(SPRITE_SLOT__CORNER, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, spriteBuffer);
+        glVertexAttribPointer(SPRITE_SLOT__CORNER, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, spriteBuffer);
+    glVertexAttribPointer(SPRITE_SLOT__TRANSFORM, 4, GL_FLOAT, GL_FALSE, stride, (void*)(record));
+    glVertexAttribPointer(SPRITE_SLOT__TRANSLATE, 2, GL_FLOAT, GL_FALSE, stride, (void*)(record + sizeof(GLfloat) * 4));
+    glVertexAttribPointer(SPRITE_SLOT__UVS,       4, GL_FLOAT, GL_FALSE, stride, (void*)(record + sizeof(GLfloat) * 6));
+    glVertexAttribPointer(SPRITE_SLOT__TINT,      4, GL_FLOAT, GL_FALSE, stride, (void*)(record + sizeof(GLfloat) * 10));
+    glVertexAttribPointer(SPRITE_SLOT__TEXTURE,   1, GL_FLOAT, GL_FALSE, stride, (void*)(record + sizeof(GLfloat) * 14));
+
+    for(int i = SPRITE_SLOT__CORNER; i <= SPRITE_SLOT__TEXTURE; ++i) {
+        glEnableVertexAttribArray(i);
+        if (instanced)
+            glVertexAttribDivisor(i, i == SPRITE_SLOT__CORNER ? 0 : 1);
+    }
+}
+
+
+uint32_t Renderer2D::Render2DSprites(uint32_t object, const Renderer::Sprite2D * sprites, uint32_t count, const Renderer::Render2DStaticParameters & params) {
+    if (!count) return 0;
+    bool instanced = data->spriteInstancing;
+
+    // texture coordinates are moved into atlas space as the records are staged.
+    uint32_t perRecord = instanced ? sprite_record_floats : (sprite_record_floats+2)*6;
+    data->spriteStaging.resize(count*perRecord);
+    float * out = &data->spriteStaging[0];
+    for(uint32_t i = 0; i < count; ++i) {
+        Renderer::Sprite2D sprite = sprites[i];
+        if (sprite.texture >= 0.f) {
+            int tex = (int)sprite.texture;
+            sprite.uvs[0] = data->textureSrc->MapTexCoordsToRealCoordsX(sprite.uvs[0], tex);
+            sprite.uvs[1] = data->textureSrc->MapTexCoordsToRealCoordsY(sprite.uvs[1], tex);
+            sprite.uvs[2] = data->textureSrc->MapTexCoordsToRealCoordsX(sprite.uvs[2], tex);
+            sprite.uvs[3] = data->textureSrc->MapTexCoordsToRealCoordsY(sprite.uvs[3], tex);
+        }
+
+        if (instanced) {
+            memcpy(out, &sprite, sizeof(Renderer::Sprite2D));
+            out += sprite_record_floats;
+        } else {
+            for(uint32_t n = 0; n < 6; ++n) {
+                out[0] = spriteCorners[n*2];
+                out[1] = spriteCorners[n*2+1];
+                memcpy(out+2, &sprite, sizeof(Renderer::Sprite2D));
+                out += sprite_record_floats+2;
+            }
+        }
+    }
+
+
+    // the context and object transforms are combined into one row-major matrix.
+    // Object parameters are column-major.
+    TransformMatrix context;
+    if (params.contextTransform)
+        memcpy(context.GetData(), params.contextTransform, sizeof(float)*16);
+    else
+        context.SetToIdentity();
+    float transform[16];
+    const float * objectM = object < data->objects.size() ? data->objects[object].data : nullptr;
+    for(int r = 0; r < 4; ++r) {
+        for(int c = 0; c < 4; ++c) {
+            float v = 0.f;
+            for(int k = 0; k < 4; ++k) {
+                float o = objectM ? objectM[c*4+k] : (k == c ? 1.f : 0.f);
+                v += context.GetData()[r*4+k] * o;
+            }
+            transform[r*4+c] = v;
+        }
+    }
+
+
+    glUseProgram(data->spriteProgram->GetHandle());
+    data->spriteProgram->UpdateUniform("fragTex", TextureManager::GetActiveTextureSlot()- GL_TEXTURE0);
+    data->spriteProgram->UpdateUniform("transform", transform);
+    data->spriteProgram->UpdateUniform("contextWidth",  params.contextWidth);
+    data->spriteProgram->UpdateUniform("contextHeight", params.contextHeight);
+
+    // a fresh store each time, so the driver need not wait on the last draw.
+    glBindBuffer(GL_ARRAY_BUFFER, data->spriteBuffer);
+    glBufferData(GL_ARRAY_BUFFER, data->spriteStaging.size()*sizeof(float), &data->spriteStaging[0], GL_STREAM_DRAW);
+    data->uploadBytes += data->spriteStaging.size()*sizeof(float);
+    data->uploadCalls++;
+
+    glActiveTexture(TextureManager::GetActiveTextureSlot());
+    glBindTexture(GL_TEXTURE_2D, data->textureSrc->GetTexture());
+
+    data->BindSpriteAttributes(instanced);
+    if (instanced) {
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, count*6);
+    }
+
+    // attribute state is shared with the other programs.
+    for(int i = SPRITE_SLOT__CORNER; i <= SPRITE_SLOT__TEXTURE; ++i) {
+        if (instanced)
+            glVertexAttribDivisor(i, 0);
+        glDisableVertexAttribArray(i);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return count;
+}
+
+void Renderer2D::TakeUploadCounts(uint32_t & bytes, uint32_t & calls) {
+    bytes = data->uploadBytes;
+    calls = data->uploadCalls;
+    data->uploadBytes = 0;
+    data->uploadCalls = 0;
+}
+
+
+
+
 
 
 
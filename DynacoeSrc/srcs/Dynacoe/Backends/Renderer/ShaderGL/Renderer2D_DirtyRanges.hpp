@@ -0,0 +1,66 @@
+/*
+
+Remembers which elements of a CPU-side buffer changed since it was
+last uploaded, so the upload can be done once per draw as a few
+contiguous runs instead of once per change.
+
+Marking is O(1) and marking the same element again is free. Flush()
+sorts the marked elements and hands out [first, first+count) runs.
+Runs separated by only a few clean elements are joined, since sending
+a handful of unchanged elements costs less than another call.
+
+
+*/
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+class Renderer2DDirtyRanges {
+  public:
+    static const uint32_t join_gap_c = 4;
+
+    void Mark(uint32_t i) {
+        if (i >= flags.size()) flags.resize(i+1, false);
+        if (flags[i]) return;
+        flags[i] = true;
+        marked.push_back(i);
+    }
+
+    // Forgets everything marked, i.e. after the whole buffer was sent.
+    void Clear() {
+        for(uint32_t i = 0; i < marked.size(); ++i) {
+            flags[marked[i]] = false;
+        }
+        marked.clear();
+    }
+
+    bool Empty() const {
+        return marked.empty();
+    }
+
+
+    // Calls upload(first, count) for each run, then clears.
+    template<typename T>
+    void Flush(T upload) {
+        if (marked.empty()) return;
+        std::sort(marked.begin(), marked.end());
+
+        uint32_t first = marked[0];
+        uint32_t last  = marked[0];
+        for(uint32_t i = 1; i < marked.size(); ++i) {
+            if (marked[i] - last > join_gap_c) {
+                upload(first, last - first + 1);
+                first = marked[i];
+            }
+            last = marked[i];
+        }
+        upload(first, last - first + 1);
+        Clear();
+    }
+
+
+  private:
+    std::vector<bool> flags;
+    std::vector<uint32_t> marked;
+};
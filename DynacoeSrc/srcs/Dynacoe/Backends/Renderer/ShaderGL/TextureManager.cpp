@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Backends/Renderer/ShaderGL/TextureManager.h>
 #include <Dynacoe/Backends/Renderer/StaticState.h>
 #include <Dynacoe/Backends/Renderer/ShaderGL/RenderBuffer.h>
+#include <Dynacoe/Util/MemoryStats.h>
 #include <cstring>
 
 using namespace Dynacoe;
@@ -222,10 +223,12 @@ class HugeTexture  {
         glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxLength);
 
         glActiveTexture(USER_TEX_ACTIVE);
+        MemoryStats::Track(MemoryStats::Category::Textures, (int64_t)w*h*4, 1);
     }
 
     ~HugeTexture() {
         glDeleteTextures(1, &glID);
+        MemoryStats::Track(MemoryStats::Category::Textures, -(int64_t)w*h*4, -1);
     }
 
 
@@ -261,6 +264,7 @@ class HugeTexture  {
         // create new tex and emplace as a sub image
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, newW, newH, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
         glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, copy);
+        MemoryStats::Track(MemoryStats::Category::Textures, ((int64_t)newW*newH - (int64_t)w*h)*4);
 
 
 
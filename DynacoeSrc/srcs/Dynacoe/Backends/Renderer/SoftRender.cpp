@@ -0,0 +1,704 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+#include <Dynacoe/Backends/Renderer/SoftRender_Multi.h>
+#include <Dynacoe/Backends/Renderer/StaticState.h>
+#include <Dynacoe/Backends/Framebuffer/PixelFB_Multi.h>
+#include <Dynacoe/Util/MemoryStats.h>
+#include <Dynacoe/Util/Chain.h>
+#include <cstring>
+
+
+using namespace Dynacoe;
+
+
+// same clear color as the GL backend (.1, 0, .07)
+static const uint8_t clear_color_c[4] = {26, 0, 18, 255};
+
+static const int static_vertex_floats_c = 12;
+
+static const float identity_c[16] = {
+    1.f, 0.f, 0.f, 0.f,
+    0.f, 1.f, 0.f, 0.f,
+    0.f, 0.f, 1.f, 0.f,
+    0.f, 0.f, 0.f, 1.f
+};
+
+
+/// command interpretation
+
+class Command_SR_help : public Interpreter::Command {
+  public:
+    SoftRenderer * ref;
+    Command_SR_help(SoftRenderer * input) {
+        ref = input;
+    }
+    std::string operator()(const std::vector<std::string> &) {
+        return Chain()
+            << "Renderer info:\n\n"
+            << "Name: " << ref->Name() << "\n"
+            << "Version: " << ref->Version() << "\n"
+            << "Threads: " << ref->GetRasterizer()->GetThreadCount() << "\n"
+            << "Tile size: " << SoftRasterizer::TileSize << "x" << SoftRasterizer::TileSize << "\n"
+            << "Textures: " << ref->GetTextureStore()->GetCount() << "\n"
+            << "Light count: " << ref->NumLights() << "\n\n"
+
+            << "Dynamic Renderer:\n"
+            << "    avg :" << ref->diagnostic_dynamic_vtex_per_render_avg << " vtex per render\n\n"
+
+            << "Static Renderer:\n"
+            << "    " << ref->diagnostic_static_object_count << " objects drawn\n\n"
+
+            << "Primitives drawn: " << ref->GetRasterizer()->GetPrimitiveCount() << "\n";
+    }
+
+    std::string Help() const {return "";}
+};
+
+
+
+
+// column-major, as uploaded for the GL backend
+static inline void transformColumn(const float * m, const float * v, float * out) {
+    for(int r = 0; r < 4; ++r)
+        out[r] = m[r]*v[0] + m[4+r]*v[1] + m[8+r]*v[2] + m[12+r]*v[3];
+}
+
+// row-major
+static inline void transformRow(const float * m, const float * v, float * out) {
+    for(int r = 0; r < 4; ++r)
+        out[r] = m[r*4]*v[0] + m[r*4+1]*v[1] + m[r*4+2]*v[2] + m[r*4+3]*v[3];
+}
+
+// Same as the GL backend's 2D program: the object's transform, then
+// the context's, then out to normalized coordinates with y pointing down.
+static inline void transform2D(const float * object, const float * context, float x, float y, 
+                               const Renderer::Render2DStaticParameters & params, float * out) {
+    float local[4] = {x, y, 0.f, 1.f};
+    float world[4], transformed[4];
+    transformColumn(object, local, world);
+    transformRow(context, world, transformed);
+
+    out[0] =    (transformed[0] / params.contextWidth)  * 2.f - 1.f;
+    out[1] = -(((transformed[1] / params.contextHeight) * 2.f - 1.f));
+    out[2] = 0.f;
+    out[3] = 1.f;
+}
+
+
+
+
+
+SoftRenderer::SoftRenderer() {
+    GetInterpreter()->AddCommand("info", new Command_SR_help(this));
+
+    raster = new SoftRasterizer;
+    textures = new SoftTextureStore;
+
+    float view[32];
+    memcpy(view,    identity_c, sizeof(float)*16);
+    memcpy(view+16, identity_c, sizeof(float)*16);
+    viewID       = AddBuffer(view, 32);
+    projectionID = AddBuffer((float*)identity_c, 16);
+
+    basicProgramID = programs.Insert(BuiltInShaderMode::BasicShader);
+    lightProgramID = programs.Insert(BuiltInShaderMode::LightMaterial);
+    lightsDirty = true;
+
+    polygon   = Polygon::Triangle;
+    dimension = Dimension::D_2D;
+    alpha     = AlphaRule::Opaque;
+    filter    = TexFilter::Linear;
+    target    = nullptr;
+
+    diagnostic_dynamic_vtex_per_render_avg = 0;
+    diagnostic_dynamic_vtex_per_render_acc = 0;
+    diagnostic_dynamic_vtex_per_render_ct = 0;
+    diagnostic_static_object_count = 0;
+}
+
+SoftRenderer::~SoftRenderer() {
+    std::vector<std::vector<float>*> list = buffers.List();
+    for(uint32_t i = 0; i < list.size(); ++i) {
+        MemoryStats::Track(MemoryStats::Category::RenderBuffers, -(int64_t)(list[i]->size()*sizeof(float)), -1);
+        delete list[i];
+    }
+    std::vector<Light*> lightList = lights.List();
+    for(uint32_t i = 0; i < lightList.size(); ++i) {
+        delete lightList[i];
+    }
+    delete raster;
+    delete textures;
+}
+
+std::string SoftRenderer::Name() {return "Software Renderer";}
+std::string SoftRenderer::Version() {return "v1.0";}
+bool SoftRenderer::Valid() {return true;}
+
+
+
+
+
+
+/* 2D */
+
+uint32_t SoftRenderer::Add2DObject() {
+    if (deadObjects.size()) {
+        uint32_t out = deadObjects.back();
+        deadObjects.pop_back();
+        return out;
+    }
+    size_t capacity = objects.capacity();
+    Render2DObjectParameters params;
+    memcpy(params.data, identity_c, sizeof(float)*16);
+    objects.push_back(params);
+    if (objects.capacity() != capacity)
+        MemoryStats::Track(MemoryStats::Category::RenderBuffers, (objects.capacity() - capacity)*sizeof(Render2DObjectParameters));
+    return objects.size()-1;
+}
+
+void SoftRenderer::Remove2DObject(uint32_t object) {
+    deadObjects.push_back(object);
+}
+
+uint32_t SoftRenderer::Add2DVertex() {
+    if (deadVertices.size()) {
+        uint32_t out = deadVertices.back();
+        deadVertices.pop_back();
+        return out;
+    }
+    size_t capacity = vertices.capacity();
+    vertices.push_back(Vertex2D());
+    if (vertices.capacity() != capacity)
+        MemoryStats::Track(MemoryStats::Category::RenderBuffers, (vertices.capacity() - capacity)*sizeof(Vertex2D));
+    return vertices.size()-1;
+}
+
+void SoftRenderer::Remove2DVertex(uint32_t vertex) {
+    deadVertices.push_back(vertex);
+}
+
+void SoftRenderer::Set2DVertex(uint32_t vertex, Vertex2D v) {
+    if (vertex < vertices.size())
+        vertices[vertex] = v;
+}
+
+Renderer::Vertex2D SoftRenderer::Get2DVertex(uint32_t vertex) {
+    if (vertex < vertices.size())
+        return vertices[vertex];
+    return Vertex2D();
+}
+
+void SoftRenderer::Set2DObjectParameters(uint32_t object, Render2DObjectParameters params) {
+    if (object < objects.size())
+        objects[object] = params;
+}
+
+void SoftRenderer::Queue2DVertices(const uint32_t * indices, uint32_t count) {
+    queued.insert(queued.end(), indices, indices+count);
+}
+
+void SoftRenderer::Clear2DQueue() {
+    queued.clear();
+}
+
+
+void SoftRenderer::Render2DVertices(const Render2DStaticParameters & params) {
+    if (!queued.size()) return;
+    targetCheck();
+    if (!target) {
+        queued.clear();
+        return;
+    }
+
+    float contextTransform[16];
+    if (params.contextTransform) {
+        memcpy(contextTransform, params.contextTransform, sizeof(float)*16);
+    } else {
+        memcpy(contextTransform, identity_c, sizeof(float)*16);
+    }
+
+    uint32_t count = queued.size();
+    transformed.resize(count);
+    order.resize(count);
+    for(uint32_t i = 0; i < count; ++i) {
+        const Vertex2D & src = queued[i] < vertices.size() ? vertices[queued[i]] : Vertex2D(0, 0, 0, 0, 0, 0);
+        const float * m = (src.object >= 0.f && src.object < objects.size()) ? objects[(uint32_t)src.object].data : identity_c;
+
+        SoftRasterizer::Vertex & out = transformed[i];
+        transform2D(m, contextTransform, src.x, src.y, params, out.pos);
+        out.var[0] = src.r;
+        out.var[1] = src.g;
+        out.var[2] = src.b;
+        out.var[3] = src.a;
+        out.var[4] = src.texX;
+        out.var[5] = src.texY;
+        order[i] = i;
+    }
+
+    // each triangle takes its texture from its first vertex
+    bool lines = polygon == Polygon::Line;
+    primTextures.clear();
+    if (!lines) {
+        for(uint32_t i = 0; i+2 < count; i+=3) {
+            const Vertex2D & src = queued[i] < vertices.size() ? vertices[queued[i]] : Vertex2D(0, 0, 0, 0, 0, 0);
+            primTextures.push_back(src.useTex > -.5f ? textures->Get((int)src.useTex) : nullptr);
+        }
+    }
+
+    SoftRasterizer::State state = baseState();
+    state.shading = SoftRasterizer::Shading::Vertex2D;
+    raster->Draw(state, &transformed[0], &order[0], count, lines, lines ? nullptr : &primTextures[0]);
+
+
+    diagnostic_dynamic_vtex_per_render_acc += count;
+    diagnostic_dynamic_vtex_per_render_ct++;
+    if (diagnostic_dynamic_vtex_per_render_ct > 20) {
+        diagnostic_dynamic_vtex_per_render_avg = diagnostic_dynamic_vtex_per_render_acc / diagnostic_dynamic_vtex_per_render_ct;
+        diagnostic_dynamic_vtex_per_render_acc = diagnostic_dynamic_vtex_per_render_avg;
+        diagnostic_dynamic_vtex_per_render_ct = 1;
+    }
+    queued.clear();
+}
+
+
+
+
+
+
+// Each sprite becomes two triangles, the same as a Shape2D image.
+void SoftRenderer::Render2DSprites(uint32_t object, const Sprite2D * sprites, uint32_t count, const Render2DStaticParameters & params) {
+    if (!count) return;
+    targetCheck();
+    if (!target) return;
+
+    float contextTransform[16];
+    memcpy(contextTransform, params.contextTransform ? params.contextTransform : identity_c, sizeof(float)*16);
+    const float * m = object < objects.size() ? objects[object].data : identity_c;
+
+    static const float corners_c[12] = {
+        0.f, 0.f,   0.f, 1.f,   1.f, 1.f,
+        0.f, 0.f,   1.f, 1.f,   1.f, 0.f
+    };
+
+    transformed.resize(count*6);
+    order.resize(count*6);
+    primTextures.resize(count*2);
+    for(uint32_t i = 0; i < count; ++i) {
+        const Sprite2D & sprite = sprites[i];
+        const float * t = sprite.transform;
+        for(uint32_t n = 0; n < 6; ++n) {
+            float cx = corners_c[n*2];
+            float cy = corners_c[n*2+1];
+            SoftRasterizer::Vertex & out = transformed[i*6+n];
+            transform2D(m, contextTransform, t[0]*cx + t[2]*cy + t[4], t[1]*cx + t[3]*cy + t[5], params, out.pos);
+            memcpy(out.var, sprite.tint, sizeof(float)*4);
+            out.var[4] = sprite.uvs[0] + (sprite.uvs[2] - sprite.uvs[0])*cx;
+            out.var[5] = sprite.uvs[1] + (sprite.uvs[3] - sprite.uvs[1])*cy;
+            order[i*6+n] = i*6+n;
+        }
+        const SoftTexture * texture = sprite.texture > -.5f ? textures->Get((int)sprite.texture) : nullptr;
+        primTextures[i*2]   = texture;
+        primTextures[i*2+1] = texture;
+    }
+
+    SoftRasterizer::State state = baseState();
+    state.shading = SoftRasterizer::Shading::Vertex2D;
+    raster->Draw(state, &transformed[0], &order[0], count*6, false, &primTextures[0]);
+}
+
+
+
+
+
+
+/* Static */
+
+void SoftRenderer::RenderStatic(StaticState * obj) {
+    if (!(obj->indices && obj->indices->size())) return;
+    targetCheck();
+    if (!target) return;
+    if (!buffers.Query(obj->vertices)) return;
+
+    const std::vector<float> & vertexData = *buffers.Find(obj->vertices);
+    const float * view = &(*buffers.Find(viewID))[0];
+    const float * projection = &(*buffers.Find(projectionID))[0];
+
+    float model[32];
+    memcpy(model,    identity_c, sizeof(float)*16);
+    memcpy(model+16, identity_c, sizeof(float)*16);
+    if (buffers.Query(obj->modelData)) {
+        const std::vector<float> & src = *buffers.Find(obj->modelData);
+        memcpy(model, &src[0], sizeof(float)*std::min<size_t>(32, src.size()));
+    }
+
+    SoftRasterizer::State state = baseState();
+    memset(state.material, 0, sizeof(float)*16);
+    if (buffers.Query(obj->materialData)) {
+        const std::vector<float> & src = *buffers.Find(obj->materialData);
+        memcpy(state.material, &src[0], sizeof(float)*std::min<size_t>(16, src.size()));
+    }
+
+    bool lit = programs.Query(obj->program) && programs.Find(obj->program) == BuiltInShaderMode::LightMaterial;
+    state.shading = lit ? SoftRasterizer::Shading::LightMaterial : SoftRasterizer::Shading::Basic;
+
+
+    // indices must all land on a vertex
+    uint32_t vertexCount = vertexData.size() / static_vertex_floats_c;
+    const std::vector<uint32_t> & indices = *obj->indices;
+    for(uint32_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] >= vertexCount) return;
+    }
+
+
+    // Same as the GL backend's built-in programs
+    transformed.resize(vertexCount);
+    for(uint32_t i = 0; i < vertexCount; ++i) {
+        const float * src = &vertexData[i*static_vertex_floats_c];
+        float local[4] = {src[0], src[1], src[2], 1.f};
+        float world[4], viewed[4];
+        transformColumn(model, local, world);
+        transformColumn(view, world, viewed);
+
+        SoftRasterizer::Vertex & out = transformed[i];
+        transformColumn(projection, viewed, out.pos);
+        out.var[0] = src[6];
+        out.var[1] = src[7];
+        if (lit) {
+            float normal[4] = {src[3], src[4], src[5], 0.f};
+            float normalOut[4];
+            transformColumn(model+16, normal, normalOut);
+            out.var[2] = viewed[0] / viewed[3];
+            out.var[3] = viewed[1] / viewed[3];
+            out.var[4] = viewed[2] / viewed[3];
+            out.var[5] = normalOut[0];
+            out.var[6] = normalOut[1];
+            out.var[7] = normalOut[2];
+        }
+    }
+
+
+    if (obj->textures) {
+        for(uint32_t i = 0; i < obj->textures->size(); ++i) {
+            int slot = (*obj->textures)[i].first;
+            if (slot == 0 || slot == 1)
+                state.textures[slot] = textures->Get((*obj->textures)[i].second);
+        }
+    }
+
+    Framebuffer * samplebuffer = obj->samplebuffer;
+    if (samplebuffer && samplebuffer != target &&
+        samplebuffer->GetHandleType() == Framebuffer::Type::RGBA_PixelArray &&
+        samplebuffer->GetHandle()) {
+        state.sample = (const uint8_t*)samplebuffer->GetHandle();
+        state.sampleW = samplebuffer->Width();
+        state.sampleH = samplebuffer->Height();
+    }
+
+    if (lit) {
+        syncLights();
+        state.lights = &enabledLights;
+        memcpy(state.view, view, sizeof(float)*16);
+    }
+
+    raster->Draw(state, &transformed[0], &indices[0], indices.size(), false);
+    diagnostic_static_object_count++;
+}
+
+
+void SoftRenderer::ClearRenderedData() {
+    targetCheck();
+    if (!target) return;
+    raster->Clear(clear_color_c, 1.f);
+}
+
+RenderBufferID SoftRenderer::GetStaticViewingMatrixID() {
+    return viewID;
+}
+
+RenderBufferID SoftRenderer::GetStaticProjectionMatrixID() {
+    return projectionID;
+}
+
+
+SoftRasterizer::State SoftRenderer::baseState() {
+    SoftRasterizer::State state;
+    state.alpha = alpha;
+    state.depthTest = dimension == Dimension::D_3D;
+    state.linearFilter = filter == TexFilter::Linear;
+    state.textures[0] = nullptr;
+    state.textures[1] = nullptr;
+    state.sample = nullptr;
+    state.sampleW = 0;
+    state.sampleH = 0;
+    state.lights = nullptr;
+    return state;
+}
+
+
+// The target may have been resized since the last draw.
+void SoftRenderer::targetCheck() {
+    if (!target || !target->GetHandle()) {
+        raster->SetTarget(nullptr, nullptr, 0, 0);
+        return;
+    }
+    int w = target->Width();
+    int h = target->Height();
+    float * depth;
+    PixelFB * fb = dynamic_cast<PixelFB*>(target);
+    if (fb) {
+        depth = fb->GetDepthData();
+    } else {
+        if (depthFallback.size() != (size_t)w*h)
+            depthFallback.assign(w*h, 1.f);
+        depth = &depthFallback[0];
+    }
+    raster->SetTarget((uint8_t*)target->GetHandle(), depth, w, h);
+}
+
+
+
+
+
+
+/* Textures */
+
+int SoftRenderer::AddTexture(int w, int h, const uint8_t * data) {
+    return textures->NewTexture(w, h, data);
+}
+
+void SoftRenderer::UpdateTexture(int tex, const uint8_t * data) {
+    textures->UpdateTexture(tex, data);
+}
+
+void SoftRenderer::RemoveTexture(int tex) {
+    textures->DeleteTexture(tex);
+}
+
+void SoftRenderer::GetTexture(int tex, uint8_t * data) {
+    textures->GetTextureData(tex, data);
+}
+
+void SoftRenderer::SetTextureFilter(TexFilter f) {
+    filter = f;
+}
+
+Renderer::TexFilter SoftRenderer::GetTextureFilter() {
+    return filter;
+}
+
+int SoftRenderer::GetTextureWidth(int tex) {
+    const SoftTexture * t = textures->Get(tex);
+    return t ? t->w : 0;
+}
+
+int SoftRenderer::GetTextureHeight(int tex) {
+    const SoftTexture * t = textures->Get(tex);
+    return t ? t->h : 0;
+}
+
+int SoftRenderer::MaxSimultaneousTextures() {
+    return MINIMUM_TEXTURE_BINDING_COUNT;
+}
+
+
+
+
+
+
+/* Buffers */
+
+RenderBufferID SoftRenderer::AddBuffer(float * data, int numElements) {
+    if (numElements < 0) return RenderBufferID();
+    std::vector<float> * buffer = new std::vector<float>(numElements);
+    if (data && numElements)
+        memcpy(&(*buffer)[0], data, sizeof(float)*numElements);
+    MemoryStats::Track(MemoryStats::Category::RenderBuffers, numElements*sizeof(float), 1);
+    return buffers.Insert(buffer);
+}
+
+void SoftRenderer::UpdateBuffer(RenderBufferID id, float * newData, int offset, int numElements) {
+    if (!buffers.Query(id)) return;
+    std::vector<float> & buffer = *buffers.Find(id);
+    if (offset < 0 || numElements <= 0 || offset >= (int)buffer.size()) return;
+    numElements = std::min<int>(numElements, buffer.size() - offset);
+    memcpy(&buffer[offset], newData, sizeof(float)*numElements);
+}
+
+void SoftRenderer::ReadBuffer(RenderBufferID id, float * outputData, int offset, int numElements) {
+    if (!buffers.Query(id)) return;
+    std::vector<float> & buffer = *buffers.Find(id);
+    if (offset < 0 || numElements <= 0 || offset >= (int)buffer.size()) return;
+    numElements = std::min<int>(numElements, buffer.size() - offset);
+    memcpy(outputData, &buffer[offset], sizeof(float)*numElements);
+}
+
+int SoftRenderer::BufferSize(RenderBufferID id) {
+    if (!buffers.Query(id)) return 0;
+    return buffers.Find(id)->size();
+}
+
+void SoftRenderer::RemoveBuffer(RenderBufferID id) {
+    if (!buffers.Query(id)) return;
+    std::vector<float> * buffer = buffers.Find(id);
+    MemoryStats::Track(MemoryStats::Category::RenderBuffers, -(int64_t)(buffer->size()*sizeof(float)), -1);
+    delete buffer;
+    buffers.Remove(id);
+}
+
+
+
+
+
+
+/* Programs */
+
+std::string SoftRenderer::ProgramGetLanguage() {
+    return "";
+}
+
+ProgramID SoftRenderer::ProgramAdd(const std::string &, const std::string &, std::string & log) {
+    log = "[Dynacoe::SoftRender]: Shader programs are not supported by the software renderer.\n";
+    return ProgramID();
+}
+
+ProgramID SoftRenderer::ProgramGetBuiltIn(BuiltInShaderMode b) {
+    switch(b) {
+        case BuiltInShaderMode::BasicShader:   return basicProgramID;
+        case BuiltInShaderMode::LightMaterial: return lightProgramID;
+    }
+    return ProgramID();
+}
+
+
+
+
+
+
+/* Lighting */
+
+LightID SoftRenderer::AddLight(LightType type) {
+    Light * light = new Light;
+    memset(&light->data, 0, sizeof(SoftRasterizer::Light));
+    light->type = type;
+    light->enabled = true;
+    light->data.intensity = 1.f;
+    light->data.directional = type == LightType::Directional;
+    lightsDirty = true;
+    return lights.Insert(light);
+}
+
+void SoftRenderer::UpdateLightAttributes(LightID id, float * data) {
+    if (!lights.Query(id)) return;
+    Light * light = lights.Find(id);
+    memcpy(light->data.pos,   data,   sizeof(float)*3);
+    memcpy(light->data.color, data+3, sizeof(float)*3);
+    light->data.intensity = data[6];
+    lightsDirty = true;
+}
+
+void SoftRenderer::EnableLight(LightID id, bool doIt) {
+    if (!lights.Query(id)) return;
+    lights.Find(id)->enabled = doIt;
+    lightsDirty = true;
+}
+
+void SoftRenderer::RemoveLight(LightID id) {
+    if (!lights.Query(id)) return;
+    delete lights.Find(id);
+    lights.Remove(id);
+    lightsDirty = true;
+}
+
+int SoftRenderer::MaxEnabledLights() {
+    return MINIMUM_LIGHT_COUNT;
+}
+
+int SoftRenderer::NumLights() {
+    return lights.List().size();
+}
+
+// Spot lights are accepted but, as with the GL backend, give no light yet.
+void SoftRenderer::syncLights() {
+    if (!lightsDirty) return;
+    enabledLights.clear();
+    std::vector<Light*> list = lights.List();
+    for(uint32_t i = 0; i < list.size() && enabledLights.size() < (uint32_t)MaxEnabledLights(); ++i) {
+        if (!list[i]->enabled || list[i]->type == LightType::Spot) continue;
+        enabledLights.push_back(list[i]->data);
+    }
+    lightsDirty = false;
+}
+
+
+
+
+
+
+/* Display management */
+
+bool SoftRenderer::IsSupported(Capability c) {
+    return c == Capability::Lighting ||
+           c == Capability::AnyThread;
+}
+
+void SoftRenderer::SetDrawingMode(Polygon p, Dimension d, AlphaRule a) {
+    polygon = p;
+    dimension = d;
+    alpha = a;
+}
+
+void SoftRenderer::GetDrawingMode(Polygon * p, Dimension * d, AlphaRule * a) {
+    *p = polygon;
+    *d = dimension;
+    *a = alpha;
+}
+
+void SoftRenderer::AttachTarget(Framebuffer * f) {
+    if (!f) {
+        target = nullptr;
+        return;
+    }
+    if (f->GetHandleType() != Framebuffer::Type::RGBA_PixelArray) return;
+    target = f;
+}
+
+Framebuffer * SoftRenderer::GetTarget() {
+    return target;
+}
+
+std::vector<Framebuffer::Type> SoftRenderer::SupportedFramebuffers() {
+    return std::vector<Framebuffer::Type>({
+        Framebuffer::Type::RGBA_PixelArray
+    });
+}
+
@@ -0,0 +1,1050 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+#include <Dynacoe/Backends/Renderer/SoftRender/SoftRasterizer.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #define DC_SOFTRENDER_SSE2
+    #include <emmintrin.h>
+#endif
+
+using namespace Dynacoe;
+
+// Vertex positions are snapped to 1/16th of a pixel.
+static const int   subpixel_c    = 16;
+
+// Geometry further than this many pixels from the center of the target
+// is clipped away, which keeps edge function values within a tile inside
+// 32 bits.
+static const float guard_band_c  = 8192.f;
+
+// smallest w kept by clipping
+static const float min_w_c       = 1e-5f;
+
+static const int   max_workers_c = 15;
+
+// depth, 1/w, then each varying divided by w
+static const int   plane_count_c = SoftRasterizer::MaxVaryings + 2;
+
+
+
+// A value that varies linearly across the screen. At the center of
+// pixel (px, py) its value is base + dx*(px+.5-ox) + dy*(py+.5-oy)
+struct SoftPlane {
+    float base;
+    float dx;
+    float dy;
+};
+
+struct SoftPrimitive {
+    bool line;
+
+    // triangle edges: E = A*x + B*y + C in subpixel units,
+    // with the fill rule bias folded into C. Inside is E >= 0.
+    int32_t A[3];
+    int32_t B[3];
+    int64_t C[3];
+
+    // line endpoints, in pixels
+    float lx0, ly0, lx1, ly1;
+
+    // pixel bounds, inclusive and within the target
+    int minX, minY, maxX, maxY;
+
+    float ox, oy;
+    SoftPlane planes[plane_count_c];
+    const SoftTexture * texture;
+};
+
+
+struct Dynacoe::SoftRasterizerData {
+    uint8_t * color;
+    float   * depth;
+    int w;
+    int h;
+    int tilesX;
+    int tilesY;
+
+    std::vector<SoftPrimitive> prims;
+    std::vector<std::vector<uint32_t>> bins;
+    std::vector<uint32_t> active; // tiles with something to draw
+
+    // current draw
+    const SoftRasterizer::State * state;
+    int varyingCount;
+    std::vector<SoftRasterizer::Light> lights; // point lights already in view space
+
+    uint64_t primitiveCount;
+
+
+    // workers
+    int workerCount;
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation;
+    int busy;
+    bool exiting;
+    std::atomic<uint32_t> nextTile;
+};
+
+
+
+
+
+
+/* Fragments */
+
+static inline float evalPlane(const SoftPlane & p, float fx, float fy) {
+    return (p.base + p.dx*fx) + p.dy*fy;
+}
+
+static inline float clamp01(float f) {
+    return f < 0.f ? 0.f : (f > 1.f ? 1.f : f);
+}
+
+// u, v go from 0 to 1 across the image, with v = 0 at the first row in memory.
+static void sample(const uint8_t * data, int w, int h, float u, float v, bool linear, float * out) {
+    static const float norm = 1.f / 255.f;
+    if (w <= 0 || h <= 0) {
+        out[0] = out[1] = out[2] = out[3] = 0.f;
+        return;
+    }
+
+    if (!linear) {
+        int x = (int)floorf(u*w);
+        int y = (int)floorf(v*h);
+        x = x < 0 ? 0 : (x >= w ? w-1 : x);
+        y = y < 0 ? 0 : (y >= h ? h-1 : y);
+        const uint8_t * t = data + (y*w + x)*4;
+        out[0] = t[0]*norm;
+        out[1] = t[1]*norm;
+        out[2] = t[2]*norm;
+        out[3] = t[3]*norm;
+        return;
+    }
+
+    float fx = u*w - .5f;
+    float fy = v*h - .5f;
+    float bx = floorf(fx);
+    float by = floorf(fy);
+    float ax = fx - bx;
+    float ay = fy - by;
+    int x0 = (int)bx, x1 = x0+1;
+    int y0 = (int)by, y1 = y0+1;
+    x0 = x0 < 0 ? 0 : (x0 >= w ? w-1 : x0);
+    x1 = x1 < 0 ? 0 : (x1 >= w ? w-1 : x1);
+    y0 = y0 < 0 ? 0 : (y0 >= h ? h-1 : y0);
+    y1 = y1 < 0 ? 0 : (y1 >= h ? h-1 : y1);
+
+    const uint8_t * t00 = data + (y0*w + x0)*4;
+    const uint8_t * t10 = data + (y0*w + x1)*4;
+    const uint8_t * t01 = data + (y1*w + x0)*4;
+    const uint8_t * t11 = data + (y1*w + x1)*4;
+    for(int i = 0; i < 4; ++i) {
+        float top    = t00[i] + (t10[i] - t00[i])*ax;
+        float bottom = t01[i] + (t11[i] - t01[i])*ax;
+        out[i] = (top + (bottom - top)*ay)*norm;
+    }
+}
+
+static inline void sampleTexture(const SoftTexture * t, float u, float v, bool linear, float * out) {
+    sample(t->data, t->w, t->h, u, v, linear, out);
+}
+
+static inline float dot3(const float * a, const float * b) {
+    return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+}
+
+static inline void normalize3(const float * in, float * out) {
+    float len = sqrtf(dot3(in, in));
+    if (len > 0.f) {
+        out[0] = in[0] / len;
+        out[1] = in[1] / len;
+        out[2] = in[2] / len;
+    } else {
+        out[0] = out[1] = out[2] = 0.f;
+    }
+}
+
+
+// The same blinn-phong model as the GL backend's base shader.
+static void lightBF(const float * pos, const float * normal, const float * lightDir,
+                    const float * material, float distance, float * out) {
+    float l[3], n[3];
+    normalize3(lightDir, l);
+    normalize3(normal, n);
+    float intensity = dot3(l, n);
+    if (intensity < 0.f) intensity = 0.f;
+
+    for(int i = 0; i < 3; ++i)
+        out[i] += intensity * material[4+i] * material[7] / distance;
+
+    if (intensity > 0.f) {
+        float view[3] = {-pos[0], -pos[1], -pos[2]};
+        float viewDir[3];
+        normalize3(view, viewDir);
+        float half[3] = {lightDir[0] + viewDir[0], lightDir[1] + viewDir[1], lightDir[2] + viewDir[2]};
+        float H[3];
+        normalize3(half, H);
+        float NdotH = dot3(H, normal);
+        if (NdotH < 0.f) NdotH = 0.f;
+        float spec = powf(NdotH, material[12]);
+        for(int i = 0; i < 3; ++i)
+            out[i] += spec * material[8+i] * material[11] / distance;
+    }
+}
+
+static void calculateLight(SoftRasterizerData * d, const float * pos, const float * normal, float * out) {
+    const float * material = d->state->material;
+    out[0] = out[1] = out[2] = 0.f;
+    for(uint32_t i = 0; i < d->lights.size(); ++i) {
+        const SoftRasterizer::Light & light = d->lights[i];
+        float c[3] = {0.f, 0.f, 0.f};
+        float dir[3];
+        if (light.directional) {
+            float raw[3] = {-light.pos[0], -light.pos[1], -light.pos[2]};
+            normalize3(raw, dir);
+            lightBF(pos, normal, dir, material, 1.f, c);
+        } else {
+            float raw[3] = {light.pos[0] - pos[0], light.pos[1] - pos[1], light.pos[2] - pos[2]};
+            float away[3] = {pos[0] - raw[0], pos[1] - raw[1], pos[2] - raw[2]};
+            float distance = sqrtf(dot3(away, away));
+            if (distance < 1.f) distance = 1.f;
+            normalize3(raw, dir);
+            lightBF(pos, normal, dir, material, distance*distance, c);
+        }
+        for(int n = 0; n < 3; ++n)
+            out[n] += light.intensity * light.color[n] * c[n];
+    }
+}
+
+
+static void shade(SoftRasterizerData * d, const SoftPrimitive & p, const float * var, float * color) {
+    const SoftRasterizer::State & state = *d->state;
+    float s[4];
+    switch(state.shading) {
+      case SoftRasterizer::Shading::Vertex2D:
+        color[0] = var[0];
+        color[1] = var[1];
+        color[2] = var[2];
+        color[3] = var[3];
+        if (p.texture) {
+            sampleTexture(p.texture, var[4], var[5], state.linearFilter, s);
+            color[0] *= s[0];
+            color[1] *= s[1];
+            color[2] *= s[2];
+            color[3] *= s[3];
+        }
+        break;
+
+      case SoftRasterizer::Shading::Basic:
+        if (state.textures[0]) {
+            sampleTexture(state.textures[0], clamp01(var[0]), 1.f - clamp01(var[1]), state.linearFilter, color);
+        } else {
+            color[0] = state.material[4];
+            color[1] = state.material[5];
+            color[2] = state.material[6];
+            color[3] = 1.f;
+        }
+        if (state.sample) {
+            sample(state.sample, state.sampleW, state.sampleH, var[0], 1.f - var[1], state.linearFilter, s);
+            for(int i = 0; i < 4; ++i)
+                color[i] = .5f*color[i] + .5f*s[i];
+        }
+        break;
+
+      case SoftRasterizer::Shading::LightMaterial: {
+        float reflectivity = 1.f;
+        if (state.textures[1]) {
+            sampleTexture(state.textures[1], clamp01(var[0]), 1.f - clamp01(var[1]), state.linearFilter, s);
+            reflectivity = s[0]*100.f;
+        }
+        float light[3];
+        calculateLight(d, var+2, var+5, light);
+        color[0] = state.material[0] + reflectivity*light[0];
+        color[1] = state.material[1] + reflectivity*light[1];
+        color[2] = state.material[2] + reflectivity*light[2];
+        color[3] = 1.f;
+        if (state.textures[0]) {
+            sampleTexture(state.textures[0], clamp01(var[0]), 1.f - clamp01(var[1]), state.linearFilter, s);
+            for(int i = 0; i < 3; ++i)
+                color[i] = color[i]*.5f + s[i]*.5f;
+        }
+        if (state.sample) {
+            sample(state.sample, state.sampleW, state.sampleH, var[0], 1.f - var[1], state.linearFilter, s);
+            for(int i = 0; i < 3; ++i)
+                color[i] *= s[i];
+        }
+        color[3] = 1.f;
+        break;
+      }
+
+      default:
+        color[0] = 0.f;
+        color[1] = 0.f;
+        color[2] = 0.f;
+        color[3] = 1.f;
+    }
+}
+
+
+// Shades one pixel that passed coverage and depth and writes it out.
+static void fragment(SoftRasterizerData * d, const SoftPrimitive & p, int px, int py, float z) {
+    static const float norm = 1.f / 255.f;
+    float fx = ((float)px + .5f) - p.ox;
+    float fy = ((float)py + .5f) - p.oy;
+
+    float w = 1.f / evalPlane(p.planes[1], fx, fy);
+    float var[SoftRasterizer::MaxVaryings];
+    for(int i = 0; i < d->varyingCount; ++i) {
+        var[i] = evalPlane(p.planes[2+i], fx, fy) * w;
+    }
+
+    float c[4];
+    shade(d, p, var, c);
+    c[0] = clamp01(c[0]);
+    c[1] = clamp01(c[1]);
+    c[2] = clamp01(c[2]);
+    c[3] = clamp01(c[3]);
+
+    uint32_t index = py*d->w + px;
+    uint8_t * dst = d->color + index*4;
+    float a = c[3];
+    switch(d->state->alpha) {
+      case Renderer::AlphaRule::Allow:
+        if (a <= 0.f) return;
+        for(int i = 0; i < 3; ++i)
+            c[i] = c[i]*a + dst[i]*norm*(1.f - a);
+        c[3] = a*a + dst[3]*norm*(1.f - a);
+        break;
+
+      case Renderer::AlphaRule::Translucent:
+        if (a <= 0.f) return;
+        for(int i = 0; i < 3; ++i)
+            c[i] = clamp01(c[i]*a + dst[i]*norm);
+        c[3] = clamp01(a*a + dst[3]*norm);
+        break;
+
+      default:;
+    }
+
+    dst[0] = (uint8_t)(c[0]*255.f + .5f);
+    dst[1] = (uint8_t)(c[1]*255.f + .5f);
+    dst[2] = (uint8_t)(c[2]*255.f + .5f);
+    dst[3] = (uint8_t)(c[3]*255.f + .5f);
+    if (d->state->depthTest)
+        d->depth[index] = z;
+}
+
+// far plane and depth test
+static inline bool depthPasses(SoftRasterizerData * d, int index, float z) {
+    if (!(z >= 0.f && z <= 1.f)) return false;
+    return !d->state->depthTest || z < d->depth[index];
+}
+
+
+
+
+
+
+/* Tiles */
+
+
+// Range of an edge function over the pixel centers of a rectangle.
+static void edgeRange(const SoftPrimitive & p, int i, int x0, int y0, int x1, int y1, int64_t & low, int64_t & high) {
+    int64_t sx0 = (int64_t)x0*subpixel_c + subpixel_c/2;
+    int64_t sx1 = (int64_t)x1*subpixel_c + subpixel_c/2;
+    int64_t sy0 = (int64_t)y0*subpixel_c + subpixel_c/2;
+    int64_t sy1 = (int64_t)y1*subpixel_c + subpixel_c/2;
+    int64_t ax0 = p.A[i]*sx0, ax1 = p.A[i]*sx1;
+    int64_t by0 = p.B[i]*sy0, by1 = p.B[i]*sy1;
+    low  = std::min(ax0, ax1) + std::min(by0, by1) + p.C[i];
+    high = std::max(ax0, ax1) + std::max(by0, by1) + p.C[i];
+}
+
+
+static void drawTriangle(SoftRasterizerData * d, const SoftPrimitive & p, int tx0, int ty0, int tx1, int ty1) {
+    int x0 = std::max(tx0, p.minX);
+    int y0 = std::max(ty0, p.minY);
+    int x1 = std::min(tx1, p.maxX);
+    int y1 = std::min(ty1, p.maxY);
+    if (x0 > x1 || y0 > y1) return;
+
+    // tiles start on multiples of 4, so this stays within the tile.
+    int xa = x0 & ~3;
+
+    // Edges that cover the whole area are dropped, which leaves
+    // values small enough for 32 bits.
+    int32_t A[3], B[3], E[3];
+    for(int i = 0; i < 3; ++i) {
+        int64_t low, high;
+        edgeRange(p, i, x0, y0, x1, y1, low, high);
+        if (high < 0) return;
+        if (low >= 0) {
+            A[i] = B[i] = E[i] = 0;
+        } else {
+            A[i] = p.A[i];
+            B[i] = p.B[i];
+            E[i] = (int32_t)(
+                (int64_t)p.A[i]*((int64_t)xa*subpixel_c + subpixel_c/2) +
+                (int64_t)p.B[i]*((int64_t)y0*subpixel_c + subpixel_c/2) +
+                p.C[i]
+            );
+        }
+    }
+
+    const SoftPlane & zp = p.planes[0];
+
+    #ifdef DC_SOFTRENDER_SSE2
+        __m128i laneOff[3], step[3];
+        for(int i = 0; i < 3; ++i) {
+            int32_t a = A[i]*subpixel_c;
+            laneOff[i] = _mm_set_epi32(3*a, 2*a, a, 0);
+            step[i]    = _mm_set1_epi32(4*a);
+        }
+        __m128 zdx = _mm_set1_ps(zp.dx);
+        __m128 zbase = _mm_set1_ps(zp.base);
+        __m128 half = _mm_set1_ps(.5f);
+        __m128 ox = _mm_set1_ps(p.ox);
+    #endif
+
+    for(int y = y0; y <= y1; ++y) {
+        float fy = ((float)y + .5f) - p.oy;
+        int rowIndex = y*d->w;
+
+        #ifdef DC_SOFTRENDER_SSE2
+            __m128i e0 = _mm_add_epi32(_mm_set1_epi32(E[0]), laneOff[0]);
+            __m128i e1 = _mm_add_epi32(_mm_set1_epi32(E[1]), laneOff[1]);
+            __m128i e2 = _mm_add_epi32(_mm_set1_epi32(E[2]), laneOff[2]);
+            __m128 zrow = _mm_set1_ps(zp.dy*fy);
+        #else
+            int32_t e0 = E[0], e1 = E[1], e2 = E[2];
+        #endif
+
+        for(int x = xa; x <= x1; x += 4) {
+            int mask = 0xF;
+            if (x < x0)   mask &= (0xF << (x0 - x)) & 0xF;
+            if (x+3 > x1) mask &= 0xF >> (x+3 - x1);
+
+            float z[4];
+            #ifdef DC_SOFTRENDER_SSE2
+                __m128i outside = _mm_or_si128(_mm_or_si128(e0, e1), e2);
+                mask &= ~_mm_movemask_ps(_mm_castsi128_ps(outside));
+                e0 = _mm_add_epi32(e0, step[0]);
+                e1 = _mm_add_epi32(e1, step[1]);
+                e2 = _mm_add_epi32(e2, step[2]);
+                if (!mask) continue;
+
+                __m128 fx = _mm_sub_ps(
+                    _mm_add_ps(_mm_set_ps((float)(x+3), (float)(x+2), (float)(x+1), (float)x), half),
+                    ox
+                );
+                _mm_storeu_ps(z, _mm_add_ps(_mm_add_ps(zbase, _mm_mul_ps(zdx, fx)), zrow));
+            #else
+                for(int k = 0; k < 4; ++k) {
+                    int32_t off = k*subpixel_c;
+                    if ((e0 + A[0]*off) < 0 || (e1 + A[1]*off) < 0 || (e2 + A[2]*off) < 0)
+                        mask &= ~(1 << k);
+                }
+                e0 += 4*subpixel_c*A[0];
+                e1 += 4*subpixel_c*A[1];
+                e2 += 4*subpixel_c*A[2];
+                if (!mask) continue;
+
+                for(int k = 0; k < 4; ++k) {
+                    float fx = ((float)(x+k) + .5f) - p.ox;
+                    z[k] = (zp.base + zp.dx*fx) + zp.dy*fy;
+                }
+            #endif
+
+            for(int k = 0; k < 4; ++k) {
+                if (!(mask & (1 << k))) continue;
+                if (!depthPasses(d, rowIndex + x+k, z[k])) continue;
+                fragment(d, p, x+k, y, z[k]);
+            }
+        }
+
+        E[0] += B[0]*subpixel_c;
+        E[1] += B[1]*subpixel_c;
+        E[2] += B[2]*subpixel_c;
+    }
+}
+
+
+// Steps along the longer axis, one pixel each whose center is
+// within the line's span.
+static void drawLine(SoftRasterizerData * d, const SoftPrimitive & p, int tx0, int ty0, int tx1, int ty1) {
+    float dx = p.lx1 - p.lx0;
+    float dy = p.ly1 - p.ly0;
+    bool xMajor = fabsf(dx) >= fabsf(dy);
+
+    float start      = xMajor ? p.lx0 : p.ly0;
+    float end        = xMajor ? p.lx1 : p.ly1;
+    float minorStart = xMajor ? p.ly0 : p.lx0;
+    float minorEnd   = xMajor ? p.ly1 : p.lx1;
+
+    int first = (int)ceilf(std::min(start, end) - .5f);
+    int last  = (int)ceilf(std::max(start, end) - .5f) - 1;
+    first = std::max(first, xMajor ? std::max(tx0, p.minX) : std::max(ty0, p.minY));
+    last  = std::min(last,  xMajor ? std::min(tx1, p.maxX) : std::min(ty1, p.maxY));
+
+    int minorLow  = xMajor ? std::max(ty0, p.minY) : std::max(tx0, p.minX);
+    int minorHigh = xMajor ? std::min(ty1, p.maxY) : std::min(tx1, p.maxX);
+
+    for(int i = first; i <= last; ++i) {
+        float t = (((float)i + .5f) - start) / (end - start);
+        int j = (int)floorf(minorStart + t*(minorEnd - minorStart));
+        if (j < minorLow || j > minorHigh) continue;
+
+        int px = xMajor ? i : j;
+        int py = xMajor ? j : i;
+        float z = evalPlane(p.planes[0], ((float)px + .5f) - p.ox, ((float)py + .5f) - p.oy);
+        if (!depthPasses(d, py*d->w + px, z)) continue;
+        fragment(d, p, px, py, z);
+    }
+}
+
+
+static void drawTile(SoftRasterizerData * d, uint32_t tile) {
+    int tx0 = (tile % d->tilesX) * SoftRasterizer::TileSize;
+    int ty0 = (tile / d->tilesX) * SoftRasterizer::TileSize;
+    int tx1 = std::min(tx0 + SoftRasterizer::TileSize, d->w) - 1;
+    int ty1 = std::min(ty0 + SoftRasterizer::TileSize, d->h) - 1;
+
+    const std::vector<uint32_t> & bin = d->bins[tile];
+    for(uint32_t i = 0; i < bin.size(); ++i) {
+        const SoftPrimitive & p = d->prims[bin[i]];
+        if (p.line)
+            drawLine(d, p, tx0, ty0, tx1, ty1);
+        else
+            drawTriangle(d, p, tx0, ty0, tx1, ty1);
+    }
+}
+
+static void runTiles(SoftRasterizerData * d) {
+    uint32_t i;
+    while((i = d->nextTile.fetch_add(1)) < d->active.size()) {
+        drawTile(d, d->active[i]);
+    }
+}
+
+static void workerMain(SoftRasterizerData * d) {
+    uint64_t seen = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> l(d->lock);
+            d->wake.wait(l, [d, seen]{return d->exiting || d->generation != seen;});
+            if (d->exiting) return;
+            seen = d->generation;
+        }
+
+        runTiles(d);
+
+        std::lock_guard<std::mutex> l(d->lock);
+        if (--d->busy == 0)
+            d->done.notify_one();
+    }
+}
+
+static void dispatch(SoftRasterizerData * d) {
+    d->nextTile = 0;
+    if (d->active.size() > 1 && d->workerCount) {
+        if (d->workers.empty()) {
+            for(int i = 0; i < d->workerCount; ++i)
+                d->workers.push_back(std::thread(workerMain, d));
+        }
+        {
+            std::lock_guard<std::mutex> l(d->lock);
+            d->busy = d->workers.size();
+            d->generation++;
+        }
+        d->wake.notify_all();
+        runTiles(d);
+
+        std::unique_lock<std::mutex> l(d->lock);
+        d->done.wait(l, [d]{return d->busy == 0;});
+    } else {
+        runTiles(d);
+    }
+
+    for(uint32_t i = 0; i < d->active.size(); ++i)
+        d->bins[d->active[i]].clear();
+    d->active.clear();
+    d->primitiveCount += d->prims.size();
+    d->prims.clear();
+}
+
+
+
+
+
+
+/* Setup */
+
+static void bin(SoftRasterizerData * d, const SoftPrimitive & p) {
+    uint32_t index = d->prims.size();
+    d->prims.push_back(p);
+
+    int tileX0 = p.minX / SoftRasterizer::TileSize;
+    int tileY0 = p.minY / SoftRasterizer::TileSize;
+    int tileX1 = p.maxX / SoftRasterizer::TileSize;
+    int tileY1 = p.maxY / SoftRasterizer::TileSize;
+    bool single = tileX0 == tileX1 && tileY0 == tileY1;
+
+    for(int ty = tileY0; ty <= tileY1; ++ty) {
+        for(int tx = tileX0; tx <= tileX1; ++tx) {
+            if (!p.line && !single) {
+                // skip tiles that the bounds overlap but the triangle misses
+                int x0 = tx*SoftRasterizer::TileSize;
+                int y0 = ty*SoftRasterizer::TileSize;
+                int x1 = x0 + SoftRasterizer::TileSize - 1;
+                int y1 = y0 + SoftRasterizer::TileSize - 1;
+                bool miss = false;
+                for(int i = 0; i < 3 && !miss; ++i) {
+                    int64_t low, high;
+                    edgeRange(p, i, x0, y0, x1, y1, low, high);
+                    miss = high < 0;
+                }
+                if (miss) continue;
+            }
+
+            uint32_t tile = ty*d->tilesX + tx;
+            if (d->bins[tile].empty())
+                d->active.push_back(tile);
+            d->bins[tile].push_back(index);
+        }
+    }
+}
+
+
+struct ScreenVertex {
+    float x, y;      // pixels
+    float values[plane_count_c];
+};
+
+static void toScreen(SoftRasterizerData * d, const SoftRasterizer::Vertex & v, ScreenVertex & out) {
+    float invW = 1.f / v.pos[3];
+    out.x = (v.pos[0]*invW*.5f + .5f) * d->w;
+    out.y = (.5f - v.pos[1]*invW*.5f) * d->h;
+    out.values[0] = v.pos[2]*invW*.5f + .5f;
+    out.values[1] = invW;
+    for(int i = 0; i < d->varyingCount; ++i)
+        out.values[2+i] = v.var[i]*invW;
+}
+
+static inline int32_t snap(float f) {
+    return (int32_t)floorf(f*subpixel_c + .5f);
+}
+
+// floor(a / subpixel_c) for any sign
+static inline int floorSub(int64_t a) {
+    return (int)(a >= 0 ? a / subpixel_c : -((-a + subpixel_c - 1) / subpixel_c));
+}
+
+
+static void emitTriangle(
+    SoftRasterizerData * d,
+    const SoftRasterizer::Vertex & v0,
+    const SoftRasterizer::Vertex & v1,
+    const SoftRasterizer::Vertex & v2,
+    const SoftTexture * texture) {
+
+    ScreenVertex s[3];
+    toScreen(d, v0, s[0]);
+    toScreen(d, v1, s[1]);
+    toScreen(d, v2, s[2]);
+
+    int32_t x[3], y[3];
+    for(int i = 0; i < 3; ++i) {
+        x[i] = snap(s[i].x);
+        y[i] = snap(s[i].y);
+    }
+
+    int64_t area = (int64_t)(x[1]-x[0])*(y[2]-y[0]) - (int64_t)(x[2]-x[0])*(y[1]-y[0]);
+    if (area == 0) return;
+
+    // nothing is culled: flip the other winding around.
+    if (area < 0) {
+        std::swap(s[1], s[2]);
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+    }
+
+    SoftPrimitive p;
+    p.line = false;
+    p.texture = texture;
+
+
+    // bounds of the pixel centers within the triangle
+    int64_t minX = std::min(x[0], std::min(x[1], x[2]));
+    int64_t minY = std::min(y[0], std::min(y[1], y[2]));
+    int64_t maxX = std::max(x[0], std::max(x[1], x[2]));
+    int64_t maxY = std::max(y[0], std::max(y[1], y[2]));
+    p.minX = std::max(0,      -floorSub(-(minX - subpixel_c/2)));
+    p.minY = std::max(0,      -floorSub(-(minY - subpixel_c/2)));
+    p.maxX = std::min(d->w-1,  floorSub(maxX - subpixel_c/2));
+    p.maxY = std::min(d->h-1,  floorSub(maxY - subpixel_c/2));
+    if (p.minX > p.maxX || p.minY > p.maxY) return;
+
+
+    for(int i = 0; i < 3; ++i) {
+        int a = i;
+        int b = (i+1)%3;
+        p.A[i] = y[a] - y[b];
+        p.B[i] = x[b] - x[a];
+        p.C[i] = -((int64_t)p.A[i]*x[a] + (int64_t)p.B[i]*y[a]);
+
+        // top-left rule: pixels exactly on other edges belong to the neighbor.
+        if (!(p.A[i] > 0 || (p.A[i] == 0 && p.B[i] > 0)))
+            p.C[i] -= 1;
+    }
+
+
+    float fx0 = x[0] / (float)subpixel_c, fy0 = y[0] / (float)subpixel_c;
+    float fx1 = x[1] / (float)subpixel_c, fy1 = y[1] / (float)subpixel_c;
+    float fx2 = x[2] / (float)subpixel_c, fy2 = y[2] / (float)subpixel_c;
+    float ax = fx1 - fx0, ay = fy1 - fy0;
+    float bx = fx2 - fx0, by = fy2 - fy0;
+    float det = ax*by - bx*ay;
+    p.ox = fx0;
+    p.oy = fy0;
+    int planes = 2 + d->varyingCount;
+    for(int i = 0; i < planes; ++i) {
+        float f0 = s[0].values[i];
+        float d1 = s[1].values[i] - f0;
+        float d2 = s[2].values[i] - f0;
+        p.planes[i].base = f0;
+        p.planes[i].dx = (d1*by - d2*ay) / det;
+        p.planes[i].dy = (d2*ax - d1*bx) / det;
+    }
+
+    bin(d, p);
+}
+
+
+static void emitLine(
+    SoftRasterizerData * d,
+    const SoftRasterizer::Vertex & v0,
+    const SoftRasterizer::Vertex & v1) {
+
+    ScreenVertex s[2];
+    toScreen(d, v0, s[0]);
+    toScreen(d, v1, s[1]);
+
+    SoftPrimitive p;
+    p.line = true;
+    p.texture = nullptr;
+    p.lx0 = snap(s[0].x) / (float)subpixel_c;
+    p.ly0 = snap(s[0].y) / (float)subpixel_c;
+    p.lx1 = snap(s[1].x) / (float)subpixel_c;
+    p.ly1 = snap(s[1].y) / (float)subpixel_c;
+
+    float dx = p.lx1 - p.lx0;
+    float dy = p.ly1 - p.ly0;
+    float length2 = dx*dx + dy*dy;
+    if (length2 == 0.f) return;
+
+    p.minX = std::max(0,      (int)floorf(std::min(p.lx0, p.lx1)));
+    p.minY = std::max(0,      (int)floorf(std::min(p.ly0, p.ly1)));
+    p.maxX = std::min(d->w-1, (int)floorf(std::max(p.lx0, p.lx1)));
+    p.maxY = std::min(d->h-1, (int)floorf(std::max(p.ly0, p.ly1)));
+    if (p.minX > p.maxX || p.minY > p.maxY) return;
+
+    // values change only along the line
+    p.ox = p.lx0;
+    p.oy = p.ly0;
+    int planes = 2 + d->varyingCount;
+    for(int i = 0; i < planes; ++i) {
+        float f0 = s[0].values[i];
+        float df = s[1].values[i] - f0;
+        p.planes[i].base = f0;
+        p.planes[i].dx = df*dx / length2;
+        p.planes[i].dy = df*dy / length2;
+    }
+
+    bin(d, p);
+}
+
+
+
+/* Clipping */
+
+static const int clip_plane_count_c = 6;
+
+// Distance to each clip plane, negative when outside.
+// The near plane, w staying positive, then the guard band.
+static inline float clipDistance(SoftRasterizerData * d, const SoftRasterizer::Vertex & v, int plane) {
+    float gx = guard_band_c*2.f / d->w;
+    float gy = guard_band_c*2.f / d->h;
+    switch(plane) {
+      case 0: return v.pos[2] + v.pos[3];
+      case 1: return v.pos[3] - min_w_c;
+      case 2: return gx*v.pos[3] + v.pos[0];
+      case 3: return gx*v.pos[3] - v.pos[0];
+      case 4: return gy*v.pos[3] + v.pos[1];
+      default:return gy*v.pos[3] - v.pos[1];
+    }
+}
+
+static inline int outcode(SoftRasterizerData * d, const SoftRasterizer::Vertex & v) {
+    int code = 0;
+    for(int i = 0; i < clip_plane_count_c; ++i) {
+        if (clipDistance(d, v, i) < 0.f) code |= 1 << i;
+    }
+    return code;
+}
+
+static void lerpVertex(SoftRasterizerData * d, const SoftRasterizer::Vertex & a, const SoftRasterizer::Vertex & b, float t, SoftRasterizer::Vertex & out) {
+    for(int i = 0; i < 4; ++i)
+        out.pos[i] = a.pos[i] + (b.pos[i] - a.pos[i])*t;
+    for(int i = 0; i < d->varyingCount; ++i)
+        out.var[i] = a.var[i] + (b.var[i] - a.var[i])*t;
+}
+
+
+static void setupTriangle(
+    SoftRasterizerData * d,
+    const SoftRasterizer::Vertex & v0,
+    const SoftRasterizer::Vertex & v1,
+    const SoftRasterizer::Vertex & v2,
+    const SoftTexture * texture) {
+
+    int c0 = outcode(d, v0);
+    int c1 = outcode(d, v1);
+    int c2 = outcode(d, v2);
+    if (c0 & c1 & c2) return;
+    if (!(c0 | c1 | c2)) {
+        emitTriangle(d, v0, v1, v2, texture);
+        return;
+    }
+
+    // Sutherland-Hodgman against each plane crossed
+    SoftRasterizer::Vertex buffers[2][3 + clip_plane_count_c];
+    int count = 3;
+    buffers[0][0] = v0;
+    buffers[0][1] = v1;
+    buffers[0][2] = v2;
+    int in = 0;
+    int planes = c0 | c1 | c2;
+    for(int plane = 0; plane < clip_plane_count_c; ++plane) {
+        if (!(planes & (1 << plane))) continue;
+        SoftRasterizer::Vertex * src = buffers[in];
+        SoftRasterizer::Vertex * dst = buffers[!in];
+        int next = 0;
+        for(int i = 0; i < count; ++i) {
+            const SoftRasterizer::Vertex & a = src[i];
+            const SoftRasterizer::Vertex & b = src[(i+1)%count];
+            float da = clipDistance(d, a, plane);
+            float db = clipDistance(d, b, plane);
+            if (da >= 0.f)
+                dst[next++] = a;
+            if ((da >= 0.f) != (db >= 0.f))
+                lerpVertex(d, a, b, da / (da - db), dst[next++]);
+        }
+        count = next;
+        in = !in;
+        if (count < 3) return;
+    }
+
+    for(int i = 1; i+1 < count; ++i) {
+        emitTriangle(d, buffers[in][0], buffers[in][i], buffers[in][i+1], texture);
+    }
+}
+
+static void setupLine(
+    SoftRasterizerData * d,
+    const SoftRasterizer::Vertex & v0,
+    const SoftRasterizer::Vertex & v1) {
+
+    int c0 = outcode(d, v0);
+    int c1 = outcode(d, v1);
+    if (c0 & c1) return;
+    if (!(c0 | c1)) {
+        emitLine(d, v0, v1);
+        return;
+    }
+
+    float t0 = 0.f, t1 = 1.f;
+    for(int plane = 0; plane < clip_plane_count_c; ++plane) {
+        float d0 = clipDistance(d, v0, plane);
+        float d1 = clipDistance(d, v1, plane);
+        if (d0 < 0.f && d1 < 0.f) return;
+        if (d0 < 0.f) t0 = std::max(t0, d0 / (d0 - d1));
+        if (d1 < 0.f) t1 = std::min(t1, d0 / (d0 - d1));
+    }
+    if (t0 >= t1) return;
+
+    SoftRasterizer::Vertex a, b;
+    lerpVertex(d, v0, v1, t0, a);
+    lerpVertex(d, v0, v1, t1, b);
+    emitLine(d, a, b);
+}
+
+
+
+
+
+
+/* SoftRasterizer */
+
+SoftRasterizer::SoftRasterizer() {
+    data = new SoftRasterizerData;
+    data->color = nullptr;
+    data->depth = nullptr;
+    data->w = 0;
+    data->h = 0;
+    data->tilesX = 0;
+    data->tilesY = 0;
+    data->state = nullptr;
+    data->varyingCount = 0;
+    data->primitiveCount = 0;
+    data->generation = 0;
+    data->busy = 0;
+    data->exiting = false;
+    data->nextTile = 0;
+
+    int cores = std::thread::hardware_concurrency();
+    data->workerCount = std::max(0, std::min(cores - 1, max_workers_c));
+}
+
+SoftRasterizer::~SoftRasterizer() {
+    {
+        std::lock_guard<std::mutex> l(data->lock);
+        data->exiting = true;
+    }
+    data->wake.notify_all();
+    for(uint32_t i = 0; i < data->workers.size(); ++i)
+        data->workers[i].join();
+    delete data;
+}
+
+
+void SoftRasterizer::SetTarget(uint8_t * color, float * depth, int w, int h) {
+    if (!color || w <= 0 || h <= 0) {
+        data->color = nullptr;
+        data->depth = nullptr;
+        data->w = data->h = 0;
+        return;
+    }
+    data->color = color;
+    data->depth = depth;
+    data->w = w;
+    data->h = h;
+    data->tilesX = (w + TileSize - 1) / TileSize;
+    data->tilesY = (h + TileSize - 1) / TileSize;
+    if (data->bins.size() < (uint32_t)(data->tilesX*data->tilesY))
+        data->bins.resize(data->tilesX*data->tilesY);
+}
+
+
+void SoftRasterizer::Clear(const uint8_t rgba[4], float depth) {
+    if (!data->color) return;
+    uint32_t rowBytes = data->w*4;
+    for(int x = 0; x < data->w; ++x)
+        memcpy(data->color + x*4, rgba, 4);
+    for(int y = 1; y < data->h; ++y)
+        memcpy(data->color + y*rowBytes, data->color, rowBytes);
+    std::fill(data->depth, data->depth + data->w*data->h, depth);
+}
+
+
+void SoftRasterizer::Draw(
+    const State & state,
+    const Vertex * vertices,
+    const uint32_t * indices,
+    uint32_t count,
+    bool lines,
+    const SoftTexture * const * textures) {
+
+    if (!data->color || !count) return;
+    data->state = &state;
+    switch(state.shading) {
+      case Shading::Vertex2D:      data->varyingCount = 6; break;
+      case Shading::Basic:         data->varyingCount = 2; break;
+      case Shading::LightMaterial: data->varyingCount = 8; break;
+    }
+
+
+    // point lights are placed in view space once per draw
+    data->lights.clear();
+    if (state.shading == Shading::LightMaterial && state.lights) {
+        const float * m = state.view;
+        for(uint32_t i = 0; i < state.lights->size(); ++i) {
+            Light light = (*state.lights)[i];
+            if (!light.directional) {
+                float p[3] = {light.pos[0], light.pos[1], light.pos[2]};
+                for(int r = 0; r < 3; ++r)
+                    light.pos[r] = m[r]*p[0] + m[4+r]*p[1] + m[8+r]*p[2] + m[12+r];
+            }
+            data->lights.push_back(light);
+        }
+    }
+
+
+    if (lines) {
+        for(uint32_t i = 0; i+1 < count; i+=2) {
+            setupLine(data, vertices[indices[i]], vertices[indices[i+1]]);
+        }
+    } else {
+        for(uint32_t i = 0; i+2 < count; i+=3) {
+            setupTriangle(
+                data,
+                vertices[indices[i]],
+                vertices[indices[i+1]],
+                vertices[indices[i+2]],
+                textures ? textures[i/3] : nullptr
+            );
+        }
+    }
+
+    dispatch(data);
+    data->state = nullptr;
+}
+
+
+int SoftRasterizer::GetThreadCount() const {
+    return data->workerCount + 1;
+}
+
+uint64_t SoftRasterizer::GetPrimitiveCount() const {
+    return data->primitiveCount;
+}
+
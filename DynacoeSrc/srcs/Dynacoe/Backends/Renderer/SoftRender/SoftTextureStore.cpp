@@ -0,0 +1,91 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+#include <Dynacoe/Backends/Renderer/SoftRender/SoftTextureStore.h>
+#include <Dynacoe/Util/MemoryStats.h>
+#include <cstring>
+
+using namespace Dynacoe;
+
+
+SoftTextureStore::SoftTextureStore() {}
+
+SoftTextureStore::~SoftTextureStore() {
+    for(uint32_t i = 0; i < textures.size(); ++i) {
+        if (textures[i]) DeleteTexture(i);
+    }
+}
+
+
+int SoftTextureStore::NewTexture(int w, int h, const uint8_t * data) {
+    if (w < 0) w = 0;
+    if (h < 0) h = 0;
+    SoftTexture * tex = new SoftTexture;
+    tex->w = w;
+    tex->h = h;
+    tex->data = new uint8_t[w*h*4]();
+    if (data)
+        memcpy(tex->data, data, w*h*4);
+    MemoryStats::Track(MemoryStats::Category::Textures, (int64_t)w*h*4, 1);
+
+    if (dead.size()) {
+        int id = dead.back();
+        dead.pop_back();
+        textures[id] = tex;
+        return id;
+    }
+    textures.push_back(tex);
+    return textures.size()-1;
+}
+
+void SoftTextureStore::DeleteTexture(int id) {
+    SoftTexture * tex = (SoftTexture*)Get(id);
+    if (!tex) return;
+    MemoryStats::Track(MemoryStats::Category::Textures, -(int64_t)tex->w*tex->h*4, -1);
+    delete[] tex->data;
+    delete tex;
+    textures[id] = nullptr;
+    dead.push_back(id);
+}
+
+void SoftTextureStore::UpdateTexture(int id, const uint8_t * data) {
+    SoftTexture * tex = (SoftTexture*)Get(id);
+    if (!tex || !data) return;
+    memcpy(tex->data, data, tex->w*tex->h*4);
+}
+
+void SoftTextureStore::GetTextureData(int id, uint8_t * data) {
+    const SoftTexture * tex = Get(id);
+    if (!tex) return;
+    memcpy(data, tex->data, tex->w*tex->h*4);
+}
+
@@ -85,9 +85,17 @@ void Camera::SetType(Type t) {
 }
 
 void Camera::OnUpdateTransform() {
+    UpdateView();
     Graphics::UpdateCameraTransforms(this);
 }
 
+void Camera::UpdateView() {
+    TransformMatrix m = GetRenderTransform();
+    m.Inverse();
+    m.ReverseMajority();
+    Graphics::GetRenderer()->UpdateBuffer(modelView, m.GetData(), 0, 16);
+}
+
 
 void Camera::Refresh() {
     Framebuffer * old = Graphics::GetRenderer()->GetTarget();
@@ -176,21 +184,20 @@ Vector Camera::TransformScreenToWorld(const Dynacoe::Vector & p, float distance)
 
 
 void Camera::OnStep() {
-    TransformMatrix m = GetGlobalTransform();
-    m.Inverse();
-    m.ReverseMajority();
-    Graphics::GetRenderer()->UpdateBuffer(modelView, m.GetData(), 0, 16);
+    UpdateView();
 
 
 
     //Node().UpdateModelTransforms(modelView);
 
-    if (fb && type == Type::Orthographic2D) {
-        if (lastW != Graphics::GetRenderer()->GetTarget()->Width() ||
-            lastH != Graphics::GetRenderer()->GetTarget()->Height()) {
+    // a renderer may not have a target yet, e.g. right after it was swapped in.
+    Framebuffer * target = Graphics::GetRenderer()->GetTarget();
+    if (fb && target && type == Type::Orthographic2D) {
+        if (lastW != target->Width() ||
+            lastH != target->Height()) {
 
-            lastW = Graphics::GetRenderer()->GetTarget()->Width();
-            lastH = Graphics::GetRenderer()->GetTarget()->Height();
+            lastW = target->Width();
+            lastH = target->Height();
 
             projectionMatrix = Matrix_ProjectionOrthogonal(0, lastW, lastH, 0, -1024.f, 1024.f);
 
@@ -111,8 +111,6 @@ Color::Color(const std::string & src) {
     } else {
         *(this) = ((dictionary->count(str))? dictionary->find(str)->second : Color("white"));
     }
-    if (a.Byte() != 255)
-        printf("%d\n", a.Byte());
 }
 
 Color::Color(uint32_t clr) {
@@ -33,11 +33,15 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Dynacoe/Component.h>
 #include <Dynacoe/Modules/Console.h>
+#include <Dynacoe/Util/Profiler.h>
+#include <Dynacoe/Util/MemoryStats.h>
+#include <deque>
 
 using namespace Dynacoe;
 
 Component::Component(const std::string & tag_) {
-    tag = tag_;
+    typeID = GetTypeID(tag_);
+    typeListIndex = UINT32_MAX;
     host = nullptr;
     draw = true;
     step = true;
@@ -46,43 +50,176 @@ Component::Component(const std::string & tag_) {
     InstallEvent("on-detach");
 }
 
+Component::~Component() {
+    RemoveFromTypeList();
+}
+
 void Component::SetHost(Entity * h) {
     host = h;
 }
 
 void Component::Draw() {
-    OnDraw();
+    if (Profiler::IsEnabled()) {
+        Profiler::Scope zone(GetTag().c_str(), "Component");
+        OnDraw();
+    } else {
+        OnDraw();
+    }
 }
 
 void Component::Step() {
-    OnStep();
+    if (Profiler::IsEnabled()) {
+        Profiler::Scope zone(GetTag().c_str(), "Component");
+        OnStep();
+    } else {
+        OnStep();
+    }
+}
+
+
+
+
+
+
+
+// Global registry of component tags. Like event names, the 
+// strings are kept in a deque so references to them stay valid.
+static std::deque<std::string> & typeNames() {
+    static std::deque<std::string> * names = new std::deque<std::string>(1);
+    return *names;
+}
+
+static std::unordered_map<std::string, Component::TypeID> & typeNameToID() {
+    static std::unordered_map<std::string, Component::TypeID> * ids = new std::unordered_map<std::string, Component::TypeID>;
+    return *ids;
+}
+
+// Attached components of each type, indexed by TypeID.
+static std::vector<std::vector<Component *>> & typeLists() {
+    static std::vector<std::vector<Component *>> * lists = new std::vector<std::vector<Component *>>(1);
+    return *lists;
+}
+
+Component::TypeID Component::GetTypeID(const std::string & tag) {
+    auto & ids = typeNameToID();
+    auto it = ids.find(tag);
+    if (it != ids.end()) return it->second;
+
+    TypeID out = typeNames().size();
+    typeNames().push_back(tag);
+    typeLists().emplace_back();
+    ids[tag] = out;
+    return out;
+}
+
+const std::string & Component::GetTypeName(TypeID id) {
+    auto & names = typeNames();
+    return id < names.size() ? names[id] : names[0];
+}
+
+const std::vector<Component *> & Component::GetAllOfType(TypeID id) {
+    auto & lists = typeLists();
+    return id < lists.size() ? lists[id] : lists[0];
+}
+
+void Component::AddToTypeList() {
+    if (typeListIndex != UINT32_MAX) return;
+    auto & list = typeLists()[typeID];
+    typeListIndex = list.size();
+    list.push_back(this);
+}
+
+void Component::RemoveFromTypeList() {
+    if (typeListIndex == UINT32_MAX) return;
+    auto & list = typeLists()[typeID];
+    list[typeListIndex] = list.back();
+    list[typeListIndex]->typeListIndex = typeListIndex;
+    list.pop_back();
+    typeListIndex = UINT32_MAX;
 }
 
 
 
 
+// Global registry of event names. ID 0 is never handed out.
+// A deque, so that references from GetEventName() stay valid as names are added.
+static std::deque<std::string> & eventNames() {
+    static std::deque<std::string> * names = new std::deque<std::string>(1);
+    return *names;
+}
+
+static std::unordered_map<std::string, Component::EventID> & eventNameToID() {
+    static std::unordered_map<std::string, Component::EventID> * ids = new std::unordered_map<std::string, Component::EventID>;
+    return *ids;
+}
+
+Component::EventID Component::GetEventID(const std::string & name) {
+    auto & ids = eventNameToID();
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+
+    EventID out = eventNames().size();
+    eventNames().push_back(name);
+    ids[name] = out;
+    return out;
+}
+
+Component::EventID Component::FindEventID(const std::string & name) {
+    auto & ids = eventNameToID();
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : 0;
+}
+
+const std::string & Component::GetEventName(EventID id) {
+    auto & names = eventNames();
+    return id < names.size() ? names[id] : names[0];
+}
+
+int Component::findEvent(EventID id) const {
+    if (!id) return -1;
+    for(size_t i = 0; i < events.size(); ++i) {
+        if (events[i].event == id) return i;
+    }
+    return -1;
+}
 
 
 
-bool Component::EmitEvent(const std::string & ev, Entity::ID source, const std::vector<std::string> & args) {
 
-    auto eventHandlers = handlers.find(ev);
-    if (eventHandlers == handlers.end()) {
+bool Component::EmitEvent(const std::string & ev, Entity::ID source, const EventArgs & args) {
+    const EventID id = FindEventID(ev);
+    if (findEvent(id) < 0) {
         Dynacoe::Console::Error() << "Component " << GetTag() << " error: cannot perform unknown signal \"" << ev << "\"\n";
         return false;
     }
+    return EmitEvent(id, source, args);
+}
+
+bool Component::EmitEvent(EventID ev, Entity::ID source, const EventArgs & args) {
+    const int index = findEvent(ev);
+    if (index < 0) {
+        Dynacoe::Console::Error() << "Component " << GetTag() << " error: cannot perform unknown signal \"" << GetEventName(ev) << "\"\n";
+        return false;
+    }
 
-    EventSet fns = eventHandlers->second;
+    // Handlers are free to install or remove handlers while the event 
+    // runs, so the set is indexed fresh every time rather than copied.
+    // components that aren't attached, like a standalone DataTable, have no host.
+    const Entity::ID self = host ? host->GetID() : Entity::ID();
+    std::pair<EventHandler, void*> fn;
     bool retval = true;
-    for(int64_t i = fns.handlers.size()-1; i >= 0; --i) {
-        if (!fns.handlers[i].first(fns.handlers[i].second, this, GetHostID(), source, args)) {
+    for(size_t i = events[index].handlers.size(); i > 0; --i) {
+        if (i > events[index].handlers.size()) continue;
+        fn = events[index].handlers[i-1];
+        if (!fn.first(fn.second, this, self, source, args)) {
             retval = false;
             break;
         }
     }
 
-    for(size_t i = 0; i < fns.hooks.size(); ++i) {
-       fns.hooks[i].first(fns.hooks[i].second, this, GetHostID(), source, args);
+    for(size_t i = 0; i < events[index].hooks.size(); ++i) {
+        fn = events[index].hooks[i];
+        fn.first(fn.second, this, self, source, args);
     }
 
     return retval;
@@ -90,7 +227,11 @@ bool Component::EmitEvent(const std::string & ev, Entity::ID source, const std::
 
 
 bool Component::CanHandleEvent(const std::string & s) {
-    return handlers.find(s) != handlers.end();
+    return CanHandleEvent(FindEventID(s));
+}
+
+bool Component::CanHandleEvent(EventID id) {
+    return findEvent(id) >= 0;
 }
 
 
@@ -98,49 +239,62 @@ bool Component::CanHandleEvent(const std::string & s) {
 
 
 void Component::InstallEvent(const std::string & name, EventHandler h, void * data) {
-    if (handlers.find(name) != handlers.end()) {
+    const EventID id = GetEventID(name);
+    if (findEvent(id) >= 0) {
         Dynacoe::Console::Error() << "Component " << GetTag() << " error: cannot install \"" << name << "\", event is already installed.\n";
         return;
     }
+
+    // reuse the slot of an uninstalled event if there is one
+    int index = findEvent(0);
+    if (index < 0) {
+        index = events.size();
+        events.push_back(EventSet());
+    }
+    events[index].event = id;
     if (h) 
-        handlers[name].handlers.push_back({h, data});
-    else 
-        handlers[name] = EventSet();
+        events[index].handlers.push_back({h, data});
 }
 
 
 
 void Component::UninstallEvent(const std::string & name) {
-    handlers.erase(name);
+    const int index = findEvent(FindEventID(name));
+    if (index < 0) return;
+    events[index].event = 0;
+    events[index].handlers.clear();
+    events[index].hooks.clear();
 }
 
 
 
 std::vector<std::string> Component::GetKnownEvents() const {
     std::vector<std::string> out;
-    for(auto i = handlers.begin(); i != handlers.end(); ++i) {
-        out.push_back(i->first);
+    for(size_t i = 0; i < events.size(); ++i) {
+        if (!events[i].event) continue;
+        out.push_back(GetEventName(events[i].event));
     }
     return out;
 }
 
 
 void Component::InstallHandler(const std::string & name, EventHandler h, void * data) {
-    auto fns = handlers.find(name);
-    if (fns == handlers.end()) {
+    const int index = findEvent(FindEventID(name));
+    if (index < 0) {
         Dynacoe::Console::Error() << "Component " << GetTag() << " error: cannot add handler for \"" << name << "\": event is not installed.\n";
         return;
     }
-    fns->second.handlers.push_back({h, data});
+    events[index].handlers.push_back({h, data});
 }
 
 void Component::UninstallHandler(const std::string & name, EventHandler h) {
-    auto localHandlers = handlers.find(name);
-    if (localHandlers == handlers.end()) return;
+    const int index = findEvent(FindEventID(name));
+    if (index < 0) return;
 
-    for(size_t i = 0; i < localHandlers->second.handlers.size(); ++i) {
-        if (localHandlers->second.handlers[i].first == h) {
-            localHandlers->second.handlers.erase(localHandlers->second.handlers.begin()+i);
+    auto & handlers = events[index].handlers;
+    for(size_t i = 0; i < handlers.size(); ++i) {
+        if (handlers[i].first == h) {
+            handlers.erase(handlers.begin()+i);
         }
     }
 }
@@ -150,33 +304,50 @@ void Component::UninstallHandler(const std::string & name, EventHandler h) {
 
 
 void Component::InstallHook(const std::string & name, EventHandler h, void * data) {
-    auto fns = handlers.find(name);
-    if (fns == handlers.end()) {
+    const int index = findEvent(FindEventID(name));
+    if (index < 0) {
         Dynacoe::Console::Error() << "Component: cannot add hook for \"" << name << "\": event is not installed.\n";
         return;
     }
-    fns->second.hooks.push_back({h, data});
+    events[index].hooks.push_back({h, data});
 }
 
 void Component::UninstallHook(const std::string & name, EventHandler h) {
-    auto localHandlers = handlers.find(name);
-    if (localHandlers == handlers.end()) return;
+    const int index = findEvent(FindEventID(name));
+    if (index < 0) return;
 
-    for(size_t i = 0; i < localHandlers->second.hooks.size(); ++i) {
-        if (localHandlers->second.hooks[i].first == h) {
-            localHandlers->second.hooks.erase(localHandlers->second.hooks.begin()+i);
+    auto & hooks = events[index].hooks;
+    for(size_t i = 0; i < hooks.size(); ++i) {
+        if (hooks[i].first == h) {
+            hooks.erase(hooks.begin()+i);
         }
     }
 }
 
+// Pooled by size, like Entity. See Entity::operator new.
+static SlabAllocator & componentAllocator() {
+    static SlabAllocator * allocator = new SlabAllocator("Component");
+    return *allocator;
+}
+
+const SlabAllocator & Component::GetAllocator() {
+    return componentAllocator();
+}
+
+uint32_t Component::releaseEmptySlabs() {
+    return componentAllocator().ReleaseEmptySlabs();
+}
+
 void * Component::operator new(std::size_t size) {
-    return new char[size];
+    MemoryStats::Track(MemoryStats::Category::Components, size, 1);
+    return componentAllocator().Allocate(size);
 }
 
 
 
-void Component::operator delete(void * ptr)  {
-    delete[] (char*) ptr;
+void Component::operator delete(void * ptr, std::size_t size)  {
+    MemoryStats::Track(MemoryStats::Category::Components, -(int64_t)size, -1);
+    componentAllocator().Free(ptr, size);
 }
 
 
@@ -32,20 +32,15 @@ DEALINGS IN THE SOFTWARE.
 
 
 #include <Dynacoe/Components/Clock.h>
+#include <Dynacoe/Util/Time.h>
 
+static const Dynacoe::Component::EventID event_clock_step   = Dynacoe::Component::GetEventID("clock-step");
+static const Dynacoe::Component::EventID event_clock_draw   = Dynacoe::Component::GetEventID("clock-draw");
+static const Dynacoe::Component::EventID event_clock_expire = Dynacoe::Component::GetEventID("clock-expire");
 
-#ifdef _WIN32
 long Dynacoe::Clock::getMS() {
-	DWORD time = GetTickCount();
-	return time;
+    return realTime ? Time::MsSinceStartup() : Time::GameMsSinceStartup();
 }
-#else
-long Dynacoe::Clock::getMS() {
-	struct timeval timeValue;
-	gettimeofday(&timeValue, 0);
-	return timeValue.tv_usec/1000 + timeValue.tv_sec*1000;
-}
-#endif
 
 
 
@@ -54,6 +49,7 @@ Dynacoe::Clock::Clock() : Component("Clock"){
 	InstallEvent("clock-step");
 	InstallEvent("clock-draw");
 	InstallEvent("clock-expire");
+	realTime = false;
 	Set(-1);
 }
 
@@ -85,7 +81,7 @@ void Dynacoe::Clock::checkTime() {
 	long currentTime = getMS();
 	if (currentTime - timePaused >= endTime && !expired) {
 		expired = true;
-		EmitEvent("clock-expire");
+		EmitEvent(event_clock_expire);
 	}
 }
 
@@ -135,6 +131,22 @@ bool Dynacoe::Clock::IsPaused() {
     return paused;
 }
 
+void Dynacoe::Clock::SetRealTime(bool b) {
+    if (b == realTime) return;
+
+    // keep the elapsed and remaining time as they were.
+    long offset = getMS();
+    realTime = b;
+    offset = getMS() - offset;
+    startTime += offset;
+    endTime   += offset;
+    if (paused) pauseStart += offset;
+}
+
+bool Dynacoe::Clock::IsRealTime() {
+    return realTime;
+}
+
 int Dynacoe::Clock::GetDuration() {
 	return lastDuration;
 }
@@ -142,13 +154,11 @@ int Dynacoe::Clock::GetDuration() {
 
 void Dynacoe::Clock::OnStep() {
 	if (!GetHost() || IsExpired()) return;
-	EmitEvent("clock-step");
+	EmitEvent(event_clock_step);
 }
 
 void Dynacoe::Clock::OnDraw() {
 	if (!GetHost() || IsExpired()) return;
-	float ratio = lastDuration < 0 ? 1.f : GetTimeLeft() / float (lastDuration);
-	std::string data = (Chain() << ratio);
-	EmitEvent("clock-draw");
+	EmitEvent(event_clock_draw);
 }
 
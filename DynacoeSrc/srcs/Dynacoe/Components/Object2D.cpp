@@ -50,6 +50,9 @@ DEALINGS IN THE SOFTWARE.
 using namespace Dynacoe;
 using namespace std;
 
+static const Component::EventID event_on_move    = Component::GetEventID("on-move");
+static const Component::EventID event_on_collide = Component::GetEventID("on-collide");
+
 
 #include "Object2D_CollisionManager.hpp"
 #include "Object2D_Collider.hpp"
@@ -93,7 +96,7 @@ void Object2D::Update() {
     Vector delta = GetNextPosition() - GetHost()->GetGlobalTransform().Transform({});
     // using the "last" model, we include manual translations as part of 
     // normal collisions.
-    if (delta.Length() > .000001 && EmitEvent("on-move")) {
+    if (delta.Length() > .000001 && EmitEvent(event_on_move)) {
         node->Position() += delta;
         GetHost()->CheckUpdate();
     }
@@ -171,8 +171,8 @@ class CollisionManager : public Dynacoe::Entity {
                 }
 
                 if (current->collider.CollidesWith(other->collider)) {               
-                    current->EmitEvent("on-collide", other  ->GetHostID(), {});
-                      other->EmitEvent("on-collide", current->GetHostID(), {});
+                    current->EmitEvent(event_on_collide, other  ->GetHostID(), {});
+                      other->EmitEvent(event_on_collide, current->GetHostID(), {});
                     current->collider.lastCollided = other  ->GetHostID();
                       other->collider.lastCollided = current->GetHostID();
                 } else {
@@ -258,8 +258,8 @@ class CollisionManager : public Dynacoe::Entity {
                 other = hits[n];
                 current = objects[i];
                 if (current->collider.CollidesWith(other->collider)) {               
-                    current->EmitEvent("on-collide", other  ->GetHostID(), {});
-                      other->EmitEvent("on-collide", current->GetHostID(), {});
+                    current->EmitEvent(event_on_collide, other  ->GetHostID(), {});
+                      other->EmitEvent(event_on_collide, current->GetHostID(), {});
                     current->collider.lastCollided = other  ->GetHostID();
                       other->collider.lastCollided = current->GetHostID();
                 }
@@ -285,8 +285,8 @@ class CollisionManager : public Dynacoe::Entity {
                 other = space[i];
  
                 if (current->collider.CollidesWith(other->collider)) {               
-                    current->EmitEvent("on-collide", other  ->GetHostID(), {});
-                      other->EmitEvent("on-collide", current->GetHostID(), {});
+                    current->EmitEvent(event_on_collide, other  ->GetHostID(), {});
+                      other->EmitEvent(event_on_collide, current->GetHostID(), {});
                     current->collider.lastCollided = other  ->GetHostID();
                       other->collider.lastCollided = current->GetHostID();
                 }
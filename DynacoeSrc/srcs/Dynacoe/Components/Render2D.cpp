@@ -30,19 +30,22 @@ DEALINGS IN THE SOFTWARE.
 
 #include <Dynacoe/Components/Render2D.h>
 #include <Dynacoe/Modules/Graphics.h>
+#include <cstring>
+#include <algorithm>
 
 using namespace Dynacoe;
 
 
 Render2D::Render2D(const std::string & n) : Component(n){
     absolute = false;
+    layer = 0;
     mode = RenderMode::Normal;
     polygon = Renderer::Polygon::Triangle;
     objectID = Graphics::GetRenderer()->Add2DObject();
 }
 
 void Render2D::OnUpdateTransform() {
-    TransformMatrix m = GetGlobalTransform();
+    TransformMatrix m = GetRenderTransform();
     m.ReverseMajority();
     Renderer::Render2DObjectParameters obj = *(Renderer::Render2DObjectParameters*)m.GetData();
     Graphics::GetRenderer()->Set2DObjectParameters(
@@ -56,31 +59,35 @@ Render2D::~Render2D() {
 }
 
 void Render2D::SetVertices(const std::vector<Renderer::Vertex2D> & v) {
+    Renderer * renderer = Graphics::GetRenderer();
+    uint32_t kept = std::min(vertexSrc.size(), v.size());
     while (vertexSrc.size() < v.size()) {
-        vertexSrc.push_back(Graphics::GetRenderer()->Add2DVertex());
+        vertexSrc.push_back(renderer->Add2DVertex());
     }
     
     while (vertexSrc.size() > v.size()) {
-        uint32_t t = vertexSrc[vertexSrc.size()-1];
-        Graphics::GetRenderer()->Remove2DVertex(t);
-        vertexSrc.erase(vertexSrc.begin()+(vertexSrc.size()-1));
+        renderer->Remove2DVertex(vertexSrc.back());
+        vertexSrc.pop_back();
     }
+    vertexData.resize(v.size());
 
 
     for(uint32_t i = 0; i < v.size(); ++i) {
         Renderer::Vertex2D vertex = v[i];
         vertex.object = (float)objectID;
-        Graphics::GetRenderer()->Set2DVertex(vertexSrc[i], vertex);
+        if (i < kept && !memcmp(&vertex, &vertexData[i], sizeof(Renderer::Vertex2D))) continue;
+        vertexData[i] = vertex;
+        renderer->Set2DVertex(vertexSrc[i], vertex);
     }
 }
 
 
 std::vector<Renderer::Vertex2D> Render2D::GetVertices() const {
-    std::vector<Renderer::Vertex2D> out;
-    for(uint32_t i = 0; i < vertexSrc.size(); ++i) {
-        out.push_back(Graphics::GetRenderer()->Get2DVertex(vertexSrc[i]));
-    }
-    return out;
+    return vertexData;
+}
+
+const std::vector<Renderer::Vertex2D> & Render2D::GetVertexData() const {
+    return vertexData;
 }
 
 uint32_t Render2D::GetObjectID() const {
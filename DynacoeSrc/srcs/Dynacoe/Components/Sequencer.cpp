@@ -76,7 +76,7 @@ void Sequencer::Pause() {
     if (!IsPlaying()) return;
 
     pause = true;
-        pauseStartTime = Time::MsSinceStartup();
+        pauseStartTime = Time::GameMsSinceStartup();
         /*
         Console::Info()<<("Total pause time@ "); Console::Info()<<(pauseTime); Console::Info()<<("ms");
         Console::Info()<<("Playback Progress@ "); Console::Info()<<(playbackProgress); Console::Info()<<("ms");
@@ -185,7 +185,7 @@ void Sequencer::SkipPlayback(int millisecs) {
         soundQueue->erase(soundQueue->find(toRemove[i]));
     }
     totalPauseTime -= millisecs;
-    playbackProgress = (Time::MsSinceStartup() - GetPlaybackStart()) - totalPauseTime;
+    playbackProgress = (Time::GameMsSinceStartup() - GetPlaybackStart()) - totalPauseTime;
 
 }
 
@@ -233,7 +233,7 @@ void Sequencer::Start() {
 
 
 
-    playbackStart = Time::MsSinceStartup();
+    playbackStart = Time::GameMsSinceStartup();
 
     playbackProgress = 0;
     pauseTime = 0;
@@ -245,7 +245,7 @@ void Sequencer::Start() {
 
 
 Delay::Delay() {
-    createTime = Time::MsSinceStartup();
+    createTime = Time::GameMsSinceStartup();
     data = AssetID();
     volume = 128;
     delay = 0;
@@ -287,7 +287,7 @@ void Sequencer::OnStep() {
     Delay * delay;
     while (soundQueue->size() && !finishedTrying) {
         delay = *soundQueue->begin();
-        if (Time::MsSinceStartup() - playbackStart >= delay->delay) {
+        if (Time::GameMsSinceStartup() - playbackStart >= delay->delay) {
             Sound::PlayAudio(
                 delay->data,
                 delay->channel,
@@ -43,15 +43,18 @@ using std::vector;
 
 
 
-static float quadUV[] =  {
-    0.f, 0.f,
-    0.f, 1.f,
-    1.f, 1.f,
-
-    0.f, 0.f,
-    1.f, 1.f,
-    1.f, 0.f
-};
+// Shapes are formed here before being handed to SetVertices(), 
+// so re-forming or recoloring does not allocate once it has grown.
+static std::vector<Renderer::Vertex2D> & scratchVertices() {
+    static thread_local std::vector<Renderer::Vertex2D> scratch;
+    return scratch;
+}
+
+static inline Renderer::Vertex2D formVertex(float x, float y, const Color & c, float tex = -1.f, float u = 0.f, float v = 0.f) {
+    Renderer::Vertex2D out(x, y, c.r, c.g, c.b, c.a, tex, u, v);
+    out.object = 0.f;
+    return out;
+}
 
 void Shape2D::Initialize() {
     idFrame = 0;
@@ -73,22 +76,17 @@ void Shape2D::FormRectangle(
 
     id = AssetID();
 
-    vector<Renderer::Vertex2D> vertices;
+    vector<Renderer::Vertex2D> & vertices = scratchVertices();
     vertices.resize(6);
 
-    float rgba[4];
-    rgba[0] = color.r;
-    rgba[1] = color.g;
-    rgba[2] = color.b;
-    rgba[3] = color.a;
-
-    vertices[0] = {0, 0,     rgba[0], rgba[1], rgba[2], rgba[3]};
-    vertices[1] = {0, h,     rgba[0], rgba[1], rgba[2], rgba[3]};
-    vertices[2] = {w, h,     rgba[0], rgba[1], rgba[2], rgba[3]};
-    vertices[3] = {0, 0,     rgba[0], rgba[1], rgba[2], rgba[3]};
-    vertices[4] = {w, h,     rgba[0], rgba[1], rgba[2], rgba[3]};
-    vertices[5] = {w, 0,     rgba[0], rgba[1], rgba[2], rgba[3]};
+    vertices[0] = formVertex(0, 0, color);
+    vertices[1] = formVertex(0, h, color);
+    vertices[2] = formVertex(w, h, color);
+    vertices[3] = formVertex(0, 0, color);
+    vertices[4] = formVertex(w, h, color);
+    vertices[5] = formVertex(w, 0, color);
 
+    realColor = color;
     SetPolygon(Renderer::Polygon::Triangle);
     SetVertices(vertices);
 
@@ -103,15 +101,9 @@ void Shape2D::FormImage(AssetID id_, float fw, float fh) {
     }
     forcedWidth = fw;
     forcedHeight = fh;
-    vector<Renderer::Vertex2D> vertices;
+    vector<Renderer::Vertex2D> & vertices = scratchVertices();
     vertices.resize(6);
 
-    float rgba[4];
-    rgba[0] = color.r;
-    rgba[1] = color.g;
-    rgba[2] = color.b;
-    rgba[3] = color.a;
-
     //float texID = (idFrame < 0 ? im->getNextFrame() : im->getFrame(idFrame));
     id = id_;
     float tex = im->CurrentFrame().GetHandle();
@@ -121,14 +113,15 @@ void Shape2D::FormImage(AssetID id_, float fw, float fh) {
     if (forcedHeight > 0.f) h = forcedHeight;
     currentTexture = tex;
 
-    vertices[0] = {0, 0,     rgba[0], rgba[1], rgba[2], rgba[3],  tex, 0, 0};
-    vertices[1] = {0, h,     rgba[0], rgba[1], rgba[2], rgba[3],  tex, 0, 1};
-    vertices[2] = {w, h,     rgba[0], rgba[1], rgba[2], rgba[3],  tex, 1, 1};
-    vertices[3] = {0, 0,     rgba[0], rgba[1], rgba[2], rgba[3],  tex, 0, 0};
-    vertices[4] = {w, h,     rgba[0], rgba[1], rgba[2], rgba[3],  tex, 1, 1};
-    vertices[5] = {w, 0,     rgba[0], rgba[1], rgba[2], rgba[3],  tex, 1, 0};
+    vertices[0] = formVertex(0, 0, color, tex, 0, 0);
+    vertices[1] = formVertex(0, h, color, tex, 0, 1);
+    vertices[2] = formVertex(w, h, color, tex, 1, 1);
+    vertices[3] = formVertex(0, 0, color, tex, 0, 0);
+    vertices[4] = formVertex(w, h, color, tex, 1, 1);
+    vertices[5] = formVertex(w, 0, color, tex, 1, 0);
 
 
+    realColor = color;
     SetVertices(vertices);
     SetPolygon(Renderer::Polygon::Triangle);
     idFrame = -1;
@@ -148,62 +141,44 @@ void Shape2D::FormImageFrame(AssetID id_, int frame, float forcedWidth, float fo
 
 
 void Shape2D::FormCircle(float radius, int numIterations) {
-    vector<Vector> pts;
-    Vector curPt;
     id = AssetID();
+    vector<Renderer::Vertex2D> & vertices = scratchVertices();
+    vertices.resize(numIterations > 0 ? numIterations*3 : 0);
 
     for(int i = 0; i < numIterations; ++i) {
-        curPt.x = cos(2*Math::Pi() * (i / (float) numIterations)) * radius;
-        curPt.y = sin(2*Math::Pi() * (i / (float) numIterations)) * radius;
-        pts.push_back(curPt);
-        curPt.x = cos(2*Math::Pi() * (((i+1)%numIterations) / (float) numIterations)) * radius;
-        curPt.y = sin(2*Math::Pi() * (((i+1)%numIterations) / (float) numIterations)) * radius;
-        pts.push_back(curPt);
-        pts.push_back(Vector());
+        float a0 = 2*Math::Pi() * (i / (float) numIterations);
+        float a1 = 2*Math::Pi() * (((i+1)%numIterations) / (float) numIterations);
+        vertices[i*3]   = formVertex(cos(a0) * radius, sin(a0) * radius, color);
+        vertices[i*3+1] = formVertex(cos(a1) * radius, sin(a1) * radius, color);
+        vertices[i*3+2] = formVertex(0, 0, color);
     }
-    FormTriangles(pts);
+    realColor = color;
+    SetPolygon(Renderer::Polygon::Triangle);
+    SetVertices(vertices);
 }
 
 
 void Shape2D::FormTriangles(vector<Vector> & pts) {
-    std::vector<Renderer::Vertex2D> vertices;
+    vector<Renderer::Vertex2D> & vertices = scratchVertices();
     vertices.resize(pts.size());
 
-    float rgba[4];
-    rgba[0] = color.r;
-    rgba[1] = color.g;
-    rgba[2] = color.b;
-    rgba[3] = color.a;
-
-
     for(uint32_t i = 0; i < vertices.size(); ++i) {
-        vertices[i] = {
-            pts[i].x, pts[i].y,
-            rgba[0], rgba[1], rgba[2], rgba[3]
-        };
+        vertices[i] = formVertex(pts[i].x, pts[i].y, color);
     }
+    realColor = color;
     SetPolygon(Renderer::Polygon::Triangle);
     SetVertices(vertices);
 }
 
 void Shape2D::FormLines(const vector<Vector> & pts) {
-    std::vector<Renderer::Vertex2D> vertices;
+    vector<Renderer::Vertex2D> & vertices = scratchVertices();
     vertices.resize(pts.size());
     id = AssetID();
 
-    float rgba[4];
-    rgba[0] = color.r;
-    rgba[1] = color.g;
-    rgba[2] = color.b;
-    rgba[3] = color.a;
-
-
     for(uint32_t i = 0; i < vertices.size(); ++i) {
-        vertices[i] = {
-            pts[i].x, pts[i].y,
-            rgba[0], rgba[1], rgba[2], rgba[3]
-        };
+        vertices[i] = formVertex(pts[i].x, pts[i].y, color);
     }
+    realColor = color;
     SetPolygon(Renderer::Polygon::Line);
     SetVertices(vertices);
 }
@@ -214,9 +189,9 @@ void Shape2D::FormLines(const vector<Vector> & pts) {
 
 
 void Shape2D::OnDraw() {
-    // TODO: there... needs to be a better way
     if (!(realColor == color)) {
-        std::vector<Renderer::Vertex2D> v = GetVertices();
+        vector<Renderer::Vertex2D> & v = scratchVertices();
+        v = GetVertexData();
         for(uint32_t i = 0; i < v.size(); ++i) {
             v[i].r = color.r;
             v[i].g = color.g;
@@ -251,7 +226,8 @@ void Shape2D::SetFrameActive(const Image::Frame & frameRef) {
     if (GetVertexIDs().size() < 6) return;
     currentTexture = tex;
     
-    vector<Renderer::Vertex2D> vertices = GetVertices();
+    vector<Renderer::Vertex2D> & vertices = scratchVertices();
+    vertices = GetVertexData();
     vertices[0].useTex = tex;
     vertices[1].useTex = tex;
     vertices[2].useTex = tex;
@@ -0,0 +1,173 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#include <Dynacoe/Components/SpriteBatch2D.h>
+#include <Dynacoe/Modules/Graphics.h>
+#include <Dynacoe/Modules/Assets.h>
+#include <Dynacoe/Util/Math.h>
+#include <cmath>
+
+using namespace Dynacoe;
+
+
+
+SpriteBatch2D::SpriteBatch2D() : Render2D("SpriteBatch2D") {
+}
+
+SpriteBatch2D::~SpriteBatch2D() {
+    // Draws recorded but not yet submitted would point at freed sprites.
+    Graphics::forgetSprites2D(this);
+}
+
+
+uint32_t SpriteBatch2D::Add(AssetID image, int frame) {
+    Renderer::Sprite2D sprite;
+    sprite.transform[0] = 1.f; sprite.transform[1] = 0.f;
+    sprite.transform[2] = 0.f; sprite.transform[3] = 1.f;
+    sprite.transform[4] = 0.f; sprite.transform[5] = 0.f;
+    sprite.tint[0] = sprite.tint[1] = sprite.tint[2] = sprite.tint[3] = 1.f;
+
+    sprites.push_back(sprite);
+    sizes.push_back(1.f);
+    sizes.push_back(1.f);
+
+    uint32_t index = sprites.size()-1;
+    SetFrame(index, image, frame);
+    Set(index, Vector());
+    return index;
+}
+
+void SpriteBatch2D::Remove(uint32_t index) {
+    if (index >= sprites.size()) return;
+    sprites[index] = sprites.back();
+    sizes[index*2]   = sizes[sizes.size()-2];
+    sizes[index*2+1] = sizes[sizes.size()-1];
+    sprites.pop_back();
+    sizes.pop_back();
+    sizes.pop_back();
+}
+
+void SpriteBatch2D::Clear() {
+    sprites.clear();
+    sizes.clear();
+}
+
+uint32_t SpriteBatch2D::Count() const {
+    return sprites.size();
+}
+
+
+
+void SpriteBatch2D::Set(uint32_t index, const Vector & position, float rotation, const Vector & scale) {
+    if (index >= sprites.size()) return;
+    float * t = sprites[index].transform;
+
+    // columns are where the unit square's edges end up
+    float r = rotation * (Math::Pi() / 180.f);
+    float c = cos(r);
+    float s = sin(r);
+    float w = sizes[index*2]   * scale.x;
+    float h = sizes[index*2+1] * scale.y;
+    t[0] =  c*w; t[1] = s*w;
+    t[2] = -s*h; t[3] = c*h;
+
+    // and the square's center lands on position
+    t[4] = position.x - .5f*(t[0] + t[2]);
+    t[5] = position.y - .5f*(t[1] + t[3]);
+}
+
+void SpriteBatch2D::SetColor(uint32_t index, const Color & color) {
+    if (index >= sprites.size()) return;
+    sprites[index].tint[0] = color.r;
+    sprites[index].tint[1] = color.g;
+    sprites[index].tint[2] = color.b;
+    sprites[index].tint[3] = color.a;
+}
+
+void SpriteBatch2D::SetFrame(uint32_t index, AssetID image, int frame) {
+    if (index >= sprites.size()) return;
+    Renderer::Sprite2D & sprite = sprites[index];
+    float w = 1.f;
+    float h = 1.f;
+    sprite.texture = -1.f;
+    sprite.uvs[0] = 0.f; sprite.uvs[1] = 0.f;
+    sprite.uvs[2] = 1.f; sprite.uvs[3] = 1.f;
+
+    Image * im;
+    if (image.Valid() && (im = &Assets::Get<Image>(image)) && im->frames.size()) {
+        const Image::Frame & f = im->frames[(frame < 0 ? 0 : frame) % im->frames.size()];
+        sprite.texture = f.GetHandle();
+        w = f.Width();
+        h = f.Height();
+    }
+
+
+    // keep the placement: rescale the edges about the current center.
+    // An edge sized from an empty frame has no direction left to keep.
+    float * t = sprite.transform;
+    float cx = t[4] + .5f*(t[0] + t[2]);
+    float cy = t[5] + .5f*(t[1] + t[3]);
+    if (sizes[index*2] != 0.f) {
+        float sx = w / sizes[index*2];
+        t[0] *= sx; t[1] *= sx;
+    } else {
+        t[0] = w; t[1] = 0.f;
+    }
+    if (sizes[index*2+1] != 0.f) {
+        float sy = h / sizes[index*2+1];
+        t[2] *= sy; t[3] *= sy;
+    } else {
+        t[2] = 0.f; t[3] = h;
+    }
+    t[4] = cx - .5f*(t[0] + t[2]);
+    t[5] = cy - .5f*(t[1] + t[3]);
+    sizes[index*2]   = w;
+    sizes[index*2+1] = h;
+}
+
+
+const Renderer::Sprite2D * SpriteBatch2D::GetSprites() const {
+    return sprites.empty() ? nullptr : &sprites[0];
+}
+
+
+
+void SpriteBatch2D::OnDraw() {
+    Graphics::Draw(*this);
+}
+
+std::string SpriteBatch2D::GetInfo() {
+    return (Chain() <<
+        "Sprites: " << (int)sprites.size() << "\n"
+    );
+}
@@ -34,6 +34,8 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Dynacoe.h>
 #include <Dynacoe/Util/Chain.h>
 #include <Dynacoe/Util/Time.h>
+#include <Dynacoe/Util/Profiler.h>
+#include <Dynacoe/Util/SlowestEntities.h>
 #include <Dynacoe/Util/Math.h>
 #include <Dynacoe/Util/Filesys.h>
 #include <Dynacoe/Util/Random.h>
@@ -45,6 +47,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Modules/Graphics.h>
 #include <Dynacoe/Modules/Sound.h>
 #include <Dynacoe/Modules/Console.h>
+#include <Dynacoe/Modules/Stats.h>
 
 #include <map>
 #include <vector>
@@ -88,14 +91,27 @@ std::string Engine::Version() {
 
 static int maxFPS;
 static bool quit;
-Dynacoe::Clock        Engine::drawTime;
-Dynacoe::Clock        Engine::runTime;
-Dynacoe::Clock        Engine::sysTime;
-Dynacoe::Clock        Engine::debugTime;
-Dynacoe::Clock        Engine::frameTime;
-static Dynacoe::Clock        engineTime;
+// nanoseconds spent in each part of the frame since 
+// the diagnostics were last updated.
+static uint64_t              drawNs;
+static uint64_t              runNs;
+static uint64_t              sysNs;
+static uint64_t              engineNs;
+static uint64_t              reclaimNs;
+static uint64_t              diagnosticsStartNs;
+static float                 reclaimBudget;
+static FramePacer            pacer;
+static int                   stepRate;
+static int                   maxCatchUpSteps = 5;
+static uint64_t              stepAccumulatorNs;
+static uint64_t              lastStepNs;
+static float                 stepAlpha = 1.f;
+static int                   stepCount;
+static Engine::FrameTiming   lastFrame;
+static bool                  overBudget[MemoryStats::CategoryCount];
 
 std::vector<Module*>  Engine::modules;
+static std::vector<const char *> moduleZones;
 
 Entity *               Engine::systemWorld;
 
@@ -109,8 +125,6 @@ int                     Engine::frameCount;
 int                     Engine::valid = 0;
 
 
-double                  Engine::frameStart = 0;
-double                  Engine::frameEnd = 0;
 
 
 Entity::ID                 Engine::universe;
@@ -120,6 +134,25 @@ Entity::ID managers;
 static char buffer[1024];
 string test="";
 
+
+// Copies the per-category memory usage into the diagnostics and
+// warns once each time a category goes over its budget.
+static void updateMemoryDiagnostics() {
+    for(int i = 0; i < MemoryStats::CategoryCount; ++i) {
+        MemoryStats::Category category = (MemoryStats::Category)i;
+        diagnostics.memory[i] = MemoryStats::Get(category);
+
+        bool over = MemoryStats::IsOverBudget(category);
+        if (over && !overBudget[i]) {
+            Console::Warning() << "Memory for " << MemoryStats::GetName(category)
+                               << " is over budget ("
+                               << (double)diagnostics.memory[i].liveBytes / 1024 << " KB used, "
+                               << (double)diagnostics.memory[i].budgetBytes / 1024 << " KB budgeted)" << Console::End;
+        }
+        overBudget[i] = over;
+    }
+}
+
 int Engine::Run() {
 
     if (!valid) return -1;
@@ -152,71 +185,148 @@ int Engine::Run() {
 
 
     while (!(quit)) {
+        frame();
 
-        if (frameTime.GetTimeSince() >= 1000) {
-            frameTime.Reset();
+        if (GetMaxFPS() >= 0) {
+            Engine::Wait(GetMaxFPS());
+        } else {
+            return -3;
+        }
+    }
 
-            diagnostics.drawTimeMS = drawTime.GetTimeSince() / (float)frameCount;
-            diagnostics.stepTimeMS = runTime.GetTimeSince() / (float)frameCount;
-            diagnostics.systemTimeMS = sysTime.GetTimeSince() / (float)frameCount;
-            diagnostics.engineRealTimeMS = engineTime.GetTimeSince() / (float) frameCount;
 
-            //if (lastDrawTime >4) cout << lastDrawTime << endl;
+    return 0;
 
-            diagnostics.currentFPS = frameCount;
-            frameCount = 0;
+}
 
 
-            sysTime.Set();
-            drawTime.Set();
-            runTime.Set();
-            debugTime.Set();
-            engineTime.Set();
+std::vector<Engine::FrameTiming> Engine::RunFrames(int count, double dtMS) {
+    std::vector<FrameTiming> out;
+    if (!valid) return out;
 
-        }
+    bool wasVirtual = Time::GetVirtualClock();
+    Time::SetVirtualClock(true);
 
-        update();
-        render();
+    out.reserve(count);
+    for(int i = 0; i < count && !quit; ++i) {
+        Time::AdvanceVirtualClock(dtMS);
+        frame();
+        out.push_back(lastFrame);
+    }
 
+    Time::SetVirtualClock(wasVirtual);
+    quit = false;
+    return out;
+}
 
+const Engine::FrameTiming & Engine::GetLastFrameTiming() {
+    return lastFrame;
+}
 
-        engineTime.Pause();
-        if (GetMaxFPS() >= 0) {
-            Engine::Wait(GetMaxFPS());
-        } else {
-            return -3;
-        }
-        engineTime.Resume();
 
+void Engine::frame() {
+    uint64_t start = Time::NsSinceStartup();
+    if (start - diagnosticsStartNs >= 1000000000ull) {
+        diagnosticsStartNs = start;
+
+        float frameNs = (frameCount ? frameCount : 1) * 1000000.f;
+        diagnostics.drawTimeMS = drawNs / frameNs;
+        diagnostics.stepTimeMS = runNs / frameNs;
+        diagnostics.systemTimeMS = sysNs / frameNs;
+        diagnostics.engineRealTimeMS = engineNs / frameNs;
+        diagnostics.reclaimTimeMS = reclaimNs / frameNs;
+
+        diagnostics.currentFPS = frameCount;
+        diagnostics.stepsPerSecond = stepCount;
+        stepCount = 0;
+        diagnostics.frameJitter = pacer.GetJitter();
+        pacer.ResetJitter();
+        updateMemoryDiagnostics();
+        frameCount = 0;
+
+        drawNs = 0;
+        runNs = 0;
+        sysNs = 0;
+        engineNs = 0;
+        reclaimNs = 0;
+    }
+
+    Profiler::Scope frameZone("Frame", "Engine");
+    advance();
+    uint64_t stepped = Time::NsSinceStartup();
+    render();
+    uint64_t drawn = Time::NsSinceStartup();
+
+    // Removed entities are only destroyed here, between frames, 
+    // so nothing is freed while the hierarchy is being walked.
+    {
+        DC_PROFILE_ZONE("Reclaim", "Engine");
+        diagnostics.reclaimPending = Entity::ReclaimRemoved(reclaimBudget);
+    }
+    uint64_t end = Time::NsSinceStartup();
+    reclaimNs += end - drawn;
+    engineNs  += end - start;
+
+    lastFrame.stepMS    = (stepped - start) / 1000000.f;
+    lastFrame.drawMS    = (drawn - stepped) / 1000000.f;
+    lastFrame.reclaimMS = (end - drawn)     / 1000000.f;
+    lastFrame.totalMS   = (end - start)     / 1000000.f;
+
+    frameZone.End();
+    Profiler::EndFrame();
+    SlowestEntities::EndFrame();
+    frameCount++;
+}
 
-        drawTime.Pause();
-        runTime.Pause();
-        debugTime.Pause();
+// Runs however many steps are due this frame.
+void Engine::advance() {
+    if (stepRate <= 0) {
+        Spatial::SetInterpolation(false);
+        stepAlpha = 1.f;
+        lastStepNs = 0;
+        update();
+        stepCount++;
+        return;
+    }
 
-        frameCount++;
+    // game time, so that steps follow the virtual clock in RunFrames().
+    uint64_t stepNs = 1000000000ull / stepRate;
+    uint64_t now = Time::GameMsSinceStartup() * 1000000.0;
+    if (!lastStepNs) {
+        // first frame with a step rate: step right away.
+        stepAccumulatorNs = stepNs;
+    } else {
+        stepAccumulatorNs += now - lastStepNs;
     }
+    lastStepNs = now;
 
+    Spatial::SetInterpolation(true);
+    int steps = 0;
+    while(stepAccumulatorNs >= stepNs && steps < maxCatchUpSteps) {
+        Spatial::SnapshotTransforms();
+        update();
+        stepAccumulatorNs -= stepNs;
+        steps++;
+    }
+    stepCount += steps;
 
-    return 0;
+    // couldn't keep up; drop the backlog instead of spiraling.
+    if (stepAccumulatorNs >= stepNs)
+        stepAccumulatorNs %= stepNs;
 
+    stepAlpha = stepAccumulatorNs / (float)stepNs;
+    Spatial::SetInterpolationAlpha(stepAlpha);
 }
 
 void Engine::AddModule(Module * m) {
     modules.push_back(m);
+    moduleZones.push_back(Profiler::Intern(m->GetName()));
 }
 
 
 void Engine::Wait(int FPS) {
-
-        frameEnd = Time::MsSinceStartup();
-        double realEnd = frameEnd;
-
-        while (realEnd - frameStart < 1000.0 / ((float)FPS)) {
-            Time::SleepMS(1);
-            realEnd = Time::MsSinceStartup();
-        }
-
-        frameStart = Time::MsSinceStartup();
+    pacer.SetTargetFPS(FPS);
+    pacer.Wait();
 }
 
 
@@ -228,6 +338,34 @@ int Engine::GetMaxFPS() {
     return maxFPS;
 }
 
+void Engine::SetStepRate(int hz) {
+    stepRate = hz;
+}
+
+int Engine::GetStepRate() {
+    return stepRate;
+}
+
+void Engine::SetMaxCatchUpSteps(int i) {
+    maxCatchUpSteps = i < 1 ? 1 : i;
+}
+
+int Engine::GetMaxCatchUpSteps() {
+    return maxCatchUpSteps;
+}
+
+float Engine::GetStepAlpha() {
+    return stepAlpha;
+}
+
+void Engine::SetReclaimBudget(float ms) {
+    reclaimBudget = ms;
+}
+
+float Engine::GetReclaimBudget() {
+    return reclaimBudget;
+}
+
 
 
 
@@ -249,6 +387,7 @@ int Engine::Startup() {
     AddModule(new Input);
     AddModule(new Debugger);
     AddModule(new Console);
+    AddModule(new Stats);
 
 
     quit = false;
@@ -258,11 +397,15 @@ int Engine::Startup() {
     diagnostics.stepTimeMS = 0;
     diagnostics.systemTimeMS = 0;
     diagnostics.engineRealTimeMS = 0;
+    diagnostics.reclaimTimeMS = 0;
+    diagnostics.reclaimPending = 0;
 
 
 
     frameCount = 0;
-    frameTime.Reset();
+
+    diagnosticsStartNs = Time::NsSinceStartup();
+    Profiler::SetThreadName("Main");
 
     //Console::Info()  << "Initialized.";
 
@@ -299,53 +442,73 @@ void Engine::AttachManager(Entity::ID id) {
 }
 
 void Engine::render() {
-    sysTime.Resume();
-    for(uint32_t i = 0; i < modules.size(); ++i) {
-        modules[i]->DrawBefore();
+    uint64_t t0 = Time::NsSinceStartup();
+    {
+        DC_PROFILE_ZONE("Modules", "Engine");
+        for(uint32_t i = 0; i < modules.size(); ++i) {
+            DC_PROFILE_ZONE(moduleZones[i], "Module");
+            modules[i]->DrawBefore();
+        }
     }
-    sysTime.Pause();
-
-    drawTime.Resume();
-    Entity * base = universe.Identify();
-    if (base) base->Draw();
-    drawTime.Pause();
-
-    sysTime.Resume();
-    for(uint32_t i = 0; i < modules.size(); ++i) {
-        modules[i]->DrawAfter();
+    uint64_t t1 = Time::NsSinceStartup();
+    {
+        DC_PROFILE_ZONE("Draw", "Engine");
+        Spatial::UpdateAll();
+        Entity * base = universe.Identify();
+        if (base) base->Draw();
     }
-    if (managers.Valid())
-        managers.Identify()->Draw();
-    sysTime.Pause();
-    
-    drawTime.Resume();
-    if (Graphics::DrawEachFrame())
-        Graphics::Commit();
-    drawTime.Pause();
+    uint64_t t2 = Time::NsSinceStartup();
+    {
+        DC_PROFILE_ZONE("Modules", "Engine");
+        for(uint32_t i = 0; i < modules.size(); ++i) {
+            DC_PROFILE_ZONE(moduleZones[i], "Module");
+            modules[i]->DrawAfter();
+        }
+        if (managers.Valid())
+            managers.Identify()->Draw();
+    }
+    uint64_t t3 = Time::NsSinceStartup();
+    {
+        DC_PROFILE_ZONE("Draw", "Engine");
+        if (Graphics::DrawEachFrame())
+            Graphics::Commit();
+    }
+    uint64_t t4 = Time::NsSinceStartup();
+
+    sysNs  += (t1 - t0) + (t3 - t2);
+    drawNs += (t2 - t1) + (t4 - t3);
 }
 
 
 void Engine::update() {
-    sysTime.Resume();
-    for(uint32_t i = 0; i < modules.size(); ++i) {
-        modules[i]->RunBefore();
+    uint64_t t0 = Time::NsSinceStartup();
+    {
+        DC_PROFILE_ZONE("Modules", "Engine");
+        for(uint32_t i = 0; i < modules.size(); ++i) {
+            DC_PROFILE_ZONE(moduleZones[i], "Module");
+            modules[i]->RunBefore();
+        }
     }
-    sysTime.Pause();
-    
-    runTime.Resume();
-    Entity * base = universe.Identify();
-    if (base)base->Step();
-    runTime.Pause();
-
-    sysTime.Resume();
-    for(uint32_t i = 0; i < modules.size(); ++i) {
-        modules[i]->RunAfter();
+    uint64_t t1 = Time::NsSinceStartup();
+    {
+        DC_PROFILE_ZONE("Step", "Engine");
+        Entity * base = universe.Identify();
+        if (base)base->Step();
     }
-    
-    if (managers.Valid())
-        managers.Identify()->Step();
+    uint64_t t2 = Time::NsSinceStartup();
+    {
+        DC_PROFILE_ZONE("Modules", "Engine");
+        for(uint32_t i = 0; i < modules.size(); ++i) {
+            DC_PROFILE_ZONE(moduleZones[i], "Module");
+            modules[i]->RunAfter();
+        }
+        if (managers.Valid())
+            managers.Identify()->Step();
+    }
+    uint64_t t3 = Time::NsSinceStartup();
 
-    sysTime.Pause();
+    sysNs += (t1 - t0) + (t3 - t2);
+    runNs += t2 - t1;
 }
 
 void Engine::Quit() {
@@ -34,11 +34,15 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Entity.h>
 
 #include <Dynacoe/Util/Time.h>
+#include <Dynacoe/Util/Profiler.h>
+#include <Dynacoe/Util/MemoryStats.h>
+#include <Dynacoe/Util/SlowestEntities.h>
 #include <Dynacoe/Component.h>
 #include <Dynacoe/Modules/Console.h>
 #include <Dynacoe/Backends/Backend.h>
 #include <Dynacoe/Modules/Graphics.h>
 #include <algorithm>
+#include <queue>
 #include <iostream>
 #include <cassert>
 #include <cstdio>
@@ -47,100 +51,149 @@ DEALINGS IN THE SOFTWARE.
 using namespace std;
 using namespace Dynacoe;
 
+#include "Entity_StepScheduler.hpp"
 
 
-static std::unordered_map<void *, bool> * entityIDtableRef = nullptr;
-class EntityIDTable {
-  public:
-    EntityIDTable(Entity * e) {
-        if (!entityIDtableRef) entityIDtableRef = new std::unordered_map<void *, bool>;
-        refCount = 1;
-        source = e;
-        (*entityIDtableRef)[this] = true;
-        char selfstr[32];
-        selfstr[0] = 0;
-        snprintf(selfstr, 32, "%llx", this);
-        idStr = selfstr;
-    }
-    ~EntityIDTable() {
-        if (!entityIDtableRef) return;
-        entityIDtableRef->erase(entityIDtableRef->find(this));
-        if (entityIDtableRef->empty())
-            delete entityIDtableRef;
-    }
 
-    void EntityDestroyed() {
-        source = nullptr;
-        Remove();
-    }
+Entity::ID::Slot * Entity::ID::slots     = nullptr;
+uint32_t           Entity::ID::slotCount = 0;
 
-    Entity * GetInstance() const {
-        return source;
-    }
 
-    void Add() {refCount++;}
-    void Remove() {refCount--;
-        if (!refCount) {
-            delete this;
+// Generational slot map backing Entity::ID.
+// Slot 0 is reserved so that a zeroed ID is never valid. 
+// Freed slots are chained through nextFree and reused; each reuse 
+// has a new generation, which invalidates all older IDs for that slot.
+class Dynacoe::EntitySlotTable {
+  public:
+    static const uint32_t noSlot = 0;
+
+    static Entity::ID Acquire(Entity * e) {
+        if (!storage.size()) {
+            storage.push_back({nullptr, 0, noSlot});
         }
-    }
 
-    const std::string & ToString() {
-        return idStr;
+        uint32_t index;
+        if (freeHead != noSlot) {
+            index = freeHead;
+            freeHead = storage[index].nextFree;
+        } else {
+            index = storage.size();
+            storage.push_back({nullptr, 1, noSlot});
+            Entity::ID::slots     = &storage[0];
+            Entity::ID::slotCount = storage.size();
+        }
+
+        Entity::ID::Slot & slot = storage[index];
+        slot.entity   = e;
+        slot.nextFree = noSlot;
+        liveCount++;
+
+        Entity::ID out;
+        out.id = ((uint64_t)slot.generation << 32) | index;
+        return out;
     }
 
-    static EntityIDTable * FromString(const std::string & str) {
-        void * out = nullptr;
-        sscanf(str.c_str(), "%llx", &out);
-        return FromAddress((uint64_t)out);
+    static void Release(const Entity::ID & id) {
+        uint32_t index = (uint32_t)id.id;
+        if (!index || index >= storage.size()) return;
+        Entity::ID::Slot & slot = storage[index];
+        if (slot.generation != (uint32_t)(id.id >> 32)) return;
+
+        slot.entity = nullptr;
+        // generation 0 is never handed out, so the reserved slot
+        // and default IDs stay distinct from live ones.
+        if (!++slot.generation) slot.generation = 1;
+        slot.nextFree = freeHead;
+        freeHead = index;
+        liveCount--;
     }
 
-    static EntityIDTable * FromAddress(uint64_t id) {
-        if (entityIDtableRef->find((void*)id) == entityIDtableRef->end()) {
-            return nullptr;
+    // Returns the IDs of all live entities.
+    static void GetLive(std::vector<Entity::ID> & out) {
+        out.reserve(liveCount);
+        Entity::ID id;
+        for(uint32_t i = 1; i < storage.size(); ++i) {
+            if (!storage[i].entity) continue;
+            id.id = ((uint64_t)storage[i].generation << 32) | i;
+            out.push_back(id);
         }
-        return (EntityIDTable*)id;
     }
 
-
-
   private:
-    int refCount;
-    Entity * source;
-    std::string idStr;
+    static std::vector<Entity::ID::Slot> storage;
+    static uint32_t freeHead;
+    static uint32_t liveCount;
 };
 
+std::vector<Entity::ID::Slot> EntitySlotTable::storage;
+uint32_t EntitySlotTable::freeHead  = EntitySlotTable::noSlot;
+uint32_t EntitySlotTable::liveCount = 0;
+
 
 void Dynacoe::EntityErase(Entity * e) {
     delete e;
 }
 
+static SlabAllocator & entityAllocator();
 
-class EntityLimbo {
+
+// Removed entities wait here until the engine reclaims them 
+// at the end of the frame (see Entity::ReclaimRemoved()). They are kept
+// in a heap keyed on creation order so that the newest is always 
+// reclaimed first without a sort that would stall a budgeted frame.
+class Dynacoe::EntityLimbo {
   public:
     void SendToOblivion(Entity * e) {
-        lostSouls.push(e);
+        lostSouls.push({e->creationIndex, e});
     }
 
-    void OnStep() {
-        Entity * soul;
-
+    uint32_t Reclaim(double budgetMS) {
         // pass judgement
-        // (protip: everyone gets recycled)
+        // (protip: everyone gets recycled, newest first)
+        double start = budgetMS > 0 ? Time::MsSinceStartup() : 0;
+        uint32_t count = 0;
+        Entity * soul;
         while(!lostSouls.empty()) {
-            soul = lostSouls.top();
+            soul = lostSouls.top().second;
             lostSouls.pop();
             EntityErase(soul);
-        }
+            count++;
 
+            // Destructors may remove more entities, which are 
+            // also taken care of here.
+            if (budgetMS > 0 && !(count % reclaimCheckInterval) &&
+                Time::MsSinceStartup() - start >= budgetMS)
+                break;
+        }
 
+        // Entities die in batches, so whole slabs are usually 
+        // emptied together; those go back to the system at once.
+        if (count) {
+            entityAllocator().ReleaseEmptySlabs();
+            Component::releaseEmptySlabs();
+        }
+        return lostSouls.size();
     }
 
   private:
-    std::stack<Entity *> lostSouls;
+    // Checking the time costs more than most destructors, 
+    // so it is only done every so often.
+    static const uint32_t reclaimCheckInterval = 16;
+
+    std::priority_queue<std::pair<uint64_t, Entity *>> lostSouls;
 };
 
 static EntityLimbo * limbo = nullptr;
+static uint64_t nextCreationIndex = 0;
+
+uint32_t Entity::ReclaimRemoved(double budgetMS) {
+    if (EntityStepScheduler::Refuse("Entity::ReclaimRemoved()")) return 0;
+    if (!limbo) return 0;
+    return limbo->Reclaim(budgetMS);
+}
+
+static const Component::EventID event_on_attach = Component::GetEventID("on-attach");
+static const Component::EventID event_on_detach = Component::GetEventID("on-detach");
 
 
 template<typename T>
@@ -157,34 +210,63 @@ class Before {
 
 
 
-void Entity::initBase(){
-    static bool spawned = false;
-
-    if (spawned) return;
-    spawned = true;
-
-
-    PriorityList.clear();
-
+// Global registry of Entity names. A name's ID is its index + 1, 
+// leaving 0 for unnamed Entities.
+static std::vector<std::string> & entityNames() {
+    static std::vector<std::string> * names = new std::vector<std::string>;
+    return *names;
 }
 
+static std::unordered_map<std::string, uint32_t> & entityNameToID() {
+    static std::unordered_map<std::string, uint32_t> * ids = new std::unordered_map<std::string, uint32_t>;
+    return *ids;
+}
 
+// Every live Entity with each name, indexed by name ID.
+static std::vector<std::vector<Entity *>> & entitiesByName() {
+    static std::vector<std::vector<Entity *>> * lists = new std::vector<std::vector<Entity *>>(1);
+    return *lists;
+}
 
+static uint32_t findEntityName(const std::string & name) {
+    auto & ids = entityNameToID();
+    auto it = ids.find(name);
+    return it == ids.end() ? 0 : it->second;
+}
 
-
+static uint32_t internEntityName(const std::string & name) {
+    uint32_t out = findEntityName(name);
+    if (out) return out;
+    entityNames().push_back(name);
+    entitiesByName().emplace_back();
+    out = entityNames().size();
+    entityNameToID()[name] = out;
+    return out;
+}
 
 
 
 void Entity::Attach(Entity::ID NewEntID) {
+    if (EntityStepScheduler::InParallelStep()) {
+        EntityStepScheduler::Defer({EntityStepScheduler::Command::Type::Attach, id, NewEntID, 0, nullptr});
+        return;
+    }
     Entity * NewEnt = NewEntID.Identify();
     if (!NewEnt) return;
     if (NewEnt == this) return;
     if (NewEnt->world == this) return;
     if (NewEnt->world)
         NewEnt->world->Detach(NewEntID);
-    //priorityListQueueAdd(NewEnt);
-    priorityListAdd(NewEntID);
+
+    if (traversalDepth)
+        childJournal.push_back({NewEntID, true});
+    else {
+        sortChildren();
+        priorityListAdd(NewEntID);
+    }
     NewEnt->world = this;
+    NewEnt->updateAncestorNames(true);
+    NewEnt->updateActiveState();
     NewEnt->SetAsParent(this);
     NewEnt->OnEnter();
 }
@@ -194,25 +276,104 @@ void Entity::Attach(Entity & ent) {
 }
 
 void Entity::Detach(Entity::ID entID) {
+    if (EntityStepScheduler::InParallelStep()) {
+        EntityStepScheduler::Defer({EntityStepScheduler::Command::Type::Detach, id, entID, 0, nullptr});
+        return;
+    }
     Entity * ent = entID.Identify();
     if (!ent) return;
     if (!(ent->GetID()).Valid()) return;
+    ent->updateAncestorNames(false);
     ent->world = nullptr;
+    ent->updateActiveState();
     ent->SetAsParent(nullptr);
 
-
-    // Try to find the index of the entity
-    auto it = lower_bound(PriorityList.begin(), PriorityList.end(), entID, Before<Entity::ID>{});
-    size_t i;
-    for(i = distance(PriorityList.begin(), it); i < PriorityList.size(); ++i) {
-        if (PriorityList[i] == ent->GetID()) break;
+    if (traversalDepth) {
+        // the entry stays in PriorityList until the walk is done;
+        // Step() / Draw() skip it since it no longer has this parent.
+        childJournal.push_back({entID, false});
+    } else {
+        sortChildren();
+        // Try to find the index of the entity
+        auto it = lower_bound(PriorityList.begin(), PriorityList.end(), entID, Before<Entity::ID>{});
+        size_t i;
+        for(i = distance(PriorityList.begin(), it); i < PriorityList.size(); ++i) {
+            if (PriorityList[i] == ent->GetID()) break;
+        }
+        assert(i != PriorityList.size());
+        priorityListRemove(i);
     }
-    assert(i != PriorityList.size());
-    priorityListRemove(i);
     ent->OnDepart();
 }
 
 
+void Entity::applyChildJournal() {
+    // Every journaled entity is first pulled from the list in one pass. 
+    // This also clears out children that were removed during the walk, 
+    // which must be gone before any priority comparisons are made.
+    static thread_local std::vector<uint64_t> journaled;
+    static thread_local std::vector<bool> taken;
+    journaled.clear();
+    for(size_t i = 0; i < childJournal.size(); ++i) {
+        journaled.push_back(childJournal[i].id.Value());
+    }
+    std::sort(journaled.begin(), journaled.end());
+    journaled.erase(std::unique(journaled.begin(), journaled.end()), journaled.end());
+
+    PriorityList.erase(
+        std::remove_if(PriorityList.begin(), PriorityList.end(), [](const Entity::ID & id) {
+            return std::binary_search(journaled.begin(), journaled.end(), id.Value());
+        }),
+        PriorityList.end()
+    );
+
+
+    // Then whatever is still attached is sorted and merged back in.
+    // Like priorityListAdd(), later attaches go before earlier ones 
+    // and before existing children of the same priority.
+    static thread_local std::vector<Entity::ID> added;
+    static thread_local std::vector<Entity::ID> merged;
+    added.clear();
+    taken.assign(journaled.size(), false);
+    Entity * ent;
+    for(size_t i = childJournal.size(); i > 0; --i) {
+        const ChildJournalEntry & entry = childJournal[i-1];
+        if (!entry.attach) continue;
+        ent = entry.id.Identify();
+        if (!ent || ent->world != this) continue;
+        size_t n = std::lower_bound(journaled.begin(), journaled.end(), entry.id.Value()) - journaled.begin();
+        if (taken[n]) continue;
+        taken[n] = true;
+        added.push_back(entry.id);
+    }
+    childJournal.clear();
+    if (added.empty()) return;
+
+    sortChildren();
+    std::stable_sort(added.begin(), added.end(), Before<Entity::ID>{});
+    merged.resize(added.size() + PriorityList.size());
+    std::merge(added.begin(), added.end(), PriorityList.begin(), PriorityList.end(), merged.begin(), Before<Entity::ID>{});
+    PriorityList.swap(merged);
+}
+
+void Entity::getCurrentChildren(std::vector<Entity::ID> & out) const {
+    Entity * ent;
+    for(size_t i = 0; i < PriorityList.size(); ++i) {
+        ent = PriorityList[i].Identify();
+        if (ent && ent->world == this)
+            out.push_back(PriorityList[i]);
+    }
+
+    for(size_t i = 0; i < childJournal.size(); ++i) {
+        if (!childJournal[i].attach) continue;
+        ent = childJournal[i].id.Identify();
+        if (!ent || ent->world != this) continue;
+        if (std::find(out.begin(), out.end(), childJournal[i].id) != out.end()) continue;
+        out.push_back(childJournal[i].id);
+    }
+}
+
+
 
 
 
@@ -224,14 +385,19 @@ void Entity::Detach(Entity::ID entID) {
 int Entity::GetNumChildren() {return PriorityList.size();}
 
 const std::vector<Entity::ID> & Entity::GetChildren() const {
+    // re-sorting doesn't change which children there are, only 
+    // brings the order up to date.
+    const_cast<Entity*>(this)->sortChildren();
     return PriorityList;
 }
 
 std::vector<Entity::ID> Entity::GetAllSubEntities() const {
     std::vector<Entity::ID> out;
-    for(uint32_t i = 0; i < PriorityList.size(); ++i) {
-        out.push_back(PriorityList[i]);
-        auto sub = PriorityList[i].Identify()->GetAllSubEntities();
+    std::vector<Entity::ID> children;
+    getCurrentChildren(children);
+    for(uint32_t i = 0; i < children.size(); ++i) {
+        out.push_back(children[i]);
+        auto sub = children[i].Identify()->GetAllSubEntities();
         for(uint32_t n = 0; n < sub.size(); ++n) {
             out.push_back(sub[n]);
         }
@@ -251,95 +417,121 @@ bool Entity::Contains(Entity::ID ID) {
 
 std::vector<Entity::ID> Entity::FindChildByName(const std::string & str) {
     std::vector<Entity::ID> out;
-    std::vector<Entity::ID> iter;
-    Entity * w;
-    Entity::ID id;
-    Entity * ent;
-    for(int i = 0; i < PriorityList.size(); ++i) {
-        id = PriorityList[i];
-        if (!id.Valid()) continue;
-        ent = id.Identify();
-
-        if(ent->GetName() == str)
-            out.push_back(id);
-
-        // recursively look.
-        if (w = dynamic_cast<Entity*>(ent)) {
-            iter = w->FindChildByName(str);
-            for(int n = 0; n < iter.size(); ++n) {
-                out.push_back(iter[n]);
-            }
-        }
-
+    uint32_t nid = findEntityName(str);
+    if (!nid) return out;
+    auto count = subtreeNames.find(nid);
+    if (count == subtreeNames.end()) return out;
+
+    // When every Entity with the name is below this one, 
+    // there's nothing to filter.
+    const std::vector<Entity *> & named = entitiesByName()[nid];
+    bool all = count->second == named.size();
+    out.reserve(count->second);
+    for(size_t i = 0; i < named.size() && out.size() < count->second; ++i) {
+        if (all || named[i]->isWithin(this))
+            out.push_back(named[i]->id);
     }
     return out;
 }
 
 
+// Gets the lowest and highest priority among the children.
+// The list may be waiting to be re-sorted, so every child is checked.
+// Returns false if there are none.
+bool Entity::getChildPriorityRange(Priority & low, Priority & high) const {
+    bool found = false;
+    Entity * ent;
+    for(size_t i = 0; i < PriorityList.size(); ++i) {
+        ent = PriorityList[i].Identify();
+        if (!ent || ent->world != this) continue;
+        if (!found || ent->priority < low)  low  = ent->priority;
+        if (!found || ent->priority > high) high = ent->priority;
+        found = true;
+    }
+    return found;
+}
+
 void Entity::SetPriorityLast() {
     if (!HasParent()) return;
 
-    Entity & parent = GetParent();
-    if (!parent.PriorityList[parent.PriorityList.size() - 1].Valid()) return;
-    double best = parent.PriorityList[parent.PriorityList.size() - 1].Identify()->priority;
-    SetPriority(best + 1);
+    Priority low, high;
+    if (!GetParent().getChildPriorityRange(low, high)) return;
+    SetPriority(high + 1);
 
 }
 
 void Entity::SetPriorityFirst() {
     if (!HasParent()) return;
 
-    Entity & parent = GetParent();
-    if (!parent.PriorityList[0].Valid()) return;
-    double best = parent.PriorityList[0].Identify()->priority;
-    SetPriority(best - 1);
+    Priority low, high;
+    if (!GetParent().getChildPriorityRange(low, high)) return;
+    SetPriority(low - 1);
 
 
 }
 
 
+// Marks an entity's children as being walked. When the outermost walk
+// ends, on any path out, the changes journaled meanwhile are applied.
+class Entity::ChildWalk {
+  public:
+    ChildWalk(Entity * e) : ent(e) {
+        ent->traversalDepth++;
+    }
+    ~ChildWalk() {
+        if (!--ent->traversalDepth && !ent->childJournal.empty())
+            ent->applyChildJournal();
+    }
+  private:
+    Entity * ent;
+};
+
+
 void Entity::Step() {
     if (!step) return;
     Entity::ID idSelf = GetID();
 
+    // times the whole subtree; only measured while the profiler is on.
+    stepTime = 0;
+    Profiler::Scope zone(zoneName, "Step");
+
     OnPreStep();
     if (!idSelf.Valid()) return;
 
-    // take out the TRASH
-    if (limbo) {
-        limbo->OnStep();
-    }
     Entity * curEnt;
 
 
 
-    vector<Entity::ID> priorityListCopy = PriorityList;
-    uint32_t n, numEnts = priorityListCopy.size();
-    double recordTime;
+    uint32_t n;
 
-    stepTime = 0;
-    recordTime = Time::MsSinceStartup();
     for(n = 0; n < componentsBefore.size(); ++n) {
         if (!idSelf.Valid()) return;
         if (componentsBefore[n]->step)
             componentsBefore[n]->Step();
 
     }
+    if (!idSelf.Valid()) return;
 
 
-    for(int i = 0; i < numEnts; i++) {
-        if (!priorityListCopy[i].Valid()) {
-            //TODO: remove dead?
-            continue;
+    // PriorityList is walked in place; changes to it made by 
+    // children are journaled until the walk is over.
+    sortChildren();
+    {
+        ChildWalk walk(this);
+        if (parallelChildren) {
+            if (!stepChildrenParallel(idSelf)) return;
+        } else {
+            for(size_t i = 0; i < PriorityList.size(); i++) {
+                curEnt = PriorityList[i].Identify();
+                // if we have destroyed / detached entities native to this Entity
+                // within this loop, so we aren't going to run it
+                if (!curEnt || curEnt->world != this) continue;
+                curEnt->Step();
+                if (!idSelf.Valid()) return;
+            }
         }
-        curEnt = priorityListCopy[i].Identify();
-        if (!curEnt) continue;
-        // if we have destroyed / detached entities native to this Entity
-        // within this loop, so we aren't going to run it
-        curEnt->Step();
-
-
     }
+
     if (!idSelf.Valid()) return;
     // actual running of self
     OnStep();
@@ -350,11 +542,48 @@ void Entity::Step() {
     }
 
     if (!idSelf.Valid()) return;
+
+    stepTime = zone.End();
+    if (SlowestEntities::IsEnabled())
+        SlowestEntities::Report(this, false, stepTime);
+
+
+}
+
+
+
+// Steps children in runs of equal priority. Each run is handed to the
+// scheduler as a whole, so runs are still stepped in priority order.
+// Returns false if this entity was removed along the way.
+bool Entity::stepChildrenParallel(const Entity::ID & idSelf) {
+    // children pull from our global transform, so it has
+    // to be settled before they can read it concurrently.
     CheckUpdate();
 
-    stepTime = Time::MsSinceStartup()-recordTime;
+    Entity * curEnt;
+    size_t i = 0;
+    while(i < PriorityList.size()) {
+        parallelBatch.clear();
+        for(; i < PriorityList.size(); ++i) {
+            curEnt = PriorityList[i].Identify();
+            if (!curEnt || curEnt->world != this) continue;
+            if (!parallelBatch.empty() && curEnt->priority != parallelBatch[0]->priority) break;
+            parallelBatch.push_back(curEnt);
+        }
+
+        if (parallelBatch.empty()) break;
+        EntityStepScheduler::StepAll(&parallelBatch[0], parallelBatch.size());
+        if (!idSelf.Valid()) return false;
+    }
+    return true;
+}
 
+void Entity::SetParallelChildren(bool b) {
+    parallelChildren = b;
+}
 
+bool Entity::GetParallelChildren() const {
+    return parallelChildren;
 }
 
 
@@ -363,44 +592,41 @@ void Entity::Draw() {
     if (!draw) return;
     Entity::ID idSelf = GetID();
 
+    drawTime = 0;
+    Profiler::Scope zone(zoneName, "Draw");
+
     OnPreDraw();
     if (!idSelf.Valid()) return;
 
 
     size_t compInd;
 
-    // take out the TRASH
-    if (limbo) {
-        limbo->OnStep();
-    }
 
-    drawTime = 0;
-    double recordTime = Time::MsSinceStartup();
     for(compInd = 0; compInd < componentsBefore.size(); ++compInd) {
         if (!idSelf.Valid()) return;
         if (componentsBefore[compInd]->draw)
             componentsBefore[compInd]->Draw();
     }
 
-    // safely use a copy of priorityList
+    if (!idSelf.Valid()) return;
 
+    // PriorityList is walked in place; changes to it made by 
+    // children are journaled until the walk is over.
     Entity * e;
-    vector<Entity::ID> priorityListCopy = PriorityList;
-    bool lost = false;
-    for(size_t entIndex = 0; entIndex < priorityListCopy.size(); entIndex++) {
-        if (!priorityListCopy[entIndex].Valid()) continue;
-
-        e = priorityListCopy[entIndex].Identify();
-        if (!e) continue;
-        // if we have destroyed / detached entities native to this Entity
-        // within this loop, skip
-
-
-        e->Draw();
-        if (!idSelf.Valid()) return;
+    sortChildren();
+    {
+        ChildWalk walk(this);
+        for(size_t entIndex = 0; entIndex < PriorityList.size(); entIndex++) {
+            e = PriorityList[entIndex].Identify();
+            // if we have destroyed / detached entities native to this Entity
+            // within this loop, skip
+            if (!e || e->world != this) continue;
+
+            e->Draw();
+            if (!idSelf.Valid()) return;
 
+        }
     }
-    if (!idSelf.Valid()) return;
 
 
 
@@ -413,9 +639,10 @@ void Entity::Draw() {
 
     }
     if (!idSelf.Valid()) return;
-    CheckUpdate();
 
-    drawTime = Time::MsSinceStartup()-recordTime;
+    drawTime = zone.End();
+    if (SlowestEntities::IsEnabled())
+        SlowestEntities::Report(this, true, drawTime);
 }
 
 void Entity::priorityListAdd(Entity::ID curEnt) {
@@ -430,6 +657,53 @@ void Entity::priorityListRemove(int i) {
     PriorityList.erase(it);
 }
 
+// Puts PriorityList back in order after children changed their priorities.
+// Children are usually re-prioritized a little at a time (e.g. depth 
+// sorting by y), so an insertion sort is tried first; it is linear 
+// when the list is nearly in order. If it has to move things too 
+// far, it gives up and falls back to a regular sort.
+void Entity::sortChildren() {
+    if (!priorityDirty || traversalDepth) return;
+    priorityDirty = false;
+
+    // Priorities are pulled out once so comparisons don't go through Identify().
+    static thread_local std::vector<std::pair<Priority, Entity::ID>> keyed;
+    keyed.clear();
+    Entity * ent;
+    for(size_t i = 0; i < PriorityList.size(); ++i) {
+        ent = PriorityList[i].Identify();
+        keyed.push_back({ent ? ent->priority : INT64_MIN, PriorityList[i]});
+    }
+
+    size_t budget = keyed.size() * 8;
+    bool sorted = true;
+    for(size_t i = 1; i < keyed.size() && sorted; ++i) {
+        auto key = keyed[i];
+        size_t n = i;
+        while(n && keyed[n-1].first > key.first) {
+            keyed[n] = keyed[n-1];
+            n--;
+            if (!budget--) {
+                sorted = false;
+                break;
+            }
+        }
+        keyed[n] = key;
+    }
+
+    if (!sorted) {
+        std::stable_sort(keyed.begin(), keyed.end(),
+            [](const std::pair<Priority, Entity::ID> & a, const std::pair<Priority, Entity::ID> & b) {
+                return a.first < b.first;
+            }
+        );
+    }
+
+    for(size_t i = 0; i < keyed.size(); ++i) {
+        PriorityList[i] = keyed[i].second;
+    }
+}
+
 
 double Entity::StepDuration() {
     return stepTime;
@@ -443,9 +717,6 @@ double Entity::DrawDuration() {
 
 
 
-uint64_t Entity::idPool = 1;
-static std::unordered_map<std::string, Entity *> masterEntNameMap;
-static std::unordered_map<EntityIDTable*,    Entity *> masterEntIDMap;
 
 
 
@@ -453,91 +724,66 @@ static std::unordered_map<EntityIDTable*,    Entity *> masterEntIDMap;
 
 const char * unused_name_c = "<No Name>";
 
-Entity * Entity::ID::Identify() const {
-    if (!id) return nullptr;
-    EntityIDTable * table = (EntityIDTable*)id;
-    return table->GetInstance();
-}
 
 
 
-Entity::ID::ID(const ID & other) {
-    id = nullptr;
-    *this = other;
-}
-
-Entity::ID & Entity::ID::operator=(const Entity::ID & other) {
-    if (other.id) {
-        EntityIDTable * table = (EntityIDTable*)other.id;
-        table->Add();
-    }
-    if (id) {
-        EntityIDTable * table = (EntityIDTable*)id;
-        table->Remove();
-    }
-    id = other.id;
-
-    return *this;
-}
-Entity::ID::~ID() {
-    if (id) {
-        EntityIDTable * table = (EntityIDTable*)id;
-        table->Remove();
-    }
-}
-
-Entity::ID::ID(const std::string & str) {
-    id = EntityIDTable::FromString(str);
-    EntityIDTable * table = (EntityIDTable*)id;
-    if (id) table->Add();
+Entity::ID::ID(const std::string & str) : ID(){
+    unsigned long long value = 0;
+    if (sscanf(str.c_str(), "%llx", &value) == 1)
+        *this = ID((uint64_t)value);
 }
 
 Entity::ID::ID(uint64_t data) {
-    id = EntityIDTable::FromAddress(data);
-    EntityIDTable * table = (EntityIDTable*)id;
-    if (id) table->Add();
+    id = data;
+    if (!Identify()) id = 0;
 }
 
-const std::string & Entity::ID::String() const {
+std::string Entity::ID::String() const {
     if (!id) return "";
-    EntityIDTable * table = (EntityIDTable*)id;
-    return table->ToString();
+    char selfstr[32];
+    snprintf(selfstr, 32, "%llx", (unsigned long long)id);
+    return selfstr;
 }
 
 
 
 
-bool Entity::ID::Valid() const{
-    return Identify();
-}
 Entity::Entity(const std::string & str) : Entity(){
     SetName(str);
 }
-Entity::Entity() {
+Entity::Entity() : step(this), draw(this) {
+    EntityStepScheduler::CheckNotParallel("Entity creation");
     if (!limbo) {
         limbo = new EntityLimbo();
-        masterEntIDMap[0] = nullptr;
-
     }
+    creationIndex = nextCreationIndex++;
 
 
     name = unused_name_c;
+    zoneName = unused_name_c;
+    stepCost = 0.f;
+    drawCost = 0.f;
+    costSlot = -1;
 	priority = 0;
     world = nullptr;
+    priorityDirty = false;
+    nameID = 0;
+    nameListIndex = UINT32_MAX;
+    traversalDepth = 0;
+    parallelChildren = false;
 
 	step = true;
 	draw = true;
 	protectd = false;
     removed = false;
+    activeStep = true;
+    activeDraw = true;
 
-    EntityIDTable * table = new EntityIDTable(this);
-    idTable = (void*) table;
-    id.id = (void*) table;
-    masterEntIDMap[table] = this;
+    id = EntitySlotTable::Acquire(this);
 
 
-    Watch(Variable("draw", draw));
-    Watch(Variable("step", step));
+    Watch(Variable("draw", draw.value));
+    Watch(Variable("step", step.value));
 
 }
 
@@ -548,12 +794,20 @@ Entity::Entity() {
 
 void Entity::Remove() {
     if (removed) return;
+    if (EntityStepScheduler::InParallelStep()) {
+        EntityStepScheduler::Defer({EntityStepScheduler::Command::Type::Remove, id, Entity::ID(), 0, nullptr});
+        return;
+    }
     for(uint32_t i = 0; i < components.size(); ++i) {
-        components[i]->EmitEvent("on-detach", id, {});
+        components[i]->EmitEvent(event_on_detach, id);
     }
     OnRemove();
+    for(uint32_t i = 0; i < components.size(); ++i) {
+        components[i]->RemoveFromTypeList();
+    }
 
-    auto children = PriorityList;
+    std::vector<Entity::ID> children;
+    getCurrentChildren(children);
     for(uint32_t i = 0; i < children.size(); ++i) {
         if (children[i].Valid())
             children[i].Identify()->Remove();
@@ -562,22 +816,23 @@ void Entity::Remove() {
     if (HasParent()) {
         GetParent().Detach(GetID());
     }
-    masterEntIDMap.erase((EntityIDTable*)idTable);
-    if (masterEntNameMap.find(name) != masterEntNameMap.end())
-        masterEntNameMap.erase(name);
+    removeFromNameIndex();
 
     (limbo)->SendToOblivion(this);
     world = nullptr; // hide limbo's existence from itself? this is getting weird
     removed = true;
 
-    id.id = nullptr;
-    EntityIDTable * table = (EntityIDTable*)idTable;
-    table->EntityDestroyed();
+    EntitySlotTable::Release(id);
+    id = Entity::ID();
 
 
 }
 
 Entity::~Entity() {
+    // entities deleted without Remove() still need to give up their slot
+    EntitySlotTable::Release(id);
+    removeFromNameIndex();
+    SlowestEntities::Forget(this);
     for(uint32_t i = 0; i < components.size(); ++i) {
         delete (components[i]);
     }
@@ -603,9 +858,59 @@ string Entity::GetName() {
 void Entity::SetName(const string & str) {
     if (name == unused_name_c) {
         name = str;
-        masterEntNameMap[str] = this;
+        nameID = internEntityName(str);
+        zoneName = Profiler::Intern(str);
+        addToNameIndex();
+
+        for(Entity * e = world; e; e = e->world) {
+            e->subtreeNames[nameID]++;
+        }
+    }
+}
+
+void Entity::addToNameIndex() {
+    if (!nameID || nameListIndex != UINT32_MAX) return;
+    auto & list = entitiesByName()[nameID];
+    nameListIndex = list.size();
+    list.push_back(this);
+}
+
+void Entity::removeFromNameIndex() {
+    if (nameListIndex == UINT32_MAX) return;
+    auto & list = entitiesByName()[nameID];
+    list[nameListIndex] = list.back();
+    list[nameListIndex]->nameListIndex = nameListIndex;
+    list.pop_back();
+    nameListIndex = UINT32_MAX;
+}
+
+// Adds or subtracts the names of this Entity and everything below it 
+// from the counts kept by each of its ancestors.
+void Entity::updateAncestorNames(bool add) {
+    if (!nameID && subtreeNames.empty()) return;
+    for(Entity * e = world; e; e = e->world) {
+        if (nameID) {
+            if (add) e->subtreeNames[nameID]++;
+            else if (!--e->subtreeNames[nameID]) e->subtreeNames.erase(nameID);
+        }
+
+        for(auto it = subtreeNames.begin(); it != subtreeNames.end(); ++it) {
+            if (add) {
+                e->subtreeNames[it->first] += it->second;
+            } else {
+                uint32_t & count = e->subtreeNames[it->first];
+                count -= it->second;
+                if (!count) e->subtreeNames.erase(it->first);
+            }
+        }
+    }
+}
 
+bool Entity::isWithin(const Entity * ancestor) const {
+    for(const Entity * e = world; e; e = e->world) {
+        if (e == ancestor) return true;
     }
+    return false;
 }
 
 
@@ -613,14 +918,15 @@ void Entity::SetName(const string & str) {
 
 
 void Entity::SetPriority(Priority p) {
-    if (world) {
-        Entity::ID worldID = world->GetID();
-        world->Detach(id);
-        priority = p;
-        worldID.Identify()->Attach(id);
-    } else {
-        priority = p;
+    if (EntityStepScheduler::InParallelStep()) {
+        EntityStepScheduler::Defer({EntityStepScheduler::Command::Type::SetPriority, id, Entity::ID(), p, nullptr});
+        return;
     }
+    // The parent re-sorts its children once before it next needs 
+    // them in order, rather than this entity being detached and 
+    // re-attached. No enter / depart events are fired.
+    priority = p;
+    if (world) world->priorityDirty = true;
 }
 
 Entity::Priority Entity::GetPriority() {
@@ -641,10 +947,22 @@ bool Entity::HasParent() {
 
 
 void Entity::RemoveComponent(const string & tag) {
+    // interning the tag would touch the global type table.
+    if (EntityStepScheduler::InParallelStep()) {
+        for(size_t i = 0; i < components.size(); ++i) {
+            if (components[i]->GetTag() == tag) {
+                RemoveComponent(components[i]);
+                return;
+            }
+        }
+        return;
+    }
     Component * target  = nullptr;
+    Component::TypeID type = Component::GetTypeID(tag);
     for(size_t i = 0; i < components.size(); ++i) {
-        if (components[i]->GetTag() == tag) {
+        if (components[i]->GetTypeID() == type) {
             components[i]->SetHost(nullptr);
+            components[i]->RemoveFromTypeList();
             target = components[i];
             components.erase(components.begin() + i);
             break;
@@ -653,8 +971,8 @@ void Entity::RemoveComponent(const string & tag) {
 
     for(size_t i = 0; i < componentsBefore.size(); ++i) {
         if (componentsBefore[i] == target) {
-            componentsBefore.erase(componentsBefore.begin() + i);
             delete componentsBefore[i];
+            componentsBefore.erase(componentsBefore.begin() + i);
             return;
         }
     }
@@ -673,9 +991,14 @@ void Entity::RemoveComponent(const string & tag) {
 }
 
 void Entity::RemoveComponent(const Component * c) {
+    if (EntityStepScheduler::InParallelStep()) {
+        EntityStepScheduler::Defer({EntityStepScheduler::Command::Type::RemoveComponent, id, Entity::ID(), 0, c});
+        return;
+    }
     for(size_t i = 0; i < components.size(); ++i) {
         if (components[i] == c) {
             components[i]->SetHost(nullptr);
+            components[i]->RemoveFromTypeList();
             components.erase(components.begin() + i);
             break;
         }
@@ -743,43 +1066,90 @@ void Entity::Unwatch(const std::string & varName) {
 }
 
 
-bool Entity::IsStepping() {
-    if (!step) return false;
-    if (!HasParent()) return true;
-    Entity * ent = this;
-    do {
-        ent = &ent->GetParent();
-        if (!ent->step) return false;
-    } while(ent->HasParent());
-    return true;
+Entity::ActiveFlag & Entity::ActiveFlag::operator=(bool v) {
+    if (v == value) return *this;
+    value = v;
+    owner->updateActiveState();
+    return *this;
 }
 
-bool Entity::IsDrawing() {
-    if (!draw) return false;
-    if (!HasParent()) return true;
-    Entity * ent = this;
-    do {
-        ent = &ent->GetParent();
-        if (!ent->draw) return false;
-    } while(ent->HasParent());
-    return true;
+void Entity::RefreshActiveState() {
+    // Walked with one explicit stack that is reused between calls, 
+    // rather than gathering a child list per node.
+    static std::vector<Entity *> pending;
+    pending.clear();
+    pending.push_back(this);
+
+    Entity * cur;
+    Entity * ent;
+    while(pending.size()) {
+        cur = pending.back();
+        pending.pop_back();
+        cur->activeStep = cur->step && (!cur->world || cur->world->activeStep);
+        cur->activeDraw = cur->draw && (!cur->world || cur->world->activeDraw);
+
+        for(size_t i = 0; i < cur->PriorityList.size(); ++i) {
+            ent = cur->PriorityList[i].Identify();
+            if (ent && ent->world == cur) pending.push_back(ent);
+        }
+        for(size_t i = 0; i < cur->childJournal.size(); ++i) {
+            if (!cur->childJournal[i].attach) continue;
+            ent = cur->childJournal[i].id.Identify();
+            if (ent && ent->world == cur) pending.push_back(ent);
+        }
+    }
 }
 
+// Recomputes the effective step / draw state and pushes it down to 
+// children, stopping wherever it doesn't change.
+void Entity::updateActiveState() {
+    bool s = step && (!world || world->activeStep);
+    bool d = draw && (!world || world->activeDraw);
+    if (s == activeStep && d == activeDraw) return;
+    activeStep = s;
+    activeDraw = d;
 
-std::vector<Entity::ID> Entity::GetAll() {
-    if (limbo) {
-        limbo->OnStep();
+    Entity * ent;
+    for(size_t i = 0; i < PriorityList.size(); ++i) {
+        ent = PriorityList[i].Identify();
+        if (ent && ent->world == this) ent->updateActiveState();
     }
+    for(size_t i = 0; i < childJournal.size(); ++i) {
+        if (!childJournal[i].attach) continue;
+        ent = childJournal[i].id.Identify();
+        if (ent && ent->world == this) ent->updateActiveState();
+    }
+}
+
+
+std::vector<Entity::ID> Entity::GetAll() {
+    // Removed entities give up their IDs right away, so there's 
+    // no need to flush limbo first.
     std::vector<Entity::ID> out;
-    Entity::ID id;
-    for(auto it = masterEntIDMap.begin(); it != masterEntIDMap.end(); ++it) {
-        id = Entity::ID((uint64_t)it->first);
-        if (!id.Valid()) continue;
-        out.push_back(id);
+    EntitySlotTable::GetLive(out);
+    return out;
+}
+
+std::vector<Entity::ID> Entity::FindByName(const std::string & str) {
+    std::vector<Entity::ID> out;
+    uint32_t nid = findEntityName(str);
+    if (!nid) return out;
+    const std::vector<Entity *> & named = entitiesByName()[nid];
+    out.reserve(named.size());
+    for(size_t i = 0; i < named.size(); ++i) {
+        out.push_back(named[i]->id);
     }
     return out;
 }
 
+const std::vector<std::string> & Entity::GetKnownNames() {
+    return entityNames();
+}
+
+void Entity::checkCanAddComponent() {
+    EntityStepScheduler::CheckNotParallel("Entity::AddComponent()");
+}
+
 void Entity::AddComponentInternal(Component * c, UpdateClass when) {
     if (when == UpdateClass::Before)
         componentsBefore.push_back(c);
@@ -791,19 +1161,36 @@ void Entity::AddComponentInternal(Component * c, UpdateClass when) {
         cSp->SetAsParent(this);
     }
     c->SetHost(this);
+    c->AddToTypeList();
     c->OnAttach();
-    c->EmitEvent("on-attach", id, {});
+    c->EmitEvent(event_on_attach, id);
 }
 
 
+// Entities are typically spawned and removed in large numbers, 
+// so they are pooled by size rather than going to the system allocator. 
+// Since the destructor is virtual, the size given back to delete is the 
+// size of the most derived type, matching what was requested from new.
+static SlabAllocator & entityAllocator() {
+    static SlabAllocator * allocator = new SlabAllocator("Entity");
+    return *allocator;
+}
+
+const SlabAllocator & Entity::GetAllocator() {
+    return entityAllocator();
+}
+
 void * Entity::operator new(std::size_t size) {
-    return new char[size];
+    EntityStepScheduler::CheckNotParallel("Entity creation");
+    MemoryStats::Track(MemoryStats::Category::Entities, size, 1);
+    return entityAllocator().Allocate(size);
 }
 
 
 
-void Entity::operator delete(void * ptr)  {
-    delete[] (char*) ptr;
+void Entity::operator delete(void * ptr, std::size_t size)  {
+    MemoryStats::Track(MemoryStats::Category::Entities, -(int64_t)size, -1);
+    entityAllocator().Free(ptr, size);
 }
 
 
@@ -0,0 +1,262 @@
+/*
+
+Work-stealing scheduler for entities with parallel children.
+
+Each thread that takes part in stepping owns a queue. Index 0 belongs to
+the thread that drives the engine; the rest belong to pool workers. Tasks
+are pushed and popped from the back of the owner's queue and stolen
+from the front of other queues. A thread that waits for a group of tasks
+to finish keeps running tasks itself, so nested parallel entities
+cannot deadlock the pool.
+
+While any thread is running a task, structural changes to the
+entity tree are not applied directly. They are queued as commands on
+the queue of the thread that made them, and replayed on the driving
+thread once the outermost group finishes.
+
+Threads with nothing to take sleep on a condition variable. They are
+woken when tasks are pushed, and a thread waiting on its group is also
+woken when the group's last task finishes.
+
+
+*/
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <cstdlib>
+
+class EntityStepScheduler {
+  public:
+
+    // Deferred entity tree changes made from within a parallel step.
+    struct Command {
+        enum class Type {
+            Attach,
+            Detach,
+            SetPriority,
+            Remove,
+            RemoveComponent
+        };
+        Type type;
+        Entity::ID target;
+        Entity::ID child;
+        Entity::Priority priority;
+        const Component * component;
+    };
+
+
+    // Steps every given entity and returns once all are done.
+    // The entities may be stepped at the same time and in any order.
+    static void StepAll(Entity ** ents, uint32_t count) {
+        if (count == 1) {
+            runStep(ents[0]);
+        } else {
+            Get().stepAll(ents, count);
+        }
+
+        // only the outermost group may safely touch the tree.
+        if (!parallelDepth)
+            ApplyDeferred();
+    }
+
+    // Returns whether the calling thread is currently inside a
+    // parallel step.
+    static bool InParallelStep() {
+        return parallelDepth;
+    }
+
+    static void Defer(const Command & c) {
+        WorkQueue & own = *Get().queues[queueIndex];
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.commands.push_back(c);
+    }
+
+    // For calls that cannot be made from a parallel step but can be 
+    // skipped: reports the call and returns true if it must be refused.
+    static bool Refuse(const char * what) {
+        if (!parallelDepth) return false;
+        Dynacoe::Console::Error() << what << " was called from within a parallel Step() and was ignored.\n";
+        return true;
+    }
+
+    // For calls that cannot be made from a parallel step nor undone, 
+    // such as creating entities: racing would corrupt shared state, 
+    // so this stops the program, in release builds too.
+    static void CheckNotParallel(const char * what) {
+        if (!parallelDepth) return;
+        std::cerr << "Dynacoe: " << what << " was called from within a parallel Step(), which is not thread-safe.\n";
+        std::abort();
+    }
+
+
+  private:
+    struct Task {
+        Entity * ent;
+        std::atomic<uint32_t> * pending;
+    };
+
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<Task> tasks;
+        std::vector<Command> commands; // deferred by this queue's thread
+    };
+
+    EntityStepScheduler() {
+        uint32_t workerCount = std::thread::hardware_concurrency();
+        if (workerCount > 1) workerCount--;
+        if (!workerCount)    workerCount = 1;
+
+        // settled before any worker can ask for the time.
+        Dynacoe::Time::NsSinceStartup();
+
+        queued = 0;
+        queues.push_back(new WorkQueue);
+        for(uint32_t i = 0; i < workerCount; ++i) {
+            queues.push_back(new WorkQueue);
+        }
+
+        // The pool lives as long as the process does.
+        for(uint32_t i = 0; i < workerCount; ++i) {
+            std::thread(&EntityStepScheduler::workerMain, this, i+1).detach();
+        }
+    }
+
+    static EntityStepScheduler & Get() {
+        static EntityStepScheduler * scheduler = new EntityStepScheduler;
+        return *scheduler;
+    }
+
+
+    static void runStep(Entity * ent) {
+        parallelDepth++;
+        ent->Step();
+        parallelDepth--;
+    }
+
+    static void ApplyDeferred() {
+        std::vector<Command> pending;
+        EntityStepScheduler & scheduler = Get();
+        for(size_t i = 0; i < scheduler.queues.size(); ++i) {
+            WorkQueue & queue = *scheduler.queues[i];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            pending.insert(pending.end(), queue.commands.begin(), queue.commands.end());
+            queue.commands.clear();
+        }
+
+        Entity * target;
+        for(size_t i = 0; i < pending.size(); ++i) {
+            target = pending[i].target.Identify();
+            if (!target) continue;
+            switch(pending[i].type) {
+              case Command::Type::Attach:      target->Attach(pending[i].child); break;
+              case Command::Type::Detach:      target->Detach(pending[i].child); break;
+              case Command::Type::SetPriority: target->SetPriority(pending[i].priority); break;
+              case Command::Type::Remove:      target->Remove(); break;
+              case Command::Type::RemoveComponent: target->RemoveComponent(pending[i].component); break;
+            }
+        }
+    }
+
+
+
+    void stepAll(Entity ** ents, uint32_t count) {
+        std::atomic<uint32_t> pending(count);
+        WorkQueue & own = *queues[queueIndex];
+        {
+            std::lock_guard<std::mutex> guard(own.lock);
+            for(uint32_t i = 0; i < count; ++i) {
+                own.tasks.push_back({ents[i], &pending});
+            }
+            queued += count;
+        }
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+        }
+        wake.notify_all();
+
+
+        // help out until the whole group is done, sleeping 
+        // while the last of it runs elsewhere.
+        Task task;
+        while(pending) {
+            if (take(task)) {
+                run(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wake.wait(guard, [this, &pending]{return !pending || queued > 0;});
+        }
+    }
+
+
+    void workerMain(uint32_t index) {
+        queueIndex = index;
+        Task task;
+        while(true) {
+            if (take(task)) {
+                run(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wake.wait(guard, [this]{return queued > 0;});
+        }
+    }
+
+
+    void run(const Task & task) {
+        runStep(task.ent);
+        // the group's owner may be asleep waiting for this.
+        if (!--(*task.pending)) {
+            {
+                std::lock_guard<std::mutex> guard(sleepLock);
+            }
+            wake.notify_all();
+        }
+    }
+
+
+    // Pops from the back of this thread's queue, or steals from the
+    // front of another's.
+    bool take(Task & out) {
+        if (!queued) return false;
+        {
+            WorkQueue & own = *queues[queueIndex];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.tasks.empty()) {
+                out = own.tasks.back();
+                own.tasks.pop_back();
+                queued--;
+                return true;
+            }
+        }
+
+        for(size_t i = 1; i < queues.size(); ++i) {
+            WorkQueue & victim = *queues[(queueIndex + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                out = victim.tasks.front();
+                victim.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    std::vector<WorkQueue*> queues;
+    std::atomic<uint32_t> queued;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+
+    static thread_local uint32_t queueIndex;
+    static thread_local uint32_t parallelDepth;
+};
+
+thread_local uint32_t EntityStepScheduler::queueIndex = 0;
+thread_local uint32_t EntityStepScheduler::parallelDepth = 0;
+
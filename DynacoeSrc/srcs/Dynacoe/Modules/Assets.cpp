@@ -36,6 +36,7 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Dynacoe.h>
 #include <Dynacoe/Util/Filesys.h>
 #include <Dynacoe/Util/Iobuffer.h>
+#include <Dynacoe/Util/MemoryStats.h>
 #include <Dynacoe/Modules/Sound.h>
 #include <vorbis/vorbisfile.h>
 #include <Dynacoe/Modules/Graphics.h>
@@ -236,6 +237,7 @@ bool Assets::Remove(AssetID id) {
     assetMap[id.type].erase(assetList[id.type][id.handle]->GetAssetName());
     delete assetList[id.type][id.handle];
     assetList[id.type][id.handle] = NULL;
+    MemoryStats::Track(MemoryStats::Category::Assets, 0, -1);
 
 
     deadList[id.type].push(id.handle);
@@ -271,6 +273,7 @@ AssetID Assets::storeGen(const string & path, Asset * asset, Assets::Type type)
         Console::Error()<<("[Dynacoe::Assets]: Cannot add asset! Invalid data.")<< Console::End;
         return AssetID();
     }
+    MemoryStats::Track(MemoryStats::Category::Assets, 0, 1);
 
 
     // First, use a known empty slot if any
@@ -48,12 +48,21 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Interpreter.h>
 #include <Dynacoe/Modules/Debugger.h>
 #include <Dynacoe/BuiltIn/DataGrid.h>
+#include <Dynacoe/Util/MemoryStats.h>
+#include <Dynacoe/Util/SlowestEntities.h>
 #include <cmath>
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <chrono>
 
 
 using namespace Dynacoe;
 
+#include "Console_LogRing.hpp"
+
 // Console::System << "System message" << Console::End;
 // Console << "Normal message" << Console::End;
 // Console::Info << "Info Message" << Console::End;
@@ -459,7 +468,6 @@ bool                 Console::inputActive = false;
 uint32_t             Console::viewOffsetY = 0;
 
 std::vector<std::pair<std::string, ConsoleStream::MessageType>> Console::stream;
-ConsoleStream::MessageType ConsoleStream::type;
 
 const char * Console::End = "\n";
 
@@ -592,46 +600,145 @@ Console::MessageMode Console::GetOverlayMessageMode() {
     return messageMode;
 }
 
-ConsoleStream::ConsoleStream(FinishedCallback cb) {
+
+// Each thread keeps the buffers its streams format into, 
+// so building messages does not allocate once they have grown.
+namespace {
+struct StreamBuffers {
+    std::vector<std::string*> free;
+
+    std::string * Take() {
+        if (free.empty()) {
+            std::string * out = new std::string;
+            out->reserve(256);
+            return out;
+        }
+        std::string * out = free.back();
+        free.pop_back();
+        return out;
+    }
+
+    void Give(std::string * str) {
+        // don't hang on to the odd huge message
+        if (str->capacity() > 1 << 16) {
+            delete str;
+            return;
+        }
+        str->clear();
+        free.push_back(str);
+    }
+
+    ~StreamBuffers() {
+        for(size_t i = 0; i < free.size(); ++i) {
+            delete free[i];
+        }
+    }
+};
+thread_local StreamBuffers streamBuffers;
+
+std::atomic<int> minimumLevel((int)ConsoleStream::MessageType::Normal);
+}
+
+
+
+ConsoleRateLimit::ConsoleRateLimit(uint32_t maxPerSecond) :
+    limit(maxPerSecond),
+    windowStart(0),
+    count(0),
+    held(0) {
+}
+
+bool ConsoleRateLimit::Allow(uint32_t & suppressed) {
+    uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+
+    uint64_t start = windowStart.load(std::memory_order_relaxed);
+    if (now - start >= 1000000000ull &&
+        windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+        count.store(0, std::memory_order_relaxed);
+    }
+
+    if (count.fetch_add(1, std::memory_order_relaxed) < limit) {
+        suppressed = held.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+    held.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+
+
+
+ConsoleStream::ConsoleStream(FinishedCallback cb, MessageType t) {
     finish = cb;
-    str = "";
+    type = t;
+    str = nullptr;
+    limited = false;
+    updateActive();
 }
 
 ConsoleStream::~ConsoleStream() {
-    if (finish) {
-        finish(str, type);
+    if (!str) return;
+    if (active && !str->empty()) {
+        finish(*str, type);
     }
+    streamBuffers.Give(str);
 }
 
 
+// copies start out empty; the original still outputs what it has.
 ConsoleStream::ConsoleStream(const ConsoleStream & other) {
+    str = nullptr;
     *this = other;
 }
 
 ConsoleStream & ConsoleStream::operator=(const ConsoleStream & other) {
-    str = "";
+    if (str) str->clear();
     finish = other.finish;
     type = other.type;
+    limited = other.limited;
+    active = other.active;
     return *this;
 }
 
+void ConsoleStream::updateActive() {
+    active = finish && !limited && (int)type >= minimumLevel.load(std::memory_order_relaxed);
+}
+
+bool ConsoleStream::IsActive() const {
+    return active;
+}
 
 
-ConsoleStream ConsoleStream::operator<<(const Chain & s) {
-    ConsoleStream out(finish);
-    out.str = str+s.ToString();
-    str = "";
 
-    return out;
+ConsoleStream & ConsoleStream::operator<<(const Chain & s) {
+    if (!active) return *this;
+    if (!str) str = streamBuffers.Take();
+    *str += s.ToString();
+    return *this;
 }
 
 
-ConsoleStream  ConsoleStream::operator<<(MessageType t) {
+ConsoleStream & ConsoleStream::operator<<(MessageType t) {
     type = t;
+    updateActive();
     return *this;
 }
 
-
+ConsoleStream & ConsoleStream::operator<<(ConsoleRateLimit & site) {
+    if (!active) return *this;
+    uint32_t suppressed;
+    if (!site.Allow(suppressed)) {
+        limited = true;
+        active = false;
+        return *this;
+    }
+    if (suppressed) {
+        *this << (Chain() << "(" << suppressed << " similar messages were suppressed) ");
+    }
+    return *this;
+}
 
 
 
@@ -639,20 +746,28 @@ ConsoleStream  ConsoleStream::operator<<(MessageType t) {
 
 ConsoleStream  Console::System() {
     //return *this << system_color_c;
-    return ConsoleStream(AcquireStreamOutput) << ConsoleStream::MessageType::Normal;
+    return ConsoleStream(AcquireStreamOutput, ConsoleStream::MessageType::Normal);
 }
 ConsoleStream  Console::Info() {
     //return *this << info_color_c;
-    return ConsoleStream(AcquireStreamOutput) << ConsoleStream::MessageType::Normal;
+    return ConsoleStream(AcquireStreamOutput, ConsoleStream::MessageType::Normal);
 }
 // TODO: decide whether to show consoles on errors.
 ConsoleStream  Console::Error() {
     //return *this << error_color_c;
-    return ConsoleStream(AcquireStreamOutput) << ConsoleStream::MessageType::Fatal;
+    return ConsoleStream(AcquireStreamOutput, ConsoleStream::MessageType::Fatal);
 }
 ConsoleStream  Console::Warning() {
     //return *this << warn_color_c;
-    return ConsoleStream(AcquireStreamOutput) << ConsoleStream::MessageType::Warning;
+    return ConsoleStream(AcquireStreamOutput, ConsoleStream::MessageType::Warning);
+}
+
+void Console::SetMinimumLevel(ConsoleStream::MessageType t) {
+    minimumLevel = (int)t;
+}
+
+ConsoleStream::MessageType Console::GetMinimumLevel() {
+    return (ConsoleStream::MessageType)minimumLevel.load();
 }
 
 
@@ -830,25 +945,113 @@ void Console::AdjustViewSize() {
 }
 */
 
-// process expired ConsoleStream
+
+// Finished messages go through logRing to the sink thread, which writes 
+// them to stdout and the log file and queues them in Console::stream
+// for the main thread to show.
+namespace {
+struct LogSink {
+    LogSink() : ring(2048) {
+        file = nullptr;
+        reportedDrops = 0;
+        exiting = false;
+    }
+
+    ConsoleLogRing ring;
+    std::mutex drainLock;  // held by whoever is draining
+    std::mutex streamLock; // guards Console::stream
+    FILE * file;
+    uint64_t reportedDrops;
+    bool exiting;
+};
+
+LogSink & logSink() {
+    static LogSink * sink = new LogSink;
+    return *sink;
+}
+}
+
+
 void Console::AcquireStreamOutput(const std::string & str, ConsoleStream::MessageType type) {
-    // last stream type overrides previous, so the actual used color in the line model is from the
-    // streamType at the type a \n is inserted.
-    std::cout << str;
-    stream.push_back(
-        std::pair<std::string, ConsoleStream::MessageType>(str, type)
-    );
+    static bool started = [](){
+        // The sink thread lives as long as the process does.
+        std::thread([]() {
+            while(true) {
+                Console::Flush();
+                std::this_thread::sleep_for(std::chrono::milliseconds(4));
+            }
+        }).detach();
+        std::atexit([]() {
+            Console::Flush();
+            std::lock_guard<std::mutex> guard(logSink().drainLock);
+            logSink().exiting = true;
+        });
+        return true;
+    }();
+    (void)started;
+
+    logSink().ring.Push(str.c_str(), str.size(), (uint8_t)type);
+
+    // may be the last thing said before going down.
+    if (type == ConsoleStream::MessageType::Fatal)
+        Flush();
+}
+
+void Console::Flush() {
+    LogSink & sink = logSink();
+    std::lock_guard<std::mutex> guard(sink.drainLock);
+    if (sink.exiting) return;
+
+    std::string text;
+    uint8_t type;
+    bool any = false;
+    while(sink.ring.Pop(text, type)) {
+        fwrite(text.c_str(), 1, text.size(), stdout);
+        if (sink.file) fwrite(text.c_str(), 1, text.size(), sink.file);
+
+        std::lock_guard<std::mutex> streamGuard(sink.streamLock);
+        stream.push_back(
+            std::pair<std::string, ConsoleStream::MessageType>(text, (ConsoleStream::MessageType)type)
+        );
+        any = true;
+    }
 
-    if (!shown && str.size())
-        PostMessageConsole(str, type);
+    uint64_t dropped = sink.ring.GetDropped();
+    if (dropped != sink.reportedDrops) {
+        fprintf(stdout, "[Dynacoe::Console]: %llu messages were dropped (too many at once)\n", (unsigned long long)(dropped - sink.reportedDrops));
+        sink.reportedDrops = dropped;
+        any = true;
+    }
+
+    if (any) {
+        fflush(stdout);
+        if (sink.file) fflush(sink.file);
+    }
+}
 
+bool Console::SetLogFile(const std::string & path) {
+    LogSink & sink = logSink();
+    std::lock_guard<std::mutex> guard(sink.drainLock);
+    if (sink.file) {
+        fclose(sink.file);
+        sink.file = nullptr;
+    }
+    if (path.empty()) return true;
+    sink.file = fopen(path.c_str(), "ab");
+    return sink.file != nullptr;
 }
 
 void Console::ProcessStreamOutput() {
-    for(uint32_t i = 0; i < stream.size(); ++i) {
-        ProcessStreamIteration(stream[i].first, stream[i].second);
+    std::vector<std::pair<std::string, ConsoleStream::MessageType>> pending;
+    {
+        std::lock_guard<std::mutex> guard(logSink().streamLock);
+        pending.swap(stream);
+    }
+    for(uint32_t i = 0; i < pending.size(); ++i) {
+        ProcessStreamIteration(pending[i].first, pending[i].second);
+        if (!shown && pending[i].first.size())
+            PostMessageConsole(pending[i].first, pending[i].second);
     }
-    stream.clear();
 }
 
 
@@ -1111,6 +1314,120 @@ class Command_BackendInput : public Interpreter::Command {
 };
 
 
+class Command_Memory : public Interpreter::Command {
+  public:
+
+    std::string operator()(const std::vector<std::string> & argvec) {
+        if (argvec.size() == 2 && argvec[1] == "reset") {
+            MemoryStats::ResetPeaks();
+            return "Peaks reset.\n";
+        }
+
+        if (argvec.size() == 4 && argvec[1] == "budget") {
+            MemoryStats::Category category;
+            if (!findCategory(argvec[2], category)) {
+                return "Error: " + argvec[2] + " is not a category number or name\n";
+            }
+            if (argvec[3].empty() || argvec[3].find_first_not_of("0123456789") != std::string::npos) {
+                return "Error: " + argvec[3] + " is not a number of bytes\n";
+            }
+            uint64_t bytes = strtoull(argvec[3].c_str(), nullptr, 10);
+            MemoryStats::SetBudget(category, bytes);
+            return std::string("Budget for ") + MemoryStats::GetName(category) + " set.\n";
+        }
+
+        if (argvec.size() != 1) {
+            return "Usage: memory [reset | budget category bytes]\n";
+        }
+
+        std::string out;
+        for(int i = 0; i < MemoryStats::CategoryCount; ++i) {
+            MemoryStats::Category category = (MemoryStats::Category)i;
+            MemoryStats::Usage usage = MemoryStats::Get(category);
+            out += Chain() << i << ". " << MemoryStats::GetName(category) << ": "
+                           << usage.liveBytes << " bytes live, "
+                           << usage.peakBytes << " peak, "
+                           << usage.count << " held";
+            if (usage.budgetBytes) {
+                out += Chain() << ", budget " << usage.budgetBytes
+                               << (MemoryStats::IsOverBudget(category) ? " (OVER)" : "");
+            }
+            out += "\n";
+        }
+        out += Chain() << "Total: " << MemoryStats::GetTotalLive() << " bytes live\n";
+        return out;
+    }
+    std::string Help() const {
+        return "Prints the memory held by each part of the engine. \"memory reset\" resets the peaks, and \"memory budget [category] [bytes]\" sets a category's budget (0 for none). The category is its number or its name without spaces.";
+    }
+
+  private:
+    // Accepts a category's number as listed, or its name ignoring 
+    // case and spaces.
+    static bool findCategory(const std::string & in, MemoryStats::Category & out) {
+        if (in.empty()) return false;
+        if (in.find_first_not_of("0123456789") == std::string::npos) {
+            uint32_t i = Chain(in).AsUInt32();
+            if (in.size() > 3 || i >= MemoryStats::CategoryCount) return false;
+            out = (MemoryStats::Category)i;
+            return true;
+        }
+
+        for(int i = 0; i < MemoryStats::CategoryCount; ++i) {
+            std::string name;
+            for(const char * c = MemoryStats::GetName((MemoryStats::Category)i); *c; ++c) {
+                if (*c != ' ') name += tolower(*c);
+            }
+            std::string given;
+            for(size_t n = 0; n < in.size(); ++n) {
+                if (in[n] != ' ') given += tolower(in[n]);
+            }
+            if (name == given) {
+                out = (MemoryStats::Category)i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+};
+
+
+class Command_Slowest : public Interpreter::Command {
+  public:
+
+    std::string operator()(const std::vector<std::string> & argvec) {
+        if (argvec.size() > 2) return "Usage: slowest [id | all]\n";
+        if (argvec.size() == 2) {
+            if (argvec[1] == "all") {
+                SlowestEntities::SetSubtree(Entity::ID());
+                return "Listing entities from anywhere.\n";
+            }
+            Entity::ID id(argvec[1]);
+            if (!id.Valid()) return "Error: " + argvec[1] + " does not refer to an existing entity\n";
+            SlowestEntities::SetSubtree(id);
+            return "Listing entities within " + id.Identify()->GetName() + " only.\n";
+        }
+
+        if (!SlowestEntities::IsEnabled()) return "The Debugger must be open to track the slowest entities.\n";
+        std::vector<SlowestEntities::Entry> slowest = SlowestEntities::Get();
+        std::string out;
+        for(size_t i = 0; i < slowest.size(); ++i) {
+            Entity * ent = slowest[i].id.Identify();
+            if (!ent) continue;
+            out += Chain() << slowest[i].id.String() << " " << ent->GetName() << ": "
+                           << slowest[i].stepMS << "ms step, "
+                           << slowest[i].drawMS << "ms draw\n";
+        }
+        return out;
+    }
+    std::string Help() const {
+        return "Prints the slowest entities as tracked while the Debugger is open. \"slowest [id]\" only tracks the given entity and those below it; \"slowest all\" tracks every entity again.";
+    }
+
+};
+
+
 class EntityModCommand : public Interpreter::Command {
 
   public:
@@ -1131,17 +1448,17 @@ class EntityModCommand : public Interpreter::Command {
 
 
 
-        uint32_t id;
-        if (sscanf(ent.c_str(), "[%u]", &id)) {
+        unsigned long long id;
+        if (sscanf(ent.c_str(), "[%llu]", &id)) {
 
             if (!property.size()) {
                 return std::string("Missing property for object ID ") + ent;
             }
 
 
-            Entity * e = Entity::ID(id).Identify();
+            Entity * e = Entity::ID((uint64_t)id).Identify();
             if (!e) {
-                Console::Info() << "No entity with ID " << (int) id << "\n";
+                Console::Info() << "No entity with ID " << std::to_string(id) << "\n";
                 return "";
             }
 
@@ -1151,6 +1468,8 @@ class EntityModCommand : public Interpreter::Command {
 
             if (newValue.size()) {
                 var.Set(newValue);
+                // the variable may have been step / draw
+                e->RefreshActiveState();
             }
 
 
@@ -1180,7 +1499,7 @@ class EntityModCommand : public Interpreter::Command {
             // If no property, just print the IDs of all found ents
             if (!property.size()) {
                 for(int i = 0; i < ents.size(); ++i) {
-                    out += (Chain() << "[" << (int)ents[i].Value() << "]\n");
+                    out += (Chain() << "[" << std::to_string(ents[i].Value()) << "]\n");
                 }
                 return out;
             }
@@ -1189,7 +1508,7 @@ class EntityModCommand : public Interpreter::Command {
             std::vector<std::string> argSub(argvec.begin(), argvec.end());
 
             for(int i = 0; i < ents.size(); ++i) {
-                argSub[1] = (Chain() << "[" << (int)ents[i].Value() << "]." << property);
+                argSub[1] = (Chain() << "[" << std::to_string(ents[i].Value()) << "]." << property);
                 out += (*this)(argSub) + '\n';
             }
 
@@ -1266,6 +1585,8 @@ void Console::AddDefaultCommands() {
     interp->AddCommand("print",   new Command_Print);
     interp->AddCommand("mod",     new EntityModCommand);
     interp->AddCommand("view-id", new Command_ViewID);
+    interp->AddCommand("memory",  new Command_Memory);
+    interp->AddCommand("slowest", new Command_Slowest);
     
     interp->AddCommand("renderer",    new Command_BackendRenderer);
     interp->AddCommand("audio",       new Command_BackendAudio);
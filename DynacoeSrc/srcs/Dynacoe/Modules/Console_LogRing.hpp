@@ -0,0 +1,133 @@
+/*
+
+Bounded lock-free queue of finished console messages.
+
+Any number of threads may push; one thread at a time pops. Messages
+are copied into fixed-size cells, so pushing never allocates, locks or
+waits: if there is no room, the message is dropped and counted instead.
+A message longer than one cell takes a run of neighbouring cells, which
+are claimed together so that messages from different threads never
+interleave.
+
+Each cell carries a sequence number telling whose turn it is. Position
+p is free for a producer when the cell's sequence is p, ready for the
+consumer once it is p+1, and free again a lap later once the consumer
+sets it to p + the cell count.
+
+
+*/
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <cstring>
+
+class ConsoleLogRing {
+  public:
+    static const uint32_t cell_text_c = 240;
+
+    // cellCount must be a power of 2.
+    ConsoleLogRing(uint32_t cellCount) {
+        count = cellCount;
+        mask = cellCount-1;
+        cells = new Cell[cellCount];
+        for(uint32_t i = 0; i < cellCount; ++i) {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+        head = 0;
+        tail = 0;
+        dropped = 0;
+    }
+
+    ~ConsoleLogRing() {
+        delete[] cells;
+    }
+
+
+    // Copies the message in. Returns false if it was dropped.
+    bool Push(const char * text, size_t length, uint8_t type) {
+        // very long messages are cut down to a quarter of the ring.
+        size_t maxLength = (count/4)*cell_text_c;
+        if (length > maxLength) length = maxLength;
+        uint64_t n = length ? (length + cell_text_c - 1) / cell_text_c : 1;
+
+
+        // claim n cells. Only the last needs checking: cells are freed
+        // in order, so if it is free, the ones before it are too.
+        uint64_t pos = head.load(std::memory_order_relaxed);
+        while(true) {
+            Cell & last = cells[(pos+n-1) & mask];
+            int64_t diff = (int64_t)last.seq.load(std::memory_order_acquire) - (int64_t)(pos+n-1);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos+n, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+
+
+        for(uint64_t i = 0; i < n; ++i) {
+            Cell & cell = cells[(pos+i) & mask];
+            size_t part = length > cell_text_c ? cell_text_c : length;
+            memcpy(cell.text, text, part);
+            cell.length = part;
+            cell.type = type;
+            cell.more = (i+1 < n);
+            text += part;
+            length -= part;
+            cell.seq.store(pos+i+1, std::memory_order_release);
+        }
+        return true;
+    }
+
+
+    // Takes the oldest message, if any. Only one thread may pop at a time.
+    bool Pop(std::string & text, uint8_t & type) {
+        Cell * cell = &cells[tail & mask];
+        if (cell->seq.load(std::memory_order_acquire) != tail+1) return false;
+
+        text.clear();
+        type = cell->type;
+        while(true) {
+            text.append(cell->text, cell->length);
+            bool more = cell->more;
+            cell->seq.store(tail+count, std::memory_order_release);
+            tail++;
+            if (!more) break;
+
+            // the rest was claimed with it and is being written.
+            cell = &cells[tail & mask];
+            while(cell->seq.load(std::memory_order_acquire) != tail+1) {
+                std::this_thread::yield();
+            }
+        }
+        return true;
+    }
+
+    // Number of messages dropped for lack of room so far.
+    uint64_t GetDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+
+  private:
+    struct Cell {
+        std::atomic<uint64_t> seq;
+        uint16_t length;
+        uint8_t  type;
+        bool     more; // continues in the next cell
+        char     text[cell_text_c];
+    };
+
+    Cell * cells;
+    uint64_t count;
+    uint64_t mask;
+
+    std::atomic<uint64_t> head;
+    uint64_t tail; // consumer only
+    std::atomic<uint64_t> dropped;
+};
@@ -38,6 +38,9 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/BuiltIn/DataGrid.h>
 #include <Dynacoe/Util/Math.h>
 #include <Dynacoe/Util/Time.h>
+#include <Dynacoe/Util/Profiler.h>
+#include <Dynacoe/Util/MemoryStats.h>
+#include <Dynacoe/Util/SlowestEntities.h>
 
 
 #include <Dynacoe/BuiltIn/InputBox.h>
@@ -785,7 +788,7 @@ void DebugWindow::OnStep() {
 
 
 
-const int slowestCount = 40;
+const uint32_t slowestCount = 40;
 
 
 static std::vector<Entity::ID> slowestIDs;
@@ -821,20 +824,22 @@ static std::vector<Entity::ID> GuessByName(const std::string & name, int max) {
 
     std::string nonCase = lowerString(name);
 
-    // for each world, gather all ents and check name.
-
-    std::vector<Entity::ID> all = Entity::GetAll();
-    Entity * curEnt;
-    for(uint32_t i = 0; i < all.size() && (results.size() < max); ++i) {
-        curEnt = all[i].Identify();
-
-        if (!curEnt) continue;
+    // Entity names are interned and only ever added, so the lowercase 
+    // versions only need to be made once per distinct name.
+    static std::vector<std::string> lowerNames;
+    const std::vector<std::string> & known = Entity::GetKnownNames();
+    for(size_t i = lowerNames.size(); i < known.size(); ++i) {
+        lowerNames.push_back(lowerString(known[i]));
+    }
 
+    for(uint32_t i = 0; i < lowerNames.size() && (results.size() < max); ++i) {
         // if substring matches non-case sensitively, it's a match
-        if (strstr(lowerString(curEnt->GetName()).c_str(), nonCase.c_str())) {
-            results.push_back(curEnt->GetID());
-        }
+        if (!strstr(lowerNames[i].c_str(), nonCase.c_str())) continue;
 
+        std::vector<Entity::ID> named = Entity::FindByName(known[i]);
+        for(uint32_t n = 0; n < named.size() && (results.size() < max); ++n) {
+            results.push_back(named[n]);
+        }
     }
     return results;
 
@@ -1043,15 +1048,17 @@ class DebuggerBase : public Entity {
     Entity * overview;
     Entity * entity;
     Entity * vars;
+    Entity * memory;
 
-    const int width = 150;
+    const int width = 200;
     const float slide_duration_s = .2f;
 
 
     enum class Page {
         Overview,
         Entity,
-        Vars
+        Vars,
+        Memory
     };
 
     std::vector<Entity::ID> overviewIDs;
@@ -1085,10 +1092,13 @@ class DebuggerBase : public Entity {
         entity->step = false;
         vars->draw = false;
         vars->step = false;
+        memory->draw = false;
+        memory->step = false;
 
         overviewText->SetTextColor("#A0A0A0");
         entityText->SetTextColor("#A0A0A0");
         varsText->SetTextColor("#A0A0A0");
+        memText->SetTextColor("#A0A0A0");
         
         mouseXY = AddComponent<Text2D>();
 
@@ -1108,6 +1118,12 @@ class DebuggerBase : public Entity {
             vars->step = true;
             varsText->SetTextColor("#AAFFAA");
             break;
+          case Page::Memory:
+            memory->draw = true;
+            memory->step = true;
+            memText->SetTextColor("#AAFFAA");
+            UpdateCycle();
+            break;
 
         }
     }
@@ -1138,6 +1154,7 @@ class DebuggerBase : public Entity {
         CreateOverviewPage();
         CreateEntityPage();
         CreateVarsPage();
+        CreateMemoryPage();
         CreateBase();
 
         SwitchPage(Page::Overview);
@@ -1147,6 +1164,7 @@ class DebuggerBase : public Entity {
         bg->color.a = .6f;
 
         show = false;
+        profilerWasEnabled = false;
         draw = show;
         step = show;
 
@@ -1167,8 +1185,17 @@ class DebuggerBase : public Entity {
             step = true;
             draw = true;
             state->Execute("slide-in");
+
+            // the timings shown come from the profiler.
+            profilerWasEnabled = Profiler::IsEnabled();
+            Profiler::SetEnabled(true);
+            Profiler::ResetTotals();
+            SlowestEntities::SetCount(slowestCount);
+            SlowestEntities::SetEnabled(true);
         } else {
             state->Execute("slide-out");
+            Profiler::SetEnabled(profilerWasEnabled);
+            SlowestEntities::SetEnabled(false);
         }
         UpdateCycle();
     }
@@ -1188,10 +1215,12 @@ class DebuggerBase : public Entity {
     GUI * overviewButton;
     GUI * entityButton;
     GUI * varsButton;
+    GUI * memButton;
 
     Text2D * overviewText;
     Text2D * entityText;
     Text2D * varsText;
+    Text2D * memText;
     static DynacoeEvent(ButtonClickEvent) {
         DebuggerBase * base = self.IdentifyAs<DebuggerBase>();
 
@@ -1201,6 +1230,8 @@ class DebuggerBase : public Entity {
             base->SwitchPage(Page::Overview);
         } else if (component == base->entityButton) {
             base->SwitchPage(Page::Entity);
+        } else if (component == base->memButton) {
+            base->SwitchPage(Page::Memory);
         } else {
             base->SwitchPage(Page::Vars);
         }
@@ -1236,20 +1267,24 @@ class DebuggerBase : public Entity {
         overviewText = buttons->AddComponent<Text2D>();
         entityText = buttons->AddComponent<Text2D>();
         varsText = buttons->AddComponent<Text2D>();
+        memText = buttons->AddComponent<Text2D>();
         Shape2D * h = buttons->AddComponent<Shape2D>();
         
         overviewButton = AddComponent<GUI>();
         entityButton = AddComponent<GUI>();
         varsButton = AddComponent<GUI>();
+        memButton = AddComponent<GUI>();
         
         
         overviewText->SetTextColor("#A0A0A0");
         entityText->SetTextColor("#A0A0A0");
         varsText->SetTextColor("#A0A0A0");
+        memText->SetTextColor("#A0A0A0");
 
         overviewText->text = "Perf";
         entityText->text = "Entity";
         varsText->text = "Vars";
+        memText->text = "Mem";
 
 
         h->FormRectangle(50, 1);
@@ -1258,6 +1293,7 @@ class DebuggerBase : public Entity {
         overviewText->Node().Position() = {0, 0};
         entityText->Node().Position()   = {49, 0};
         varsText->Node().Position()     = {99, 0};
+        memText->Node().Position()      = {149, 0};
 
 
         hover = h;
@@ -1269,10 +1305,12 @@ class DebuggerBase : public Entity {
         overviewButton->DefineRegion(50, 20);
         entityButton->  DefineRegion(50, 20);
         varsButton->    DefineRegion(50, 20);
+        memButton->     DefineRegion(50, 20);
 
         overviewButton->Node().Position() = {0, 0};
         entityButton->Node().Position() = {50, 0};
         varsButton->Node().Position() = {100, 0};
+        memButton->Node().Position() = {150, 0};
 
         overviewButton->InstallHandler("on-click", ButtonClickEvent);
         overviewButton->InstallHandler("on-enter", ButtonEnterEvent);
@@ -1286,6 +1324,10 @@ class DebuggerBase : public Entity {
         varsButton->InstallHandler("on-enter", ButtonEnterEvent);
         varsButton->InstallHandler("on-leave", ButtonLeaveEvent);
 
+        memButton->InstallHandler("on-click", ButtonClickEvent);
+        memButton->InstallHandler("on-enter", ButtonEnterEvent);
+        memButton->InstallHandler("on-leave", ButtonLeaveEvent);
+
 
 
     }
@@ -1312,13 +1354,13 @@ class DebuggerBase : public Entity {
 
         table = overview->CreateChild<DataGrid>();
         table->Node().Position() = {0, 100};
-        for(int i = 0; i < slowestCount; ++i)
+        for(uint32_t i = 0; i < slowestCount; ++i)
             table->AddRow();
 
         table->clickCallback = (click_row_time);
 
         table->AddColumn("Time", 36);
-        table->AddColumn("Name", 114);
+        table->AddColumn("Name", width - 36);
         table->SetRowsVisible(14);
 
     }
@@ -1350,57 +1392,116 @@ class DebuggerBase : public Entity {
     }
 
 
+    DataGrid * memoryTable;
+    void CreateMemoryPage() {
+        memory = CreateChild<Entity>();
+        memory->Node().Position() = {0, 20};
+
+        memoryTable = memory->CreateChild<DataGrid>();
+        memoryTable->AddColumn("Category", 80);
+        memoryTable->AddColumn("Live", 45);
+        memoryTable->AddColumn("Peak", 45);
+        memoryTable->AddColumn("Count", width - 170);
+        memoryTable->SetRowsVisible(MemoryStats::CategoryCount + 1);
+        for(int i = 0; i < MemoryStats::CategoryCount + 1; ++i) {
+            memoryTable->AddRow();
+        }
+    }
+
+    // Shortens a byte count, i.e. 1536 -> "1.5K"
+    static std::string FormatBytes(uint64_t bytes) {
+        const char * suffix[] = {"B", "K", "M", "G"};
+        double value = bytes;
+        int i = 0;
+        while(value >= 1024 && i < 3) {
+            value /= 1024;
+            i++;
+        }
+        char out[32];
+        snprintf(out, 32, i ? "%.1f%s" : "%.0f%s", value, suffix[i]);
+        return out;
+    }
+
+
     void UpdateCycle() {
         Entity * w = nullptr;
 
 
 
-        lastDrawTime = Engine::GetDiagnostics().drawTimeMS;
-        lastRunTime =  Engine::GetDiagnostics().stepTimeMS;
-        lastSysTime =  Engine::GetDiagnostics().systemTimeMS;
-        lastDebugTime =Engine::GetDiagnostics().engineRealTimeMS - (lastDrawTime + lastRunTime + lastSysTime);
+        // per-frame averages since the last update
+        lastDrawTime = Profiler::GetAverageMS("Engine", "Draw");
+        lastRunTime =  Profiler::GetAverageMS("Engine", "Step");
+        lastSysTime =  Profiler::GetAverageMS("Engine", "Modules");
+        lastDebugTime =Profiler::GetAverageMS("Engine", "Frame") - (lastDrawTime + lastRunTime + lastSysTime);
+        if (lastDebugTime < 0) lastDebugTime = 0;
+        Profiler::ResetTotals();
 
 
         // record the top offenders of time cost
 
+        // (kept up to date by SlowestEntities as entities finish, 
+        // so this does not grow with the number of entities)
         if (overview->draw) {
             table->Clear();
-            std::vector<Entity::ID> ids = Entity::GetAll();
             overviewIDs.clear();
-            std::map<double, Entity::ID, std::greater<double>> times;
-
             slowestTimes.clear();
             slowestIDs.clear();
+
+            std::vector<SlowestEntities::Entry> slowest = SlowestEntities::Get();
             double timeTotal;
             Entity * cur;
-            for(int i = 0; i < ids.size(); ++i) {
-                //assert(ids[i].Valid());
-                cur = ids[i].Identify();
-                if (!cur->IsStepping() && !cur->IsDrawing()) continue;
-                timeTotal = cur->StepDuration() + cur->DrawDuration();
-                if (timeTotal <= 0) continue;
-                times[timeTotal] = ids[i];
-            }
-            auto it = times.begin();
+            for(uint32_t i = 0; i < slowestCount && i < slowest.size(); i++) {
+                cur = slowest[i].id.Identify();
+                if (!cur) continue;
+                timeTotal = slowest[i].stepMS + slowest[i].drawMS;
 
-            for(int i = 0; i < slowestCount, it != times.end(); ++it, i++) {
                 table->AddRow();
-                overviewIDs.push_back(it->second);
-                slowestTimes.push_back(it->first);
-                slowestIDs.  push_back(it->second);
-                table->Get(0, i) = (Chain() << (int) ((it->first / (lastDrawTime+lastRunTime))*100) << "%");
-
-                if (it->second.Identify()) {
-                    table->Get(1, i) = it->second.Identify()->GetName();
-
-                    table->GetTooltip(i) = Chain() <<
-                        "Entity Info:\n"
-                        "ID:       " << it->second.String() << "\n"
-                        "Position: " << it->second.Identify()->Node().GetPosition()
-                    ;
-                }
+                uint32_t row = overviewIDs.size();
+                overviewIDs.push_back(slowest[i].id);
+                slowestTimes.push_back(timeTotal);
+                slowestIDs.  push_back(slowest[i].id);
+                table->Get(0, row) = (Chain() << (int) ((timeTotal / (lastDrawTime+lastRunTime))*100) << "%");
+                table->Get(1, row) = cur->GetName();
+
+                table->GetTooltip(row) = Chain() <<
+                    "Entity Info:\n"
+                    "ID:       " << slowest[i].id.String() << "\n"
+                    "Position: " << cur->Node().GetPosition() << "\n"
+                    "Step:     " << slowest[i].stepMS << "ms\n"
+                    "Draw:     " << slowest[i].drawMS << "ms"
+                ;
+            }
+        }
 
+        // memory held by each subsystem
+        if (memory->draw) {
+            memoryTable->Clear();
+            uint64_t live = 0, peak = 0, count = 0;
+            for(int i = 0; i < MemoryStats::CategoryCount; ++i) {
+                MemoryStats::Category category = (MemoryStats::Category)i;
+                MemoryStats::Usage usage = MemoryStats::Get(category);
+                memoryTable->AddRow();
+                memoryTable->Get(0, i) = MemoryStats::GetName(category);
+                memoryTable->Get(1, i) = FormatBytes(usage.liveBytes);
+                memoryTable->Get(2, i) = FormatBytes(usage.peakBytes);
+                memoryTable->Get(3, i) = (Chain() << usage.count);
+                memoryTable->GetTooltip(i) = Chain() <<
+                    MemoryStats::GetName(category) << ":\n"
+                    "Live:   " << usage.liveBytes << " bytes\n"
+                    "Peak:   " << usage.peakBytes << " bytes\n"
+                    "Budget: " << (usage.budgetBytes ? FormatBytes(usage.budgetBytes) : std::string("none"))
+                ;
+                if (MemoryStats::IsOverBudget(category))
+                    memoryTable->Get(1, i) = FormatBytes(usage.liveBytes) + "!";
+                live  += usage.liveBytes;
+                peak  += usage.peakBytes;
+                count += usage.count;
             }
+            memoryTable->AddRow();
+            memoryTable->Get(0, MemoryStats::CategoryCount) = "Total";
+            memoryTable->Get(1, MemoryStats::CategoryCount) = FormatBytes(live);
+            memoryTable->Get(2, MemoryStats::CategoryCount) = FormatBytes(peak);
+            memoryTable->Get(3, MemoryStats::CategoryCount) = (Chain() << count);
         }
 
         // if on the entity tab, search for the string given
@@ -1472,6 +1573,7 @@ class DebuggerBase : public Entity {
     DataGrid * table;
   private:
     bool show;
+    bool profilerWasEnabled;
 
 };
 
@@ -40,15 +40,19 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/FontAsset.h>
 #include <Dynacoe/Components/Shape2D.h>
 #include <Dynacoe/Util/Time.h>
+#include <Dynacoe/Util/Profiler.h>
 #include <Dynacoe/Dynacoe.h>
 #include <Dynacoe/Modules/ViewManager.h>
+#include <Dynacoe/Modules/Console.h>
 #include <Dynacoe/Components/Text2D.h>
 #include <unordered_map>
+#include <algorithm>
 
 #include <Dynacoe/Util/Chain.h>
 #include <Dynacoe/Util/Vector.h>
 #include <Dynacoe/Util/TransformMatrix.h>
 #include <Dynacoe/Util/Filesys.h>
+#include "Graphics_RenderPipeline.hpp"
 
 
 static const float DISPLAY_PIXEL_COORD_RATIO       =   1/(256.f);
@@ -78,6 +82,9 @@ AssetID             Graphics::lastDisplayID;
 
 
 
+// non-null while drawing is pipelined; then also the drawBuffer.
+static RenderPipeline * pipeline = nullptr;
+
 Graphics::GraphicsState     Graphics::state;
 Graphics::FontSpec          Graphics::defaultFontSpec;
 
@@ -240,15 +247,54 @@ void Graphics::RunAfter() {
 
 
 static Renderer::Render2DStaticParameters params2D;
+static Graphics::FrameStats frameStats;
+static Graphics::FrameStats lastFrameStats;
+// params2D only points at the matrix, so keep a copy that 
+// outlives changes to the camera's storage.
+static TransformMatrix contextTransform2D;
+
+
+// 2D draws are recorded here and only handed to the renderer when 
+// something needs them to have been drawn (see submit2D()). Each carries
+// a key built from the state it needs, so that draws sharing a state can
+// be sent together no matter how they were interleaved.
+struct Command2D {
+    uint64_t key;
+    uint32_t first; // into indices2D
+    uint32_t count;
+    const SpriteBatch2D * sprites; // drawn as a batch of sprites instead, if set
+};
+static std::vector<Command2D> commands2D;
+static std::vector<uint32_t>  indices2D;
+static bool sort2D = true;
+
+
+// From most to least significant: layer, blend, sprites, polygon. 
+// Sprite batches go after the vertices of their layer and blend.
+static uint64_t key2D(int layer, Renderer::AlphaRule a, Renderer::Polygon p, bool sprites = false) {
+    return ((uint64_t)((uint32_t)layer ^ 0x80000000u) << 32) |
+           ((uint64_t)a << 16) |
+           ((uint64_t)sprites << 8) |
+           ((uint64_t)p);
+}
+
+static Renderer::AlphaRule key2DAlpha(uint64_t key) {
+    return (Renderer::AlphaRule)((key >> 16) & 0xff);
+}
+
+static Renderer::Polygon key2DPolygon(uint64_t key) {
+    return (Renderer::Polygon)(key & 0xff);
+}
 
 
 void Graphics::UpdateCameraTransforms(Camera * c) {
     Camera * cam2D = &Graphics::GetCamera2D();
     if (cam2D == c) {
-        Graphics::GetRenderer()->Render2DVertices(params2D);
+        submit2D();
         params2D.contextWidth  = cam2D->Width();
         params2D.contextHeight = cam2D->Height();
-        params2D.contextTransform = cam2D->GetGlobalTransform().GetData();
+        contextTransform2D = cam2D->GetRenderTransform();
+        params2D.contextTransform = contextTransform2D.GetData();
     }
 }
 
@@ -259,35 +305,81 @@ void Graphics::Draw(Render2D & aspect) {
     Camera * cam2d = &GetCamera2D();
     if (!cam2d) return;
 
+    if (round(params2D.contextWidth) != cam2d->Width() ||
+        round(params2D.contextHeight) != cam2d->Height()) {
+        UpdateCameraTransforms(cam2d);
+    }
 
-    setDisplayMode(aspect.GetPolygon(),
-                   Renderer::Dimension::D_2D,
-                   aspect.mode == Render2D::RenderMode::Translucent ? Renderer::AlphaRule::Translucent : Renderer::AlphaRule::Allow);
+    const std::vector<uint32_t> & ids = aspect.GetVertexIDs();
+    if (!ids.size()) return;
+
+    Command2D command;
+    command.key = key2D(
+        aspect.layer,
+        aspect.mode == Render2D::RenderMode::Translucent ? Renderer::AlphaRule::Translucent : Renderer::AlphaRule::Allow,
+        aspect.GetPolygon()
+    );
+    command.first = indices2D.size();
+    command.count = ids.size();
+    command.sprites = nullptr;
+    indices2D.insert(indices2D.end(), ids.begin(), ids.end());
+    commands2D.push_back(command);
+
+    frameStats.objects2D++;
+    frameStats.vertices2D += ids.size();
+}
+
+void Graphics::Draw(SpriteBatch2D & batch) {
+    batch.CheckUpdate();
+
+    Camera * cam2d = &GetCamera2D();
+    if (!cam2d) return;
 
     if (round(params2D.contextWidth) != cam2d->Width() ||
         round(params2D.contextHeight) != cam2d->Height()) {
         UpdateCameraTransforms(cam2d);
     }
 
-    drawBuffer->Queue2DVertices(
-        &aspect.GetVertexIDs()[0],
-        aspect.GetVertexIDs().size()
+    if (!batch.Count()) return;
+
+    Command2D command;
+    command.key = key2D(
+        batch.layer,
+        batch.mode == Render2D::RenderMode::Translucent ? Renderer::AlphaRule::Translucent : Renderer::AlphaRule::Allow,
+        Renderer::Polygon::Triangle,
+        true
     );
+    command.first = 0;
+    command.count = 0;
+    command.sprites = &batch;
+    commands2D.push_back(command);
 
+    frameStats.objects2D++;
+    frameStats.vertices2D += batch.Count()*6;
+}
 
+void Graphics::forgetSprites2D(const SpriteBatch2D * batch) {
+    commands2D.erase(
+        std::remove_if(commands2D.begin(), commands2D.end(), [batch](const Command2D & c) {
+            return c.sprites == batch;
+        }),
+        commands2D.end()
+    );
 }
 
 
 void Graphics::Draw(RenderMesh & aspect) {
 
-    // flush out any queued dynamic actions
+    // 2D drawn so far goes under the mesh only when kept in order.
+    if (!sort2D)
+        submit2D();
+
     setDisplayMode(aspect.GetRenderPrimitive(),
                    Renderer::Dimension::D_3D,
                    Renderer::AlphaRule::Allow);
 
-    drawBuffer->Render2DVertices(params2D);
-
     aspect.RenderSelf(drawBuffer);
+    frameStats.meshes++;
 
     // if applicable, recursively draw children
     /*
@@ -303,10 +395,51 @@ void Graphics::Draw(RenderMesh & aspect) {
 }
 
 
+// Sends the recorded 2D draws to the renderer, one batch per run 
+// of draws that share a key. Sorting is stable, so draws within a run 
+// keep the order they were made in.
+void Graphics::submit2D() {
+    if (!commands2D.size()) return;
+    DC_PROFILE_ZONE("Flush2D", "Render");
+
+    if (sort2D) {
+        std::stable_sort(commands2D.begin(), commands2D.end(), [](const Command2D & a, const Command2D & b) {
+            return a.key < b.key;
+        });
+    }
+
+    uint32_t i = 0;
+    while(i < commands2D.size()) {
+        uint64_t key = commands2D[i].key;
+        setDisplayMode(key2DPolygon(key), Renderer::Dimension::D_2D, key2DAlpha(key));
+
+        // each sprite batch is its own draw
+        if (commands2D[i].sprites) {
+            for(; i < commands2D.size() && commands2D[i].key == key; ++i) {
+                const SpriteBatch2D * batch = commands2D[i].sprites;
+                drawBuffer->Render2DSprites(batch->GetObjectID(), batch->GetSprites(), batch->Count(), params2D);
+                frameStats.batches2D++;
+            }
+            continue;
+        }
+
+        for(; i < commands2D.size() && commands2D[i].key == key; ++i) {
+            drawBuffer->Queue2DVertices(&indices2D[commands2D[i].first], commands2D[i].count);
+        }
+        drawBuffer->Render2DVertices(params2D);
+        frameStats.batches2D++;
+    }
+
+    commands2D.clear();
+    indices2D.clear();
+}
+
+
 void Graphics::setDisplayMode(Renderer::Polygon p, Renderer::Dimension d, Renderer::AlphaRule a) {
 	if (state.polygon != p || state.alpha != a || state.dim != d) {
 
         // Settings with which to draw have changed, so we commit what we have and start over
+        DC_PROFILE_ZONE("Flush2D", "Render");
         drawBuffer->SetDrawingMode(state.polygon, state.dim, state.alpha);
 		drawBuffer->Render2DVertices(params2D);
 
@@ -325,9 +458,39 @@ Renderer * Graphics::GetRenderer() {
 }
 
 void Graphics::SetRenderer(Renderer * r) {
+    if (pipeline) {
+        delete pipeline;
+        pipeline = nullptr;
+        if (r->IsSupported(Renderer::Capability::AnyThread)) {
+            pipeline = new RenderPipeline(r);
+            r = pipeline;
+        } else {
+            Console::Error() << "[Dynacoe::Graphics]: " << r->Name() << " can't be pipelined; drawing is no longer pipelined." << Console::End;
+        }
+    }
     drawBuffer = r;
 }
 
+void Graphics::SetPipelined(bool doIt) {
+    if (doIt == (pipeline != nullptr)) return;
+    if (doIt) {
+        if (!drawBuffer->IsSupported(Renderer::Capability::AnyThread)) {
+            Console::Error() << "[Dynacoe::Graphics]: " << drawBuffer->Name() << " can't be driven from another thread, so drawing can't be pipelined." << Console::End;
+            return;
+        }
+        pipeline = new RenderPipeline(drawBuffer);
+        drawBuffer = pipeline;
+    } else {
+        drawBuffer = pipeline->GetRenderer();
+        delete pipeline;
+        pipeline = nullptr;
+    }
+}
+
+bool Graphics::GetPipelined() {
+    return pipeline != nullptr;
+}
+
 
 
 
@@ -335,11 +498,12 @@ void Graphics::SetRenderer(Renderer * r) {
 
 
 void Graphics::Commit() {
+    DC_PROFILE_ZONE("Commit", "Render");
 
     //GetRenderCamera().GetFramebuffer()->RunCommand("dump-texture", nullptr);
     //GetRenderCamera().GetFramebuffer()->RunCommand("fill-debug", nullptr);
 
-    drawBuffer->Render2DVertices(params2D);
+    submit2D();
     setDisplayMode(Renderer::Polygon::Triangle,
                    Renderer::Dimension::D_2D,
                    Renderer::AlphaRule::Allow);
@@ -347,13 +511,28 @@ void Graphics::Commit() {
 
     Display * d = ViewManager::Get(ViewManager::GetCurrent());
 
-    if (d)
-        d->Update();
+    if (d) {
+        if (pipeline)
+            pipeline->Present(d);
+        else
+            d->Update();
+    }
 
     Camera * c = &GetRenderCamera();
     if (c && c->autoRefresh) {
         c->Refresh();
     }
+
+    // the frame is complete; let the render thread have it.
+    if (pipeline)
+        pipeline->Submit();
+
+    lastFrameStats = frameStats;
+    frameStats = FrameStats();
+}
+
+const Graphics::FrameStats & Graphics::GetLastFrameStats() {
+    return lastFrameStats;
 }
 
 
@@ -489,7 +668,7 @@ void Graphics::SetRenderCamera(Camera & c) {
     Camera * cam = &c;
     if (!cam) return;
 
-    drawBuffer->Render2DVertices(params2D);
+    submit2D();
 
 
 
@@ -500,6 +679,10 @@ void Graphics::SetRenderCamera(Camera & c) {
     Framebuffer * fb = cam->GetFramebuffer();
     drawBuffer->AttachTarget(fb);
 
+    // displays can't be changed while the render thread may be updating them.
+    if (pipeline)
+        pipeline->Finish();
+
     std::vector<ViewID> views = ViewManager::ListViews();
     for(uint32_t i = 0; i < views.size(); ++i) {
         ViewManager::Get(views[i])->AttachSource(fb);
@@ -540,7 +723,16 @@ Camera & Graphics::GetRenderCamera() {
 
 
 void Graphics::Flush2D() {
-    drawBuffer->Render2DVertices(params2D);
+    submit2D();
+}
+
+void Graphics::SetSorted2D(bool doIt) {
+    submit2D();
+    sort2D = doIt;
+}
+
+bool Graphics::GetSorted2D() {
+    return sort2D;
 }
 
 
@@ -0,0 +1,693 @@
+/*
+
+Renderer that lets a frame be drawn while the next one is stepped.
+
+RenderPipeline stands in for the real renderer. Calls that only change
+rendering state are recorded into a packet, copying everything they
+point to, so the packet stays valid no matter what the caller does with
+its data afterwards. Commit() hands the finished packet to a render thread,
+which replays it onto the real renderer and presents the display while
+the main thread goes on to step the next frame. At most one packet is
+in flight; recording the next one can overlap with it, but handing it
+over waits for the previous one to finish.
+
+2D objects and vertices are handed out from free lists kept on the
+recording side. Removing one puts it back on the list rather than in the
+renderer, and the lists are topped up by recording a command that has
+the render thread reserve a batch of new ones ahead of time, so creating
+them doesn't wait on the render thread.
+
+Other calls that return something from the renderer (creating textures
+and buffers, reading data back) cannot be recorded. They wait for all 
+recorded work to be replayed and are then run on the render thread, so 
+the real renderer is only ever used from one thread at a time. These are 
+slow and should be kept out of the per-frame path.
+
+The renderer must support Capability::AnyThread.
+
+
+*/
+
+#include <Dynacoe/Backends/Renderer/Renderer.h>
+#include <Dynacoe/Backends/Renderer/StaticState.h>
+#include <Dynacoe/Util/Profiler.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+#include <cstring>
+#include <type_traits>
+
+class RenderPipeline : public Dynacoe::Renderer {
+  public:
+    RenderPipeline(Dynacoe::Renderer * r) {
+        renderer = r;
+        recording = &packets[0];
+        inFlight  = &packets[1];
+        packetReady = false;
+        task = nullptr;
+        quit = false;
+
+        // answers that never change are taken now, while the
+        // calling thread still owns the renderer.
+        target = r->GetTarget();
+        r->GetDrawingMode(&polygon, &dimension, &alphaRule);
+        filter = r->GetTextureFilter();
+        viewingID = r->GetStaticViewingMatrixID();
+        projectionID = r->GetStaticProjectionMatrixID();
+        supportsLighting = r->IsSupported(Capability::Lighting);
+        supportsShaders = r->IsSupported(Capability::UserShaders);
+        maxTextures = r->MaxSimultaneousTextures();
+        maxLights = r->MaxEnabledLights();
+        language = r->ProgramGetLanguage();
+        framebufferTypes = r->SupportedFramebuffers();
+
+        thread = std::thread(&RenderPipeline::renderMain, this);
+    }
+
+    ~RenderPipeline() {
+        Finish();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            quit = true;
+        }
+        wake.notify_one();
+        thread.join();
+
+        // the thread is gone, so the renderer is ours again. Whatever 
+        // is still held back for reuse goes back to it.
+        collect(objects);
+        collect(vertices);
+        for(size_t i = 0; i < objects.free.size(); ++i)
+            renderer->Remove2DObject(objects.free[i]);
+        for(size_t i = 0; i < vertices.free.size(); ++i)
+            renderer->Remove2DVertex(vertices.free[i]);
+    }
+
+    // Returns the renderer that recorded work is replayed onto.
+    Dynacoe::Renderer * GetRenderer() {
+        return renderer;
+    }
+
+    // Records an update of the given display with what has been rendered.
+    void Present(Dynacoe::Display * d) {
+        push(Command::Type::Present, 0, 0, 0, d);
+    }
+
+    // Hands the recorded packet to the render thread. If the previous
+    // packet is still being replayed, this waits for it first.
+    void Submit() {
+        std::unique_lock<std::mutex> guard(lock);
+        idle.wait(guard, [this]{return !packetReady;});
+        collect(objects);
+        collect(vertices);
+        if (recording->commands.empty()) return;
+
+        std::swap(recording, inFlight);
+        packetReady = true;
+        wake.notify_one();
+
+        // the old in-flight packet is done with; reuse its storage.
+        recording->Clear();
+    }
+
+    // Submits what has been recorded and waits until it has all been replayed.
+    void Finish() {
+        Submit();
+        std::unique_lock<std::mutex> guard(lock);
+        idle.wait(guard, [this]{return !packetReady;});
+    }
+
+
+
+
+    std::string Name() {return renderer->Name();}
+    std::string Version() {return renderer->Version();}
+    bool Valid() {return renderer->Valid();}
+
+
+    void Queue2DVertices(const uint32_t * indices, uint32_t count) {
+        Packet & p = *recording;
+        push(Command::Type::Queue2DVertices, 0, p.words.size(), count);
+        p.words.insert(p.words.end(), indices, indices+count);
+    }
+
+    uint32_t Add2DObject() {
+        return take(objects, Command::Type::Reserve2DObjects);
+    }
+
+    void Remove2DObject(uint32_t id) {
+        objects.free.push_back(id);
+    }
+
+    uint32_t Add2DVertex() {
+        return take(vertices, Command::Type::Reserve2DVertices);
+    }
+
+    void Remove2DVertex(uint32_t id) {
+        vertices.free.push_back(id);
+    }
+
+    void Set2DVertex(uint32_t id, Vertex2D v) {
+        pushFloats(Command::Type::Set2DVertex, id, (float*)&v, sizeof(Vertex2D)/sizeof(float));
+    }
+
+    Vertex2D Get2DVertex(uint32_t id) {
+        Vertex2D out;
+        run([&]{out = renderer->Get2DVertex(id);});
+        return out;
+    }
+
+    void Set2DObjectParameters(uint32_t id, Render2DObjectParameters params) {
+        pushFloats(Command::Type::Set2DObjectParameters, id, params.data, 16);
+    }
+
+    void Render2DVertices(const Render2DStaticParameters & params) {
+        // the context transform is only pointed to, so it's copied along.
+        float data[18] = {params.contextWidth, params.contextHeight};
+        if (params.contextTransform)
+            memcpy(data+2, params.contextTransform, sizeof(float)*16);
+        pushFloats(Command::Type::Render2DVertices, params.contextTransform != nullptr, data, 18);
+    }
+
+    void Clear2DQueue() {
+        push(Command::Type::Clear2DQueue, 0, 0, 0);
+    }
+
+    void Render2DSprites(uint32_t object, const Sprite2D * sprites, uint32_t count, const Render2DStaticParameters & params) {
+        // same as Render2DVertices, with the sprites following the parameters.
+        float data[18] = {params.contextWidth, params.contextHeight};
+        if (params.contextTransform)
+            memcpy(data+2, params.contextTransform, sizeof(float)*16);
+        Packet & p = *recording;
+        push(Command::Type::Render2DSprites, object, p.floats.size(), count);
+        recording->commands.back().id = params.contextTransform != nullptr;
+        p.floats.insert(p.floats.end(), data, data+18);
+        p.floats.insert(p.floats.end(), (const float*)sprites, (const float*)(sprites+count));
+    }
+
+
+
+    void RenderStatic(Dynacoe::StaticState * state) {
+        Packet & p = *recording;
+        uint32_t textureCount = state->textures ? state->textures->size() : 0;
+        uint32_t indexCount   = state->indices  ? state->indices->size()  : 0;
+
+        push(Command::Type::RenderStatic, p.textures.size(), p.ids.size(), indexCount, state->samplebuffer);
+        p.ids.push_back(state->vertices);
+        p.ids.push_back(state->program);
+        p.ids.push_back(state->materialData);
+        p.ids.push_back(state->modelData);
+
+        // index and texture lists are copied too; the first word
+        // says how many textures there are.
+        p.words.push_back(textureCount);
+        if (textureCount)
+            p.textures.insert(p.textures.end(), state->textures->begin(), state->textures->end());
+        if (indexCount)
+            p.words.insert(p.words.end(), state->indices->begin(), state->indices->end());
+    }
+
+    void ClearRenderedData() {
+        push(Command::Type::ClearRenderedData, 0, 0, 0);
+    }
+
+    Dynacoe::RenderBufferID GetStaticViewingMatrixID() {return viewingID;}
+    Dynacoe::RenderBufferID GetStaticProjectionMatrixID() {return projectionID;}
+
+
+
+    int AddTexture(int w, int h, const uint8_t * data) {
+        int out;
+        run([&]{out = renderer->AddTexture(w, h, data);});
+        textureSizes[out] = std::make_pair(w, h);
+        return out;
+    }
+
+    void UpdateTexture(int tex, const uint8_t * data) {
+        auto size = textureSizes.find(tex);
+        if (size == textureSizes.end()) {
+            // made before the pipeline was; the size isn't known here.
+            run([&]{renderer->UpdateTexture(tex, data);});
+            return;
+        }
+
+        Packet & p = *recording;
+        uint32_t count = size->second.first * size->second.second * 4;
+        push(Command::Type::UpdateTexture, tex, p.bytes.size(), count);
+        p.bytes.insert(p.bytes.end(), data, data+count);
+    }
+
+    void RemoveTexture(int tex) {
+        textureSizes.erase(tex);
+        push(Command::Type::RemoveTexture, tex, 0, 0);
+    }
+
+    void GetTexture(int tex, uint8_t * data) {
+        run([&]{renderer->GetTexture(tex, data);});
+    }
+
+    void SetTextureFilter(TexFilter f) {
+        filter = f;
+        push(Command::Type::SetTextureFilter, (uint32_t)f, 0, 0);
+    }
+
+    TexFilter GetTextureFilter() {return filter;}
+
+    int GetTextureWidth(int tex) {
+        auto size = textureSizes.find(tex);
+        if (size != textureSizes.end()) return size->second.first;
+        int out;
+        run([&]{out = renderer->GetTextureWidth(tex);});
+        return out;
+    }
+
+    int GetTextureHeight(int tex) {
+        auto size = textureSizes.find(tex);
+        if (size != textureSizes.end()) return size->second.second;
+        int out;
+        run([&]{out = renderer->GetTextureHeight(tex);});
+        return out;
+    }
+
+    int MaxSimultaneousTextures() {return maxTextures;}
+
+
+
+    Dynacoe::RenderBufferID AddBuffer(float * data, int count) {
+        Dynacoe::RenderBufferID out;
+        run([&]{out = renderer->AddBuffer(data, count);});
+        return out;
+    }
+
+    void UpdateBuffer(Dynacoe::RenderBufferID id, float * data, int offset, int count) {
+        Packet & p = *recording;
+        push(Command::Type::UpdateBuffer, offset, p.floats.size(), count);
+        recording->commands.back().id = p.ids.size();
+        p.ids.push_back(id);
+        p.floats.insert(p.floats.end(), data, data+count);
+    }
+
+    void ReadBuffer(Dynacoe::RenderBufferID id, float * data, int offset, int count) {
+        run([&]{renderer->ReadBuffer(id, data, offset, count);});
+    }
+
+    int BufferSize(Dynacoe::RenderBufferID id) {
+        int out;
+        run([&]{out = renderer->BufferSize(id);});
+        return out;
+    }
+
+    void RemoveBuffer(Dynacoe::RenderBufferID id) {
+        pushID(Command::Type::RemoveBuffer, 0, id);
+    }
+
+
+
+    std::string ProgramGetLanguage() {return language;}
+
+    Dynacoe::ProgramID ProgramAdd(const std::string & vertexSrc, const std::string & fragSrc, std::string & log) {
+        Dynacoe::ProgramID out;
+        run([&]{out = renderer->ProgramAdd(vertexSrc, fragSrc, log);});
+        return out;
+    }
+
+    Dynacoe::ProgramID ProgramGetBuiltIn(BuiltInShaderMode mode) {
+        Dynacoe::ProgramID out;
+        run([&]{out = renderer->ProgramGetBuiltIn(mode);});
+        return out;
+    }
+
+
+
+    Dynacoe::LightID AddLight(LightType type) {
+        Dynacoe::LightID out;
+        run([&]{out = renderer->AddLight(type);});
+        return out;
+    }
+
+    void UpdateLightAttributes(Dynacoe::LightID id, float * data) {
+        // position, color, and intensity. See Renderer.h
+        pushFloats(Command::Type::UpdateLightAttributes, 0, data, 7);
+        recording->commands.back().id = recording->ids.size();
+        recording->ids.push_back(id);
+    }
+
+    void EnableLight(Dynacoe::LightID id, bool doIt) {
+        pushID(Command::Type::EnableLight, doIt, id);
+    }
+
+    void RemoveLight(Dynacoe::LightID id) {
+        pushID(Command::Type::RemoveLight, 0, id);
+    }
+
+    int MaxEnabledLights() {return maxLights;}
+
+    int NumLights() {
+        int out;
+        run([&]{out = renderer->NumLights();});
+        return out;
+    }
+
+
+
+    bool IsSupported(Capability c) {
+        switch(c) {
+          case Capability::Lighting:    return supportsLighting;
+          case Capability::UserShaders: return supportsShaders;
+          case Capability::AnyThread:   return false;
+        }
+        return false;
+    }
+
+    void SetDrawingMode(Polygon p, Dimension d, AlphaRule a) {
+        polygon = p;
+        dimension = d;
+        alphaRule = a;
+        push(Command::Type::SetDrawingMode, (uint32_t)p | ((uint32_t)d << 8) | ((uint32_t)a << 16), 0, 0);
+    }
+
+    void GetDrawingMode(Polygon * p, Dimension * d, AlphaRule * a) {
+        *p = polygon;
+        *d = dimension;
+        *a = alphaRule;
+    }
+
+    void AttachTarget(Dynacoe::Framebuffer * fb) {
+        target = fb;
+        push(Command::Type::AttachTarget, 0, 0, 0, fb);
+    }
+
+    Dynacoe::Framebuffer * GetTarget() {return target;}
+
+    std::vector<Dynacoe::Framebuffer::Type> SupportedFramebuffers() {return framebufferTypes;}
+
+
+
+
+  private:
+    struct Command {
+        enum class Type : uint8_t {
+            Queue2DVertices,
+            Reserve2DObjects,
+            Reserve2DVertices,
+            Set2DVertex,
+            Set2DObjectParameters,
+            Render2DVertices,
+            Clear2DQueue,
+            Render2DSprites,
+            RenderStatic,
+            ClearRenderedData,
+            UpdateTexture,
+            RemoveTexture,
+            SetTextureFilter,
+            UpdateBuffer,
+            RemoveBuffer,
+            UpdateLightAttributes,
+            EnableLight,
+            RemoveLight,
+            SetDrawingMode,
+            AttachTarget,
+            Present
+        };
+
+        Type type;
+        uint32_t index;   // object, vertex, or texture handle, or a small value.
+        uint32_t offset;  // into the payload array the command uses.
+        uint32_t count;
+        uint32_t id;      // into the packet's ids.
+        void * pointer;
+    };
+
+    // Everything needed to replay one frame.
+    struct Packet {
+        std::vector<Command> commands;
+        std::vector<float> floats;
+        std::vector<uint32_t> words;
+        std::vector<uint8_t> bytes;
+        std::vector<Dynacoe::LookupID> ids;
+        std::vector<std::pair<int, int>> textures;
+
+        void Clear() {
+            commands.clear();
+            floats.clear();
+            words.clear();
+            bytes.clear();
+            ids.clear();
+            textures.clear();
+        }
+    };
+
+
+    // 2D object or vertex IDs that can be handed out without asking 
+    // the renderer.
+    struct IDPool {
+        IDPool() : batch(64), requested(false) {}
+
+        // ready to be handed out.
+        std::vector<uint32_t> free;
+
+        // reserved by the render thread, but not yet picked up. Only 
+        // touched by whichever thread holds the renderer.
+        std::vector<uint32_t> arrived;
+
+        uint32_t batch;
+        bool requested;
+    };
+
+
+    // Hands out an ID from the pool, asking for more ahead of time 
+    // once it runs low. Only waits if it runs out before they arrive.
+    uint32_t take(IDPool & pool, Command::Type reserve) {
+        if (!pool.requested && pool.free.size() < pool.batch/2) {
+            push(reserve, 0, 0, pool.batch);
+            pool.requested = true;
+            if (pool.batch < 4096) pool.batch *= 2;
+        }
+        if (pool.free.empty()) {
+            Finish();
+            collect(pool);
+        }
+        uint32_t out = pool.free.back();
+        pool.free.pop_back();
+        return out;
+    }
+
+    // Picks up what the render thread reserved. It must not be replaying.
+    void collect(IDPool & pool) {
+        if (pool.arrived.empty()) return;
+        // taken in reverse so that the lowest IDs are handed out first.
+        pool.free.insert(pool.free.end(), pool.arrived.rbegin(), pool.arrived.rend());
+        pool.arrived.clear();
+        pool.requested = false;
+    }
+
+
+    void push(Command::Type type, uint32_t index, uint32_t offset, uint32_t count, void * pointer = nullptr) {
+        recording->commands.push_back({type, index, offset, count, 0, pointer});
+    }
+
+    void pushFloats(Command::Type type, uint32_t index, const float * data, uint32_t count) {
+        Packet & p = *recording;
+        push(type, index, p.floats.size(), count);
+        p.floats.insert(p.floats.end(), data, data+count);
+    }
+
+    void pushID(Command::Type type, uint32_t index, const Dynacoe::LookupID & id) {
+        Packet & p = *recording;
+        push(type, index, 0, 0);
+        p.commands.back().id = p.ids.size();
+        p.ids.push_back(id);
+    }
+
+
+    // Waits for all recorded work, then runs fn on the render thread.
+    void run(const std::function<void()> & fn) {
+        Submit();
+        std::unique_lock<std::mutex> guard(lock);
+        idle.wait(guard, [this]{return !packetReady;});
+        task = &fn;
+        wake.notify_one();
+        idle.wait(guard, [this]{return !task;});
+    }
+
+
+    void renderMain() {
+        Dynacoe::Profiler::SetThreadName("Render");
+        std::unique_lock<std::mutex> guard(lock);
+        while(true) {
+            wake.wait(guard, [this]{return packetReady || task || quit;});
+            if (packetReady) {
+                guard.unlock();
+                replay(*inFlight);
+                guard.lock();
+                packetReady = false;
+            } else if (task) {
+                guard.unlock();
+                (*task)();
+                guard.lock();
+                task = nullptr;
+            } else {
+                return;
+            }
+            idle.notify_all();
+        }
+    }
+
+
+    void replay(const Packet & p) {
+        DC_PROFILE_ZONE("Replay", "Render");
+        const Command * c = p.commands.data();
+        const Command * end = c + p.commands.size();
+        for(; c < end; ++c) {
+            switch(c->type) {
+              case Command::Type::Queue2DVertices:
+                renderer->Queue2DVertices(p.words.data() + c->offset, c->count);
+                break;
+
+              case Command::Type::Reserve2DObjects:
+                for(uint32_t i = 0; i < c->count; ++i)
+                    objects.arrived.push_back(renderer->Add2DObject());
+                break;
+
+              case Command::Type::Reserve2DVertices:
+                for(uint32_t i = 0; i < c->count; ++i)
+                    vertices.arrived.push_back(renderer->Add2DVertex());
+                break;
+
+              case Command::Type::Set2DVertex: {
+                static_assert(std::is_trivially_copyable<Vertex2D>::value, "Vertex2D is recorded as raw floats");
+                Vertex2D v;
+                memcpy((void*)&v, p.floats.data() + c->offset, sizeof(Vertex2D));
+                renderer->Set2DVertex(c->index, v);
+                break;
+              }
+
+              case Command::Type::Set2DObjectParameters: {
+                Render2DObjectParameters params;
+                memcpy(params.data, p.floats.data() + c->offset, sizeof(float)*16);
+                renderer->Set2DObjectParameters(c->index, params);
+                break;
+              }
+
+              case Command::Type::Render2DVertices: {
+                const float * data = p.floats.data() + c->offset;
+                Render2DStaticParameters params;
+                params.contextWidth = data[0];
+                params.contextHeight = data[1];
+                params.contextTransform = c->index ? (float*)data+2 : nullptr;
+                renderer->Render2DVertices(params);
+                break;
+              }
+
+              case Command::Type::Clear2DQueue: renderer->Clear2DQueue(); break;
+
+              case Command::Type::Render2DSprites: {
+                const float * data = p.floats.data() + c->offset;
+                Render2DStaticParameters params;
+                params.contextWidth = data[0];
+                params.contextHeight = data[1];
+                params.contextTransform = c->id ? (float*)data+2 : nullptr;
+                renderer->Render2DSprites(c->index, (const Sprite2D*)(data+18), c->count, params);
+                break;
+              }
+
+              case Command::Type::RenderStatic: {
+                uint32_t textureCount = p.words[c->offset];
+                staticTextures.assign(p.textures.begin() + c->index, p.textures.begin() + c->index + textureCount);
+                staticIndices.assign(p.words.begin() + c->offset + 1, p.words.begin() + c->offset + 1 + c->count);
+
+                Dynacoe::StaticState state;
+                state.vertices     = p.ids[c->id];
+                state.program      = p.ids[c->id+1];
+                state.materialData = p.ids[c->id+2];
+                state.modelData    = p.ids[c->id+3];
+                state.samplebuffer = (Dynacoe::Framebuffer*)c->pointer;
+                state.textures     = &staticTextures;
+                state.indices      = &staticIndices;
+                renderer->RenderStatic(&state);
+                break;
+              }
+
+              case Command::Type::ClearRenderedData: renderer->ClearRenderedData(); break;
+
+              case Command::Type::UpdateTexture:
+                renderer->UpdateTexture(c->index, p.bytes.data() + c->offset);
+                break;
+
+              case Command::Type::RemoveTexture:    renderer->RemoveTexture(c->index); break;
+              case Command::Type::SetTextureFilter: renderer->SetTextureFilter((TexFilter)c->index); break;
+
+              case Command::Type::UpdateBuffer:
+                renderer->UpdateBuffer(p.ids[c->id], (float*)p.floats.data() + c->offset, c->index, c->count);
+                break;
+
+              case Command::Type::RemoveBuffer: renderer->RemoveBuffer(p.ids[c->id]); break;
+
+              case Command::Type::UpdateLightAttributes:
+                renderer->UpdateLightAttributes(p.ids[c->id], (float*)p.floats.data() + c->offset);
+                break;
+
+              case Command::Type::EnableLight: renderer->EnableLight(p.ids[c->id], c->index); break;
+              case Command::Type::RemoveLight: renderer->RemoveLight(p.ids[c->id]); break;
+
+              case Command::Type::SetDrawingMode:
+                renderer->SetDrawingMode(
+                    (Polygon)(c->index & 0xff),
+                    (Dimension)((c->index >> 8) & 0xff),
+                    (AlphaRule)((c->index >> 16) & 0xff)
+                );
+                break;
+
+              case Command::Type::AttachTarget:
+                renderer->AttachTarget((Dynacoe::Framebuffer*)c->pointer);
+                break;
+
+              case Command::Type::Present:
+                ((Dynacoe::Display*)c->pointer)->Update();
+                break;
+            }
+        }
+    }
+
+
+
+    Dynacoe::Renderer * renderer;
+
+    Packet packets[2];
+    Packet * recording;
+    Packet * inFlight;
+
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    bool packetReady;
+    const std::function<void()> * task;
+    bool quit;
+
+    IDPool objects;
+    IDPool vertices;
+
+    // scratch space for replaying RenderStatic.
+    std::vector<std::pair<int, int>> staticTextures;
+    std::vector<uint32_t> staticIndices;
+
+    // state as last set from the main thread.
+    Dynacoe::Framebuffer * target;
+    Polygon polygon;
+    Dimension dimension;
+    AlphaRule alphaRule;
+    TexFilter filter;
+    std::unordered_map<int, std::pair<int, int>> textureSizes;
+
+    Dynacoe::RenderBufferID viewingID;
+    Dynacoe::RenderBufferID projectionID;
+    bool supportsLighting;
+    bool supportsShaders;
+    int maxTextures;
+    int maxLights;
+    std::string language;
+    std::vector<Dynacoe::Framebuffer::Type> framebufferTypes;
+};
@@ -37,6 +37,8 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Util/Filesys.h>
 #include <Dynacoe/Util/Math.h>
 #include <Dynacoe/Util/Time.h>
+#include <Dynacoe/Util/Profiler.h>
+#include <Dynacoe/Util/MemoryStats.h>
 #include <Dynacoe/AudioBlock.h>
 #include <Dynacoe/Dynacoe.h>
 #include <Dynacoe/Components/Mutator.h>
@@ -10,7 +10,27 @@ struct AudioEffectChannel {
         limiterScale = 1.f;
     };
 
+    // Channels are moved around as raw bytes by StateArray, which never 
+    // destroys them; only the one left holding the buffer releases it.
+    ~AudioEffectChannel() {
+        if (!data) return;
+        Dynacoe::MemoryStats::Track(
+            Dynacoe::MemoryStats::Category::AudioChannels, 
+            -(int64_t)sizeBytes, 
+            -1
+        );
+        free(data);
+    }
+
+    AudioEffectChannel(const AudioEffectChannel &) = delete;
+    AudioEffectChannel & operator=(const AudioEffectChannel &) = delete;
+
     void SetSize(uint32_t bytes) {
+        Dynacoe::MemoryStats::Track(
+            Dynacoe::MemoryStats::Category::AudioChannels, 
+            (int64_t)bytes - (data ? sizeBytes : 0), 
+            data ? 0 : 1
+        );
         if (data) free(data);
         data = (float*)malloc(bytes);
         sizeBytes = bytes;
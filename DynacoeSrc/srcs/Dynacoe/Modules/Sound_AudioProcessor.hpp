@@ -35,6 +35,9 @@ class AudioProcessor {
             // allocates buffer. Is never destroyed intentionally.
             buffer.SetSize(outputBufferSize);
             io.channels.Push(buffer);
+
+            // the array's copy owns the buffer now.
+            buffer.data = nullptr;
         }
 
         // copy back over to ioShared
@@ -69,6 +72,7 @@ class AudioProcessor {
 
     // Pushes played audio to the audio manager
     void ProcessAudio() {
+        DC_PROFILE_ZONE("Mix", "Audio");
         
         // Before the frame officially starts, we want to determine how 
         // many frames we wish to deliver to the audio manager
@@ -178,6 +182,7 @@ class AudioProcessor {
     void * thread;
 
     static void ThreadControl() {
+        Dynacoe::Profiler::SetThreadName("Audio");
         try {
             // TODO: determine good, stable sleep amount
             while(1) {
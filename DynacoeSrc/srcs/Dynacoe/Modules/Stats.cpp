@@ -0,0 +1,487 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#include <Dynacoe/Modules/Stats.h>
+#include <Dynacoe/Modules/Graphics.h>
+#include <Dynacoe/Modules/Sound.h>
+#include <Dynacoe/Modules/Console.h>
+#include <Dynacoe/Dynacoe.h>
+#include <Dynacoe/Util/Time.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <cstdio>
+#include <cstddef>
+#include <cctype>
+
+#ifdef DC_OS_LINUX
+    #include <sys/socket.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <netdb.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace Dynacoe;
+
+
+std::atomic<bool> Stats::publishing(false);
+
+
+namespace {
+
+// One frame's worth of numbers, as taken on the main thread.
+struct Sample {
+    float frameMS;
+    float stepMS;
+    float drawMS;
+    float reclaimMS;
+    float systemMS;
+    uint32_t meshes;
+    uint32_t objects2D;
+    uint32_t vertices2D;
+    bool underrun;
+};
+
+// Frames that can be waiting for the publisher before new ones are dropped.
+const uint32_t sample_ring_c = 512;
+
+// How often the publisher wakes to fold in waiting samples.
+const int publisher_poll_ms_c = 50;
+
+
+// Samples go from the main thread to the publishing thread through a
+// single-producer, single-consumer ring. The publishing thread sums them 
+// and, each interval, writes out the totals.
+class StatsPublisher {
+  public:
+    StatsPublisher() {
+        head = 0;
+        tail = 0;
+        dropped = 0;
+        intervalMS = 1000;
+        running = false;
+        udpSocket = -1;
+        shmFD = -1;
+        shm = nullptr;
+        reset();
+    }
+
+    // main thread only.
+    void Push(const Sample & s) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= sample_ring_c) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ring[h % sample_ring_c] = s;
+        head.store(h+1, std::memory_order_release);
+    }
+
+
+    bool OpenUDP(const std::string & host, int port, const std::string & prefixSrc) {
+        #ifdef DC_OS_LINUX
+            addrinfo hints;
+            memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_DGRAM;
+            addrinfo * result = nullptr;
+            char portStr[16];
+            snprintf(portStr, 16, "%d", port);
+            if (getaddrinfo(host.c_str(), portStr, &hints, &result) || !result) {
+                Console::Error() << "[Dynacoe::Stats]: Could not resolve " << host << Console::End;
+                return false;
+            }
+
+            int fd = socket(AF_INET, SOCK_DGRAM, 0);
+            if (fd < 0) {
+                freeaddrinfo(result);
+                Console::Error() << "[Dynacoe::Stats]: Could not open a UDP socket." << Console::End;
+                return false;
+            }
+
+            std::lock_guard<std::mutex> guard(lock);
+            closeUDP();
+            udpSocket = fd;
+            memcpy(&udpAddress, result->ai_addr, result->ai_addrlen);
+            udpAddressLength = result->ai_addrlen;
+            prefix = prefixSrc;
+            freeaddrinfo(result);
+            start();
+            return true;
+        #else
+            Console::Error() << "[Dynacoe::Stats]: UDP publishing is not supported on this platform." << Console::End;
+            return false;
+        #endif
+    }
+
+
+    bool OpenSharedMemory(const std::string & name) {
+        #ifdef DC_OS_LINUX
+            int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+            if (fd < 0 || ftruncate(fd, sizeof(Stats::Snapshot))) {
+                if (fd >= 0) close(fd);
+                Console::Error() << "[Dynacoe::Stats]: Could not create shared memory " << name << Console::End;
+                return false;
+            }
+            void * mem = mmap(nullptr, sizeof(Stats::Snapshot), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (mem == MAP_FAILED) {
+                close(fd);
+                Console::Error() << "[Dynacoe::Stats]: Could not map shared memory " << name << Console::End;
+                return false;
+            }
+
+            std::lock_guard<std::mutex> guard(lock);
+            closeSharedMemory();
+            shmFD = fd;
+            shmName = name;
+            shm = (Stats::Snapshot*)mem;
+            memset(mem, 0, sizeof(Stats::Snapshot));
+            shm->magic = Stats::SnapshotMagic;
+            shm->version = Stats::SnapshotVersion;
+            shm->intervalMS = intervalMS;
+            start();
+            return true;
+        #else
+            Console::Error() << "[Dynacoe::Stats]: Shared memory publishing is not supported on this platform." << Console::End;
+            return false;
+        #endif
+    }
+
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            running = false;
+        }
+        wake.notify_all();
+        if (thread.joinable()) thread.join();
+
+        std::lock_guard<std::mutex> guard(lock);
+        closeUDP();
+        closeSharedMemory();
+    }
+
+    void SetInterval(uint32_t ms) {
+        std::lock_guard<std::mutex> guard(lock);
+        intervalMS = ms ? ms : 1;
+    }
+
+
+  private:
+    // expects the lock to be held.
+    void start() {
+        if (running) return;
+        running = true;
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+        reset();
+        thread = std::thread(&StatsPublisher::threadMain, this);
+    }
+
+    void closeUDP() {
+        #ifdef DC_OS_LINUX
+            if (udpSocket >= 0) close(udpSocket);
+        #endif
+        udpSocket = -1;
+    }
+
+    void closeSharedMemory() {
+        #ifdef DC_OS_LINUX
+            if (shm) {
+                munmap(shm, sizeof(Stats::Snapshot));
+                close(shmFD);
+                shm_unlink(shmName.c_str());
+            }
+        #endif
+        shm = nullptr;
+        shmFD = -1;
+    }
+
+
+    void threadMain() {
+        uint64_t nextPublish = Time::NsSinceStartup() + intervalMS * 1000000ull;
+        std::unique_lock<std::mutex> guard(lock);
+        while(running) {
+            wake.wait_for(guard, std::chrono::milliseconds(publisher_poll_ms_c));
+            if (!running) break;
+
+            gather();
+            uint64_t now = Time::NsSinceStartup();
+            if (now >= nextPublish) {
+                publish();
+                reset();
+                nextPublish += intervalMS * 1000000ull;
+                if (nextPublish < now) nextPublish = now + intervalMS * 1000000ull;
+            }
+        }
+    }
+
+
+    void gather() {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        for(; t != h; ++t) {
+            const Sample & s = ring[t % sample_ring_c];
+            frames++;
+            frameSum += s.frameMS;   if (s.frameMS > frameMax) frameMax = s.frameMS;
+            stepSum  += s.stepMS;    if (s.stepMS  > stepMax)  stepMax  = s.stepMS;
+            drawSum  += s.drawMS;    if (s.drawMS  > drawMax)  drawMax  = s.drawMS;
+            reclaimSum += s.reclaimMS;
+            systemMS = s.systemMS;
+            meshSum     += s.meshes;
+            objectSum   += s.objects2D;
+            vertexSum   += s.vertices2D;
+            underruns   += s.underrun;
+        }
+        tail.store(t, std::memory_order_release);
+    }
+
+    void reset() {
+        frames = 0;
+        frameSum = frameMax = 0;
+        stepSum  = stepMax  = 0;
+        drawSum  = drawMax  = 0;
+        reclaimSum = 0;
+        systemMS = 0;
+        meshSum = objectSum = vertexSum = 0;
+        underruns = 0;
+        periodStartNs = Time::NsSinceStartup();
+    }
+
+
+    void fill(Stats::Snapshot & out) {
+        double n = frames ? frames : 1;
+        double seconds = (Time::NsSinceStartup() - periodStartNs) / 1000000000.0;
+        out.intervalMS = intervalMS;
+        out.timeMS     = Time::NsSinceStartup() / 1000000ull;
+        out.frames     = frames;
+        out.fps        = seconds > 0 ? frames / seconds : 0;
+        out.frameMS    = frameSum / n;
+        out.frameMaxMS = frameMax;
+        out.stepMS     = stepSum / n;
+        out.stepMaxMS  = stepMax;
+        out.drawMS     = drawSum / n;
+        out.drawMaxMS  = drawMax;
+        out.systemMS   = systemMS;
+        out.reclaimMS  = reclaimSum / n;
+        out.meshes     = meshSum / n;
+        out.objects2D  = objectSum / n;
+        out.vertices2D = vertexSum / n;
+        out.audioUnderruns = underruns;
+        out.droppedSamples = dropped.exchange(0, std::memory_order_relaxed);
+        for(int i = 0; i < MemoryStats::CategoryCount; ++i) {
+            out.memoryLive[i] = MemoryStats::Get((MemoryStats::Category)i).liveBytes;
+        }
+    }
+
+
+    void publish() {
+        Stats::Snapshot snap;
+        fill(snap);
+
+        #ifdef DC_OS_LINUX
+            if (shm) {
+                // everything after the sequence number is copied between its two increments.
+                const size_t start = offsetof(Stats::Snapshot, intervalMS);
+                shm->sequence.fetch_add(1, std::memory_order_acq_rel);
+                std::atomic_thread_fence(std::memory_order_release);
+                memcpy((char*)shm + start, (char*)&snap + start, sizeof(Stats::Snapshot) - start);
+                std::atomic_thread_fence(std::memory_order_release);
+                shm->sequence.fetch_add(1, std::memory_order_release);
+            }
+
+            if (udpSocket >= 0) {
+                sendUDP(snap);
+            }
+        #endif
+    }
+
+
+    #ifdef DC_OS_LINUX
+    void sendUDP(const Stats::Snapshot & snap) {
+        packetLength = 0;
+        addMetric("fps",            snap.fps, "g");
+        addMetric("frame_ms",       snap.frameMS, "g");
+        addMetric("frame_ms.max",   snap.frameMaxMS, "g");
+        addMetric("step_ms",        snap.stepMS, "g");
+        addMetric("step_ms.max",    snap.stepMaxMS, "g");
+        addMetric("draw_ms",        snap.drawMS, "g");
+        addMetric("draw_ms.max",    snap.drawMaxMS, "g");
+        addMetric("system_ms",      snap.systemMS, "g");
+        addMetric("reclaim_ms",     snap.reclaimMS, "g");
+        addMetric("meshes",         snap.meshes, "g");
+        addMetric("objects_2d",     snap.objects2D, "g");
+        addMetric("vertices_2d",    snap.vertices2D, "g");
+        addMetric("audio_underruns",snap.audioUnderruns, "c");
+        addMetric("dropped_samples",snap.droppedSamples, "c");
+
+        char name[64];
+        for(int i = 0; i < MemoryStats::CategoryCount; ++i) {
+            // i.e. "Audio Data" -> "memory.audio_data"
+            const char * src = MemoryStats::GetName((MemoryStats::Category)i);
+            int n = snprintf(name, 64, "memory.");
+            for(; *src && n < 63; ++src, ++n) {
+                name[n] = *src == ' ' ? '_' : tolower(*src);
+            }
+            name[n] = 0;
+            addMetric(name, (double)snap.memoryLive[i], "g");
+        }
+        flushPacket();
+    }
+
+    void addMetric(const char * name, double value, const char * type) {
+        char line[256];
+        int length = snprintf(line, 256, "%s%s:%.10g|%s\n", prefix.c_str(), name, value, type);
+        if (length <= 0 || length >= 256) return;
+        if (packetLength + length > max_packet_c) flushPacket();
+        memcpy(packet + packetLength, line, length);
+        packetLength += length;
+    }
+
+    void flushPacket() {
+        if (!packetLength) return;
+        sendto(udpSocket, packet, packetLength, 0, (sockaddr*)&udpAddress, udpAddressLength);
+        packetLength = 0;
+    }
+
+    sockaddr_storage udpAddress;
+    socklen_t udpAddressLength;
+    #endif
+
+    // fits in a typical MTU with room for headers.
+    static const int max_packet_c = 1400;
+    char packet[max_packet_c];
+    int packetLength;
+
+
+    Sample ring[sample_ring_c];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> dropped;
+
+    std::thread thread;
+    std::mutex lock; // guards everything below
+    std::condition_variable wake;
+    bool running;
+    uint32_t intervalMS;
+
+    int udpSocket;
+    std::string prefix;
+    int shmFD;
+    std::string shmName;
+    Stats::Snapshot * shm;
+
+    // totals since the last publish
+    uint64_t periodStartNs;
+    uint32_t frames;
+    double frameSum, frameMax;
+    double stepSum, stepMax;
+    double drawSum, drawMax;
+    double reclaimSum;
+    float  systemMS;
+    uint64_t meshSum, objectSum, vertexSum;
+    uint32_t underruns;
+};
+
+StatsPublisher & publisher() {
+    static StatsPublisher * p = new StatsPublisher;
+    return *p;
+}
+
+}
+
+
+
+
+
+bool Stats::PublishUDP(const std::string & host, int port, const std::string & prefix) {
+    if (!publisher().OpenUDP(host, port, prefix)) return false;
+    publishing = true;
+    return true;
+}
+
+bool Stats::PublishSharedMemory(const std::string & name) {
+    if (!publisher().OpenSharedMemory(name)) return false;
+    publishing = true;
+    return true;
+}
+
+void Stats::Stop() {
+    publishing = false;
+    publisher().Stop();
+}
+
+bool Stats::IsPublishing() {
+    return publishing;
+}
+
+void Stats::SetInterval(uint32_t ms) {
+    publisher().SetInterval(ms);
+}
+
+
+
+
+void Stats::Init() {}
+void Stats::InitAfter() {}
+void Stats::RunBefore() {}
+void Stats::RunAfter() {}
+
+// Sampled once per frame, before drawing, so the previous frame is complete.
+void Stats::DrawBefore() {
+    if (!publishing.load(std::memory_order_relaxed)) return;
+
+    const Engine::FrameTiming & timing = Engine::GetLastFrameTiming();
+    const Graphics::FrameStats & drawn = Graphics::GetLastFrameStats();
+    AudioManager * audio = Sound::GetManager();
+
+    Sample s;
+    s.frameMS    = timing.totalMS;
+    s.stepMS     = timing.stepMS;
+    s.drawMS     = timing.drawMS;
+    s.reclaimMS  = timing.reclaimMS;
+    s.systemMS   = Engine::GetDiagnostics().systemTimeMS;
+    s.meshes     = drawn.meshes;
+    s.objects2D  = drawn.objects2D;
+    s.vertices2D = drawn.vertices2D;
+    s.underrun   = audio && audio->Underrun();
+    publisher().Push(s);
+}
+
+void Stats::DrawAfter() {}
+
+Backend * Stats::GetBackend() {
+    return nullptr;
+}
@@ -36,98 +36,91 @@ DEALINGS IN THE SOFTWARE.
 #include <Dynacoe/Mesh.h>
 #include <Dynacoe/Backends/Renderer/Renderer.h>
 #include <cstring>
+#include <cmath>
 #include <cassert>
 
 
 
 using namespace Dynacoe;
+#include "Spatial_TransformSystem.hpp"
 
-class Dynacoe::SpatialTransformUpdate : public Transform::OnTransformUpdate {
-public:
-    Spatial * parent;
-    SpatialTransformUpdate(Spatial * p) {
-        parent = p;
-    }
-    void operator()(Transform * source) {
-        parent->Invalidate();
-    }
-    
-    bool OwnedByTransform() {return false;}
-};
-
-Spatial::Spatial() : node(new Transform) {
-    transformOwned = node;
-	transformUpdate = new SpatialTransformUpdate(this);
-    transformOwned->AddTransformCallback(transformUpdate);
-    needsUpdate = true;
-    parent = nullptr;
+
+
+
+Spatial::Spatial() : node(&transformOwned) {
+    slot = SpatialSystem::Get().Add(this);
 }
 
 void Spatial::Invalidate() {
-    needsUpdate = true;
+    SpatialSystem::Get().Invalidate(slot);
 }
 
 Spatial::~Spatial() {
-    SetAsParent(nullptr);
-    delete transformOwned;
-	delete transformUpdate;
+    SpatialSystem::Get().Remove(slot);
 }
 
-TransformMatrix & Spatial::GetGlobalTransform() {
-    CheckUpdate();
-    return global;
+TransformMatrix Spatial::GetGlobalTransform() {
+    SpatialSystem & system = SpatialSystem::Get();
+    system.Resolve(slot);
+    return system.GetGlobal(slot);
 }
 
-
+TransformMatrix Spatial::GetRenderTransform() {
+    return SpatialSystem::Get().GetRender(slot);
+}
 
 void Spatial::ReplaceTransform(Transform * t) {
-	node->RemoveTransformCallback(transformUpdate);
     if (!t) {
-        node = transformOwned;
+        node = &transformOwned;
     } else {
         node = t;
     }
-    node->AddTransformCallback(transformUpdate);
+    SpatialSystem::Get().SetSource(slot, node);
 }
 
-
 void Spatial::SetAsParent(Spatial * newParent) {
-    if (parent) {
-        for(uint32_t i = 0; i < parent->children.size(); ++i) {
-            if (parent->children[i] == this) {
-                parent->children.erase(parent->children.begin() + i);
-                break;
-            }
-        }
-        parent = nullptr;
+    if (!newParent) {
+        SpatialSystem::Get().SetParent(slot, -1);
+        return;
     }
-    
-    
-    
-    if (!newParent) return;
-    parent = newParent;
+
     assert(newParent != this);
-    newParent->children.push_back(this);
-    needsUpdate = true;
-    
-    //look for parent 
-    Spatial * p = parent->parent;
-    while(p) {
-        for(uint32_t i = 0; i < p->children.size(); ++i) {
-            assert(p->children[i] != this);
-        }
-        p = p->parent;
-    }
+    assert(!SpatialSystem::Get().HasAncestor(newParent->slot, slot));
+    SpatialSystem::Get().SetParent(slot, newParent->slot);
+}
+
+void Spatial::UpdateAll() {
+    SpatialSystem::Get().UpdateAll();
+}
+
+void Spatial::SnapshotTransforms() {
+    SpatialSystem::Get().Snapshot();
+}
+
+void Spatial::SetInterpolation(bool enable) {
+    SpatialSystem::Get().SetInterpolating(enable);
+}
+
+bool Spatial::GetInterpolation() {
+    return SpatialSystem::Get().IsInterpolating();
+}
+
+void Spatial::SetInterpolationAlpha(float alpha) {
+    SpatialSystem::Get().SetAlpha(alpha);
+}
+
+float Spatial::GetInterpolationAlpha() {
+    return SpatialSystem::Get().GetAlpha();
 }
 
 
 void Spatial::UpdateModelTransforms(RenderBufferID modelTransform) {
-    TransformMatrix normalTransform = Graphics::GetCamera3D().GetGlobalTransform() * GetGlobalTransform();
+    TransformMatrix normalTransform = Graphics::GetCamera3D().GetRenderTransform() * GetRenderTransform();
     normalTransform.Inverse();
     //normalTransform.Transpose();
     //normalTransform.ReverseMajority();
 
-    TransformMatrix m = GetGlobalTransform();
+    TransformMatrix m = GetRenderTransform();
     m.ReverseMajority();
     Graphics::GetRenderer()->UpdateBuffer(modelTransform, m.GetData(), 0, 16);
     Graphics::GetRenderer()->UpdateBuffer(modelTransform, normalTransform.GetData(), 16, 16);
@@ -136,33 +129,6 @@ void Spatial::UpdateModelTransforms(RenderBufferID modelTransform) {
 
 
 
-void Spatial::SendUpdateSignal() {
-    std::stack<Spatial*> stack;
-    
-    Spatial * current;
-    stack.push(this);
-    while(!stack.empty()) {
-        current = stack.top();
-        stack.pop();
-        current->needsUpdate = true;
-        for(uint32_t i = 0; i < current->children.size(); ++i) {
-            stack.push(current->children[i]);
-        }    
-    }
-}
-
 void Spatial::CheckUpdate() {
-    if (node->NeedsUpdate()) needsUpdate = true;
-    if (!needsUpdate) return;
-    if (parent) {
-        global = parent->GetGlobalTransform() * node->GetMatrix();
-    } else {
-        global = node->GetMatrix();
-    }
-    SendUpdateSignal();
-
-    needsUpdate = false;
-    OnUpdateTransform();
+    SpatialSystem::Get().Resolve(slot);
 }
-
-
@@ -0,0 +1,478 @@
+/*
+
+Flattened storage for the Spatial hierarchy.
+
+Every Spatial owns one slot in a set of parallel arrays: its parent's slot,
+its local and global matrices, and the bookkeeping needed to tell when
+either needs recomputing. Slots are kept sorted so that a parent always
+comes before its children, which lets UpdateAll() bring the whole
+hierarchy up to date in a single forward pass.
+
+Dirtiness is tracked with counters rather than flags pushed down the tree:
+each slot remembers the revision of its Transform and the version of its
+parent's global matrix that it was last computed from. Moving a node only
+bumps its own counter; descendants notice the change when they are next
+visited.
+
+Destroyed slots are left as holes and are squeezed out, along with any
+ordering violations caused by reparenting, at the start of UpdateAll().
+
+
+*/
+
+#ifdef __SSE__
+    #include <xmmintrin.h>
+#endif
+
+class Dynacoe::SpatialSystem {
+  public:
+
+    static SpatialSystem & Get() {
+        static SpatialSystem * system = new SpatialSystem;
+        return *system;
+    }
+
+
+    uint32_t Add(Spatial * s) {
+        uint32_t index = owner.size();
+        owner.push_back(s);
+        source.push_back(&s->transformOwned);
+        parent.push_back(-1);
+        local.emplace_back();
+        global.emplace_back();
+        previous.emplace_back();
+        interpolated.emplace_back();
+        version.push_back(0);
+        parentVersion.push_back(0);
+        localRevision.push_back(0);
+        dirty.push_back(true);
+        moved.push_back(false);
+        lastPass.push_back(0);
+        return index;
+    }
+
+    void Remove(uint32_t index) {
+        owner[index]  = nullptr;
+        source[index] = nullptr;
+        parent[index] = -1;
+        holes++;
+    }
+
+    void SetParent(uint32_t index, int32_t p) {
+        parent[index] = p;
+        dirty[index] = true;
+        if (p > (int32_t)index) needsSort = true;
+    }
+
+    void SetSource(uint32_t index, Transform * t) {
+        source[index] = t;
+        dirty[index] = true;
+    }
+
+    void Invalidate(uint32_t index) {
+        dirty[index] = true;
+    }
+
+    bool HasAncestor(uint32_t index, uint32_t ancestor) const {
+        int32_t p = parent[index];
+        while(p >= 0 && owner[p]) {
+            if ((uint32_t)p == ancestor) return true;
+            p = parent[p];
+        }
+        return false;
+    }
+
+    TransformMatrix & GetGlobal(uint32_t index) {
+        return global[index];
+    }
+
+    // Returns the matrix to draw the slot with: the global matrix, or
+    // a blend between it and its state at the last snapshot.
+    TransformMatrix & GetRender(uint32_t index) {
+        Resolve(index);
+        if (!interpolating || !moved[index]) return global[index];
+
+        blend(previous[index].GetData(), global[index].GetData(), alpha, interpolated[index].GetData());
+        return interpolated[index];
+    }
+
+    // Brings a single slot up to date by walking its ancestors.
+    void Resolve(uint32_t index) {
+        int32_t p = parent[index];
+        if (p >= 0 && owner[p]) Resolve(p);
+        refresh(index);
+    }
+
+    void UpdateAll() {
+        refreshAll();
+        if (!interpolating) return;
+
+        // slots still between their previous and current matrices have
+        // a new blend to report even if nothing about them changed.
+        for(uint32_t i = 0; i < owner.size(); ++i) {
+            if (!owner[i] || !moved[i]) continue;
+            if (lastPass[i] != pass) owner[i]->OnUpdateTransform();
+            if (!memcmp(previous[i].GetData(), global[i].GetData(), sizeof(float)*16))
+                moved[i] = false;
+        }
+    }
+
+    // Records the current global matrices as the start point
+    // for interpolation. Only slots that moved can differ from their 
+    // snapshot, so only those are copied.
+    void Snapshot() {
+        if (!interpolating) return;
+        refreshAll();
+        for(uint32_t i = 0; i < owner.size(); ++i) {
+            if (moved[i]) previous[i] = global[i];
+        }
+    }
+
+    void SetInterpolating(bool enable) {
+        if (interpolating == enable) return;
+        interpolating = enable;
+        if (enable) {
+            // slots aren't tracked while interpolation is off, so start
+            // everything from where it is now.
+            refreshAll();
+            previous = global;
+            return;
+        }
+
+        // everything that was drawn blended needs its exact matrix back.
+        for(uint32_t i = 0; i < owner.size(); ++i) {
+            if (!moved[i]) continue;
+            moved[i] = false;
+            if (owner[i]) owner[i]->OnUpdateTransform();
+        }
+    }
+
+    bool IsInterpolating() const {
+        return interpolating;
+    }
+
+    void SetAlpha(float a) {
+        alpha = a < 0.f ? 0.f : (a > 1.f ? 1.f : a);
+    }
+
+    float GetAlpha() const {
+        return alpha;
+    }
+
+
+  private:
+    SpatialSystem() {
+        holes = 0;
+        needsSort = false;
+        interpolating = false;
+        alpha = 1.f;
+        pass = 0;
+    }
+
+    void refreshAll() {
+        if (needsSort || holes*4 > owner.size()) reorder();
+        pass++;
+
+        // parents always precede their children, so by the time a slot
+        // is visited its parent's global matrix is final.
+        for(uint32_t i = 0; i < owner.size(); ++i) {
+            if (owner[i]) refresh(i);
+        }
+    }
+
+    // Recomputes the slot if its transform or its parent changed since it
+    // was last computed.
+    void refresh(uint32_t i) {
+        int32_t p = parent[i];
+        if (p >= 0 && !owner[p]) {
+            // parent was destroyed out from under this node.
+            parent[i] = p = -1;
+            dirty[i] = true;
+        }
+
+        Transform * t = source[i];
+        bool changed = dirty[i] || t->GetRevision() != localRevision[i];
+        if (changed) {
+            local[i] = t->GetMatrix();
+            localRevision[i] = t->GetRevision();
+            dirty[i] = false;
+        }
+
+        if (p >= 0) {
+            if (!changed && parentVersion[i] == version[p]) return;
+            multiply(global[p].GetData(), local[i].GetData(), global[i].GetData());
+            parentVersion[i] = version[p];
+        } else {
+            if (!changed) return;
+            global[i] = local[i];
+        }
+        // a new slot has nowhere to blend from.
+        if (!version[i]) previous[i] = global[i];
+        version[i]++;
+        lastPass[i] = pass;
+        if (interpolating) moved[i] = true;
+
+        // the callback may create new Spatials, so no references into
+        // the arrays may be held past this point.
+        owner[i]->OnUpdateTransform();
+    }
+
+
+    // Blends between two row-major matrices by splitting each into 
+    // translation, rotation and scale, so that a turning object keeps 
+    // its size through the blend. Matrices that don't split that way 
+    // (projections, zero scale) are blended element by element.
+    static void blend(const float * a, const float * b, float t, float * out) {
+        float ta[3], tb[3], sa[3], sb[3], qa[4], qb[4];
+        if (!decompose(a, ta, qa, sa) || !decompose(b, tb, qb, sb)) {
+            for(int i = 0; i < 16; ++i) {
+                out[i] = a[i] + (b[i] - a[i])*t;
+            }
+            return;
+        }
+
+        float tr[3], sc[3], q[4];
+        for(int i = 0; i < 3; ++i) {
+            tr[i] = ta[i] + (tb[i] - ta[i])*t;
+            sc[i] = sa[i] + (sb[i] - sa[i])*t;
+        }
+
+        // normalized lerp along the shorter arc. Steps are short, so 
+        // this is close enough to a slerp.
+        float dot = qa[0]*qb[0] + qa[1]*qb[1] + qa[2]*qb[2] + qa[3]*qb[3];
+        float sign = dot < 0.f ? -1.f : 1.f;
+        float len = 0.f;
+        for(int i = 0; i < 4; ++i) {
+            q[i] = qa[i] + (sign*qb[i] - qa[i])*t;
+            len += q[i]*q[i];
+        }
+        len = sqrtf(len);
+        for(int i = 0; i < 4; ++i) q[i] /= len;
+
+        float w = q[0], x = q[1], y = q[2], z = q[3];
+        float r[9] = {
+            1 - 2*(y*y + z*z),     2*(x*y - w*z),     2*(x*z + w*y),
+                2*(x*y + w*z), 1 - 2*(x*x + z*z),     2*(y*z - w*x),
+                2*(x*z - w*y),     2*(y*z + w*x), 1 - 2*(x*x + y*y)
+        };
+        for(int row = 0; row < 3; ++row) {
+            for(int col = 0; col < 3; ++col) {
+                out[row*4 + col] = r[row*3 + col]*sc[col];
+            }
+            out[row*4 + 3] = tr[row];
+        }
+        out[12] = out[13] = out[14] = 0.f;
+        out[15] = 1.f;
+    }
+
+    // Splits an affine row-major matrix into translation, a unit 
+    // quaternion (w, x, y, z) and per-axis scale. Returns false if the 
+    // matrix can't be split.
+    static bool decompose(const float * m, float * tr, float * q, float * sc) {
+        if (m[12] != 0.f || m[13] != 0.f || m[14] != 0.f || m[15] != 1.f) return false;
+
+        float r[9];
+        for(int col = 0; col < 3; ++col) {
+            sc[col] = sqrtf(m[col]*m[col] + m[4+col]*m[4+col] + m[8+col]*m[8+col]);
+            if (sc[col] < 1e-8f) return false;
+            for(int row = 0; row < 3; ++row) {
+                r[row*3 + col] = m[row*4 + col] / sc[col];
+            }
+        }
+        tr[0] = m[3];
+        tr[1] = m[7];
+        tr[2] = m[11];
+
+        // a mirrored matrix has no rotation; carry the flip in the scale.
+        float det = r[0]*(r[4]*r[8] - r[5]*r[7]) -
+                    r[1]*(r[3]*r[8] - r[5]*r[6]) +
+                    r[2]*(r[3]*r[7] - r[4]*r[6]);
+        if (det < 0.f) {
+            sc[0] = -sc[0];
+            r[0] = -r[0]; r[3] = -r[3]; r[6] = -r[6];
+        }
+
+        float trace = r[0] + r[4] + r[8];
+        if (trace > 0.f) {
+            float s = sqrtf(trace + 1.f)*2.f;
+            q[0] = .25f*s;
+            q[1] = (r[7] - r[5]) / s;
+            q[2] = (r[2] - r[6]) / s;
+            q[3] = (r[3] - r[1]) / s;
+        } else if (r[0] > r[4] && r[0] > r[8]) {
+            float s = sqrtf(1.f + r[0] - r[4] - r[8])*2.f;
+            q[0] = (r[7] - r[5]) / s;
+            q[1] = .25f*s;
+            q[2] = (r[1] + r[3]) / s;
+            q[3] = (r[2] + r[6]) / s;
+        } else if (r[4] > r[8]) {
+            float s = sqrtf(1.f + r[4] - r[0] - r[8])*2.f;
+            q[0] = (r[2] - r[6]) / s;
+            q[1] = (r[1] + r[3]) / s;
+            q[2] = .25f*s;
+            q[3] = (r[5] + r[7]) / s;
+        } else {
+            float s = sqrtf(1.f + r[8] - r[0] - r[4])*2.f;
+            q[0] = (r[3] - r[1]) / s;
+            q[1] = (r[2] + r[6]) / s;
+            q[2] = (r[5] + r[7]) / s;
+            q[3] = .25f*s;
+        }
+        return true;
+    }
+
+
+    // out = a * b for row-major 4x4 matrices.
+    static void multiply(const float * a, const float * b, float * out) {
+        #ifdef __SSE__
+            __m128 b0 = _mm_loadu_ps(b);
+            __m128 b1 = _mm_loadu_ps(b+4);
+            __m128 b2 = _mm_loadu_ps(b+8);
+            __m128 b3 = _mm_loadu_ps(b+12);
+            for(int y = 0; y < 4; ++y) {
+                __m128 row =             _mm_mul_ps(_mm_set1_ps(a[0]), b0);
+                row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[1]), b1));
+                row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[2]), b2));
+                row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[3]), b3));
+                _mm_storeu_ps(out + y*4, row);
+                a += 4;
+            }
+        #else
+            for(int y = 0; y < 4; ++y) {
+                for(int x = 0; x < 4; ++x) {
+                    out[y*4 + x] = a[0] * b[x]   +
+                                   a[1] * b[x+4] +
+                                   a[2] * b[x+8] +
+                                   a[3] * b[x+12];
+                }
+                a += 4;
+            }
+        #endif
+    }
+
+
+    uint32_t depthOf(uint32_t i, std::vector<uint32_t> & depth) {
+        if (depth[i] != UINT32_MAX) return depth[i];
+        int32_t p = parent[i];
+        depth[i] = (p < 0 ? 0 : depthOf(p, depth) + 1);
+        return depth[i];
+    }
+
+    // Drops holes and re-sorts the slots by depth, which keeps
+    // every parent ahead of its children.
+    void reorder() {
+        uint32_t count = owner.size();
+        for(uint32_t i = 0; i < count; ++i) {
+            if (parent[i] >= 0 && !owner[parent[i]]) {
+                parent[i] = -1;
+                dirty[i] = true;
+            }
+        }
+
+        std::vector<uint32_t> depth(count, UINT32_MAX);
+        std::vector<uint32_t> depthCount;
+        for(uint32_t i = 0; i < count; ++i) {
+            if (!owner[i]) continue;
+            uint32_t d = depthOf(i, depth);
+            if (d >= depthCount.size()) depthCount.resize(d+1, 0);
+            depthCount[d]++;
+        }
+
+        // counting sort on depth; stable, so siblings keep their order.
+        uint32_t offset = 0;
+        for(uint32_t d = 0; d < depthCount.size(); ++d) {
+            uint32_t n = depthCount[d];
+            depthCount[d] = offset;
+            offset += n;
+        }
+
+        std::vector<uint32_t> remap(count, UINT32_MAX);
+        for(uint32_t i = 0; i < count; ++i) {
+            if (!owner[i]) continue;
+            remap[i] = depthCount[depth[i]]++;
+        }
+
+        uint32_t live = offset;
+        std::vector<Spatial *>       newOwner(live);
+        std::vector<Transform *>     newSource(live);
+        std::vector<int32_t>         newParent(live);
+        std::vector<TransformMatrix> newLocal(live);
+        std::vector<TransformMatrix> newGlobal(live);
+        std::vector<TransformMatrix> newPrevious(live);
+        std::vector<uint32_t>        newVersion(live);
+        std::vector<uint32_t>        newParentVersion(live);
+        std::vector<uint32_t>        newLocalRevision(live);
+        std::vector<uint8_t>         newDirty(live);
+        std::vector<uint8_t>         newMoved(live);
+        std::vector<uint32_t>        newLastPass(live);
+        for(uint32_t i = 0; i < count; ++i) {
+            uint32_t n = remap[i];
+            if (n == UINT32_MAX) continue;
+            newOwner[n]         = owner[i];
+            newSource[n]        = source[i];
+            newParent[n]        = parent[i] < 0 ? -1 : (int32_t)remap[parent[i]];
+            newLocal[n]         = local[i];
+            newGlobal[n]        = global[i];
+            newPrevious[n]      = previous[i];
+            newVersion[n]       = version[i];
+            newParentVersion[n] = parentVersion[i];
+            newLocalRevision[n] = localRevision[i];
+            newDirty[n]         = dirty[i];
+            newMoved[n]         = moved[i];
+            newLastPass[n]      = lastPass[i];
+            owner[i]->slot = n;
+        }
+
+        owner.swap(newOwner);
+        source.swap(newSource);
+        parent.swap(newParent);
+        local.swap(newLocal);
+        global.swap(newGlobal);
+        previous.swap(newPrevious);
+        interpolated.resize(live);
+        version.swap(newVersion);
+        parentVersion.swap(newParentVersion);
+        localRevision.swap(newLocalRevision);
+        dirty.swap(newDirty);
+        moved.swap(newMoved);
+        lastPass.swap(newLastPass);
+
+        holes = 0;
+        needsSort = false;
+    }
+
+
+
+    std::vector<Spatial *>       owner;
+    std::vector<Transform *>     source;
+    std::vector<int32_t>         parent;
+    std::vector<TransformMatrix> local;
+    std::vector<TransformMatrix> global;
+
+    // incremented each time the global matrix is recomputed.
+    std::vector<uint32_t>        version;
+
+    // parent's version and transform's revision at the last recompute.
+    std::vector<uint32_t>        parentVersion;
+    std::vector<uint32_t>        localRevision;
+
+    // bytes rather than bits so that slots can be touched from separate threads.
+    std::vector<uint8_t>         dirty;
+
+    // global matrices as of the last Snapshot(), and scratch space for
+    // blending between them and the current ones.
+    std::vector<TransformMatrix> previous;
+    std::vector<TransformMatrix> interpolated;
+
+    // set while a slot's previous and global matrices may differ.
+    std::vector<uint8_t>         moved;
+
+    // the refreshAll() pass in which each slot was last recomputed.
+    std::vector<uint32_t>        lastPass;
+
+    uint32_t holes;
+    bool needsSort;
+    bool interpolating;
+    float alpha;
+    uint32_t pass;
+};
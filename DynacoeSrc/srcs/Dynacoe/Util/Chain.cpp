@@ -71,7 +71,8 @@ static char toAlBhedTable[] = {
     0, 0, 0, 0, 0,
 };
 
-static char working_buffer[chain_working_cstr_length_bytes];
+// per thread, so Chains can be built from any thread (i.e. for Console output)
+static thread_local char working_buffer[chain_working_cstr_length_bytes];
 
 
 
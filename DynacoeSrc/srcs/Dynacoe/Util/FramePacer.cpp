@@ -0,0 +1,107 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#include <Dynacoe/Util/FramePacer.h>
+#include <Dynacoe/Util/Time.h>
+#include <cstring>
+
+using namespace Dynacoe;
+
+
+FramePacer::FramePacer() {
+    fps = 0;
+    periodNs = 0;
+    periodRemainder = 0;
+    remainder = 0;
+    deadline = 0;
+    spinNs = 200000;
+    started = false;
+    ResetJitter();
+}
+
+void FramePacer::SetTargetFPS(int f) {
+    if (f == fps) return;
+    fps = f;
+    started = false;
+    if (fps <= 0) return;
+
+    // 1e9 / fps rarely divides evenly; the leftover nanoseconds are 
+    // carried from frame to frame so that the rate doesn't drift.
+    periodNs        = 1000000000ull / fps;
+    periodRemainder = 1000000000ull % fps;
+}
+
+void FramePacer::Wait() {
+    if (fps <= 0) return;
+    uint64_t now = Time::NsSinceStartup();
+    if (!started) {
+        started = true;
+        remainder = 0;
+        deadline = now;
+    }
+
+    deadline += periodNs;
+    remainder += periodRemainder;
+    if (remainder >= (uint64_t)fps) {
+        remainder -= fps;
+        deadline++;
+    }
+
+    if (now >= deadline) {
+        jitter.missed++;
+        // too far behind to catch up; start over from here.
+        if (now - deadline > periodNs)
+            deadline = now;
+        return;
+    }
+
+    Time::SleepUntilNs(deadline, spinNs);
+    record(Time::NsSinceStartup() - deadline);
+}
+
+void FramePacer::ResetJitter() {
+    memset(&jitter, 0, sizeof(JitterStats));
+}
+
+void FramePacer::record(uint64_t lateNs) {
+    uint64_t us = lateNs / 1000;
+    int bucket = 0;
+    while(us && bucket < JitterBuckets-1) {
+        us >>= 1;
+        bucket++;
+    }
+    jitter.buckets[bucket]++;
+    jitter.frames++;
+    jitter.totalNs += lateNs;
+    if (lateNs > jitter.maxNs) jitter.maxNs = lateNs;
+}
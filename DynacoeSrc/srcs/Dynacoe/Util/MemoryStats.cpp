@@ -0,0 +1,113 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#include <Dynacoe/Util/MemoryStats.h>
+#include <atomic>
+
+using namespace Dynacoe;
+
+namespace {
+
+struct Counters {
+    std::atomic<int64_t>  live;
+    std::atomic<int64_t>  peak;
+    std::atomic<int64_t>  count;
+    std::atomic<uint64_t> budget;
+};
+
+// Zero-initialized before any constructor can run, so 
+// tracking from other static objects is safe.
+Counters counters[MemoryStats::CategoryCount];
+
+const char * names[MemoryStats::CategoryCount] = {
+    "Entities",
+    "Components",
+    "Assets",
+    "Audio Data",
+    "Audio Channels",
+    "Textures",
+    "Render Buffers"
+};
+
+}
+
+
+
+void MemoryStats::Track(Category c, int64_t bytes, int64_t count) {
+    Counters & ctr = counters[(int)c];
+    int64_t live = ctr.live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (count) ctr.count.fetch_add(count, std::memory_order_relaxed);
+
+    int64_t peak = ctr.peak.load(std::memory_order_relaxed);
+    while(live > peak && !ctr.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+}
+
+MemoryStats::Usage MemoryStats::Get(Category c) {
+    Counters & ctr = counters[(int)c];
+    int64_t live  = ctr.live.load(std::memory_order_relaxed);
+    int64_t count = ctr.count.load(std::memory_order_relaxed);
+
+    Usage out;
+    out.liveBytes   = live  > 0 ? live  : 0;
+    out.peakBytes   = ctr.peak.load(std::memory_order_relaxed);
+    out.count       = count > 0 ? count : 0;
+    out.budgetBytes = ctr.budget.load(std::memory_order_relaxed);
+    return out;
+}
+
+const char * MemoryStats::GetName(Category c) {
+    return names[(int)c];
+}
+
+uint64_t MemoryStats::GetTotalLive() {
+    uint64_t out = 0;
+    for(int i = 0; i < CategoryCount; ++i) {
+        out += Get((Category)i).liveBytes;
+    }
+    return out;
+}
+
+void MemoryStats::ResetPeaks() {
+    for(int i = 0; i < CategoryCount; ++i) {
+        counters[i].peak = counters[i].live.load();
+    }
+}
+
+void MemoryStats::SetBudget(Category c, uint64_t bytes) {
+    counters[(int)c].budget = bytes;
+}
+
+bool MemoryStats::IsOverBudget(Category c) {
+    Usage u = Get(c);
+    return u.budgetBytes && u.liveBytes > u.budgetBytes;
+}
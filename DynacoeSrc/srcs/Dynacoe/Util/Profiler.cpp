@@ -0,0 +1,352 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#include <Dynacoe/Util/Profiler.h>
+#include <Dynacoe/Util/Time.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <mutex>
+
+#ifdef DC_OS_LINUX
+    #include <time.h>
+#endif
+
+using namespace Dynacoe;
+
+std::atomic<bool> Profiler::enabled(false);
+
+namespace {
+
+// Zones each thread can hold between gathers. Must be a power of 2.
+const uint32_t ringSize = 1 << 15;
+
+// Most zones a capture keeps before it stops growing.
+const size_t captureLimit = 1 << 21;
+
+
+// Single producer (the owning thread), single consumer (EndFrame()).
+struct ThreadRing {
+    Profiler::Zone zones[ringSize];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint64_t> dropped;
+    uint32_t depth;
+    uint32_t index;
+    const char * name;
+};
+
+
+struct ZoneKey {
+    const char * category;
+    const char * name;
+    bool operator==(const ZoneKey & other) const {
+        return category == other.category && name == other.name;
+    }
+};
+
+struct ZoneKeyHash {
+    size_t operator()(const ZoneKey & k) const {
+        return std::hash<const char *>()(k.category) * 31 + std::hash<const char *>()(k.name);
+    }
+};
+
+
+struct ProfilerState {
+    std::mutex ringLock;
+    std::vector<ThreadRing*> rings;
+
+    std::mutex gatherLock;
+    std::vector<Profiler::Zone> lastFrame;
+    std::unordered_map<ZoneKey, uint64_t, ZoneKeyHash> totals;
+    uint32_t frames = 0;
+    uint64_t dropped = 0;
+
+    bool capturing = false;
+    std::vector<Profiler::Zone> captured;
+
+    std::mutex internLock;
+    std::unordered_set<std::string> interned;
+};
+
+ProfilerState & state() {
+    static ProfilerState * s = new ProfilerState();
+    return *s;
+}
+
+
+thread_local ThreadRing * localRing = nullptr;
+
+// The calling thread's ring, which is made the first time it's needed.
+// Rings live as long as the process does.
+ThreadRing * ring() {
+    if (localRing) return localRing;
+    ThreadRing * r = new ThreadRing;
+    r->head = 0;
+    r->tail = 0;
+    r->dropped = 0;
+    r->depth = 0;
+    r->name = nullptr;
+
+    ProfilerState & s = state();
+    std::lock_guard<std::mutex> guard(s.ringLock);
+    r->index = s.rings.size();
+    s.rings.push_back(r);
+    localRing = r;
+    return r;
+}
+
+
+void writeEscaped(std::ostream & out, const char * str) {
+    out << '"';
+    for(; *str; ++str) {
+        switch(*str) {
+          case '"':  out << "\\\""; break;
+          case '\\': out << "\\\\"; break;
+          case '\n': out << "\\n";  break;
+          case '\t': out << "\\t";  break;
+          default:
+            if ((unsigned char)*str < 0x20) {
+                out << ' ';
+            } else {
+                out << *str;
+            }
+        }
+    }
+    out << '"';
+}
+
+}
+
+
+
+
+void Profiler::SetEnabled(bool b) {
+    enabled.store(b, std::memory_order_relaxed);
+}
+
+uint64_t Profiler::Now() {
+    #ifdef DC_OS_LINUX
+        // RAW isn't slewed by NTP, so short zones aren't stretched or squashed.
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &time);
+        return time.tv_sec * 1000000000ull + time.tv_nsec;
+    #else
+        // kept above 0, which Scope takes to mean "not recording".
+        return Time::NsSinceStartup() + 1;
+    #endif
+}
+
+const char * Profiler::Intern(const std::string & str) {
+    ProfilerState & s = state();
+    std::lock_guard<std::mutex> guard(s.internLock);
+    return s.interned.insert(str).first->c_str();
+}
+
+void Profiler::SetThreadName(const char * name) {
+    ring()->name = name;
+}
+
+
+uint64_t Profiler::begin() {
+    ring()->depth++;
+    return Now();
+}
+
+uint64_t Profiler::end(const char * name, const char * category, uint64_t beginNs) {
+    uint64_t now = Now();
+    ThreadRing * r = ring();
+    r->depth--;
+
+    uint32_t head = r->head.load(std::memory_order_relaxed);
+    if (head - r->tail.load(std::memory_order_acquire) >= ringSize) {
+        r->dropped.fetch_add(1, std::memory_order_relaxed);
+        return now;
+    }
+
+    Zone & z = r->zones[head & (ringSize-1)];
+    z.name = name;
+    z.category = category;
+    z.beginNs = beginNs;
+    z.endNs = now;
+    z.thread = r->index;
+    z.depth = r->depth;
+    r->head.store(head+1, std::memory_order_release);
+    return now;
+}
+
+
+
+
+void Profiler::EndFrame() {
+    ProfilerState & s = state();
+    std::vector<ThreadRing*> rings;
+    {
+        std::lock_guard<std::mutex> guard(s.ringLock);
+        rings = s.rings;
+    }
+
+    std::lock_guard<std::mutex> guard(s.gatherLock);
+    s.lastFrame.clear();
+    for(size_t i = 0; i < rings.size(); ++i) {
+        ThreadRing * r = rings[i];
+        uint32_t tail = r->tail.load(std::memory_order_relaxed);
+        uint32_t head = r->head.load(std::memory_order_acquire);
+        for(; tail != head; ++tail) {
+            s.lastFrame.push_back(r->zones[tail & (ringSize-1)]);
+        }
+        r->tail.store(head, std::memory_order_release);
+        s.dropped += r->dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    // frames that weren't profiled don't count toward the averages.
+    if (s.lastFrame.empty() && !IsEnabled()) return;
+
+    for(size_t i = 0; i < s.lastFrame.size(); ++i) {
+        const Zone & z = s.lastFrame[i];
+        s.totals[{z.category, z.name}] += z.endNs - z.beginNs;
+    }
+    s.frames++;
+
+    if (s.capturing && s.captured.size() < captureLimit) {
+        size_t count = s.lastFrame.size();
+        if (s.captured.size() + count > captureLimit)
+            count = captureLimit - s.captured.size();
+        s.captured.insert(s.captured.end(), s.lastFrame.begin(), s.lastFrame.begin() + count);
+    }
+}
+
+const std::vector<Profiler::Zone> & Profiler::GetLastFrame() {
+    return state().lastFrame;
+}
+
+double Profiler::GetAverageMS(const char * category, const char * name) {
+    ProfilerState & s = state();
+    std::lock_guard<std::mutex> guard(s.gatherLock);
+    if (!s.frames) return 0.0;
+
+    // names may be equal without being the same pointer, 
+    // e.g. the same literal in 2 different files.
+    uint64_t total = 0;
+    for(auto it = s.totals.begin(); it != s.totals.end(); ++it) {
+        if (!strcmp(it->first.category, category) &&
+            !strcmp(it->first.name, name)) {
+            total += it->second;
+        }
+    }
+    return (total / (double)s.frames) / 1000000.0;
+}
+
+uint32_t Profiler::GetTotalFrames() {
+    return state().frames;
+}
+
+uint64_t Profiler::GetDroppedCount() {
+    return state().dropped;
+}
+
+void Profiler::ResetTotals() {
+    ProfilerState & s = state();
+    std::lock_guard<std::mutex> guard(s.gatherLock);
+    s.totals.clear();
+    s.frames = 0;
+    s.dropped = 0;
+}
+
+
+
+
+void Profiler::BeginCapture() {
+    ProfilerState & s = state();
+    std::lock_guard<std::mutex> guard(s.gatherLock);
+    s.captured.clear();
+    s.capturing = true;
+}
+
+void Profiler::EndCapture() {
+    ProfilerState & s = state();
+    std::lock_guard<std::mutex> guard(s.gatherLock);
+    s.capturing = false;
+}
+
+bool Profiler::IsCapturing() {
+    return state().capturing;
+}
+
+bool Profiler::ExportTrace(const std::string & path) {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    if (!out.is_open()) return false;
+
+    ProfilerState & s = state();
+    std::lock_guard<std::mutex> guard(s.gatherLock);
+
+    uint64_t origin = UINT64_MAX;
+    for(size_t i = 0; i < s.captured.size(); ++i) {
+        if (s.captured[i].beginNs < origin) origin = s.captured[i].beginNs;
+    }
+
+    // timestamps are in microseconds.
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> ringGuard(s.ringLock);
+        for(size_t i = 0; i < s.rings.size(); ++i) {
+            if (!s.rings[i]->name) continue;
+            if (!first) out << ",\n";
+            first = false;
+            out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << s.rings[i]->index << ",\"args\":{\"name\":";
+            writeEscaped(out, s.rings[i]->name);
+            out << "}}";
+        }
+    }
+
+    char number[64];
+    for(size_t i = 0; i < s.captured.size(); ++i) {
+        const Zone & z = s.captured[i];
+        if (!first) out << ",\n";
+        first = false;
+        out << "{\"ph\":\"X\",\"name\":";
+        writeEscaped(out, z.name);
+        out << ",\"cat\":";
+        writeEscaped(out, z.category);
+        snprintf(number, sizeof(number), ",\"ts\":%.3f,\"dur\":%.3f", 
+            (z.beginNs - origin) / 1000.0, 
+            (z.endNs - z.beginNs) / 1000.0
+        );
+        out << number << ",\"pid\":1,\"tid\":" << z.thread << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return out.good();
+}
@@ -0,0 +1,194 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+
+#include <Dynacoe/Util/SlabAllocator.h>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+
+using namespace Dynacoe;
+
+static const uint32_t granularity_c = 16;
+static const uint32_t classCount_c  = 64;   // up to 1024 bytes
+static const uint32_t slabSize_c    = 64*1024;
+static const uint32_t release_c     = UINT32_MAX;
+
+
+static uint32_t sizeToClass(std::size_t size) {
+    return size ? (size - 1) / granularity_c : 0;
+}
+
+
+SlabAllocator::SlabAllocator(const char * n) {
+    name = n;
+    enabled = -1;
+}
+
+std::size_t SlabAllocator::GetMaxBlockSize() {
+    return granularity_c * classCount_c;
+}
+
+void SlabAllocator::refill(uint32_t index) {
+    SizeClass & sc = classes[index];
+    const uint32_t blockSize = (index + 1) * granularity_c;
+    char * slab = (char*)::operator new(slabSize_c);
+    sc.slabs.push_back(slab);
+
+    // thread the new blocks onto the free list, lowest address first
+    // so that consecutive allocations are laid out consecutively.
+    const uint32_t count = slabSize_c / blockSize;
+    for(uint32_t i = count; i > 0; --i) {
+        FreeBlock * block = (FreeBlock*)(slab + (i-1)*blockSize);
+        block->next = sc.freeList;
+        sc.freeList = block;
+    }
+}
+
+
+void * SlabAllocator::Allocate(std::size_t size) {
+    if (enabled < 0) {
+        enabled = getenv("DYNACOE_NO_SLAB") ? 0 : 1;
+        if (enabled)
+            classes.resize(classCount_c, SizeClass{nullptr, 0, 0, {}});
+    }
+
+    if (!enabled || size > GetMaxBlockSize())
+        return ::operator new(size);
+
+
+    const uint32_t index = sizeToClass(size);
+    SizeClass & sc = classes[index];
+    if (!sc.freeList) refill(index);
+
+    FreeBlock * block = sc.freeList;
+    sc.freeList = block->next;
+    if (++sc.live > sc.peak) sc.peak = sc.live;
+    return block;
+}
+
+
+void SlabAllocator::Free(void * ptr, std::size_t size) {
+    if (!ptr) return;
+    if (enabled <= 0 || size > GetMaxBlockSize()) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    SizeClass & sc = classes[sizeToClass(size)];
+    FreeBlock * block = (FreeBlock*)ptr;
+    block->next = sc.freeList;
+    sc.freeList = block;
+    sc.live--;
+}
+
+
+uint32_t SlabAllocator::ReleaseEmptySlabs() {
+    uint32_t released = 0;
+    for(uint32_t i = 0; i < classes.size(); ++i) {
+        released += releaseEmptySlabs(i);
+    }
+    return released;
+}
+
+
+uint32_t SlabAllocator::releaseEmptySlabs(uint32_t index) {
+    SizeClass & sc = classes[index];
+    const uint32_t blockSize = (index + 1) * granularity_c;
+    const uint32_t perSlab = slabSize_c / blockSize;
+
+    // With the spare kept, releasing anything takes two slabs' worth of free blocks.
+    if (sc.slabs.size()*perSlab - sc.live < 2*perSlab) return 0;
+
+
+    // count the free blocks of each slab
+    std::sort(sc.slabs.begin(), sc.slabs.end());
+    freeCounts.assign(sc.slabs.size(), 0);
+    auto slabOf = [&sc](const FreeBlock * block) {
+        return std::upper_bound(sc.slabs.begin(), sc.slabs.end(), (const char*)block) - sc.slabs.begin() - 1;
+    };
+    for(FreeBlock * block = sc.freeList; block; block = block->next) {
+        freeCounts[slabOf(block)]++;
+    }
+
+    // the first empty slab is the spare; the others are marked for release.
+    bool spare = false;
+    uint32_t released = 0;
+    for(size_t i = 0; i < sc.slabs.size(); ++i) {
+        if (freeCounts[i] != perSlab) continue;
+        if (!spare) {
+            spare = true;
+            continue;
+        }
+        freeCounts[i] = release_c;
+        released++;
+    }
+    if (!released) return 0;
+
+
+    // drop the released slabs' blocks from the free list, keeping its order
+    FreeBlock ** link = &sc.freeList;
+    while(*link) {
+        if (freeCounts[slabOf(*link)] == release_c) {
+            *link = (*link)->next;
+        } else {
+            link = &(*link)->next;
+        }
+    }
+
+    size_t kept = 0;
+    for(size_t i = 0; i < sc.slabs.size(); ++i) {
+        if (freeCounts[i] != release_c) {
+            sc.slabs[kept++] = sc.slabs[i];
+        } else {
+            ::operator delete(sc.slabs[i]);
+        }
+    }
+    sc.slabs.resize(kept);
+    return released;
+}
+
+
+std::vector<SlabAllocator::SizeClassStats> SlabAllocator::GetStats() const {
+    std::vector<SizeClassStats> out;
+    for(uint32_t i = 0; i < classes.size(); ++i) {
+        if (!classes[i].peak) continue;
+        out.push_back({
+            (i+1) * granularity_c,
+            classes[i].live,
+            classes[i].peak,
+            classes[i].slabs.size()
+        });
+    }
+    return out;
+}
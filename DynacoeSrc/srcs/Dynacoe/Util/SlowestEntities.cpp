@@ -0,0 +1,282 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+#include <Dynacoe/Util/SlowestEntities.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+using namespace Dynacoe;
+
+namespace {
+
+struct Kept {
+    Entity * ent;
+    std::atomic<int32_t> * slot; // the Entity's index into the heap
+    Entity::ID id;
+    float stepMS;
+    float drawMS;
+    bool stepped;   // reported this frame
+    bool drawn;
+
+    float Key() const { return stepMS + drawMS; }
+};
+
+// Averages below this are dropped from the list.
+const float negligible_ms_c = .001f;
+
+std::atomic<bool>  enabled(false);
+std::atomic<float> smoothing(.1f);
+
+// The average an Entity has to beat to be let in,
+// or less than 0 while there is still room.
+std::atomic<float> floorMS(-1.f);
+
+// Whether anything stepped / drew this frame at all. Averages
+// only decay for a kind of update that actually happened.
+std::atomic<bool> anyStepped(false);
+std::atomic<bool> anyDrawn(false);
+
+std::mutex lock;
+std::vector<Kept> heap; // min-heap on Key(), fastest at the front
+uint32_t capacity = 40;
+Entity::ID subtree;
+
+}
+
+
+// The functions below expect the lock to be held.
+static void place(uint32_t i, const Kept & k) {
+    heap[i] = k;
+    k.slot->store(i, std::memory_order_relaxed);
+}
+
+static void siftUp(uint32_t i) {
+    Kept k = heap[i];
+    while(i) {
+        uint32_t parent = (i-1)/2;
+        if (heap[parent].Key() <= k.Key()) break;
+        place(i, heap[parent]);
+        i = parent;
+    }
+    place(i, k);
+}
+
+static void siftDown(uint32_t i) {
+    Kept k = heap[i];
+    uint32_t size = heap.size();
+    while(true) {
+        uint32_t child = i*2+1;
+        if (child >= size) break;
+        if (child+1 < size && heap[child+1].Key() < heap[child].Key()) child++;
+        if (k.Key() <= heap[child].Key()) break;
+        place(i, heap[child]);
+        i = child;
+    }
+    place(i, k);
+}
+
+static void removeAt(uint32_t i) {
+    heap[i].slot->store(-1, std::memory_order_relaxed);
+    Kept last = heap.back();
+    heap.pop_back();
+    if (i < heap.size()) {
+        place(i, last);
+        siftUp(i);
+        siftDown(last.slot->load(std::memory_order_relaxed));
+    }
+}
+
+static void empty() {
+    for(size_t i = 0; i < heap.size(); ++i) {
+        heap[i].slot->store(-1, std::memory_order_relaxed);
+    }
+    heap.clear();
+}
+
+static void updateFloor() {
+    floorMS.store(heap.size() >= capacity ? heap[0].Key() : -1.f, std::memory_order_relaxed);
+}
+
+
+
+
+void SlowestEntities::Report(Entity * ent, bool draw, double ms) {
+    float s = smoothing.load(std::memory_order_relaxed);
+    float & avg = draw ? ent->drawCost : ent->stepCost;
+    avg += s * ((float)ms - avg);
+
+    std::atomic<bool> & seen = draw ? anyDrawn : anyStepped;
+    if (!seen.load(std::memory_order_relaxed))
+        seen.store(true, std::memory_order_relaxed);
+
+    // most Entities are turned away here without the lock.
+    float key = ent->stepCost + ent->drawCost;
+    if (ent->costSlot.load(std::memory_order_relaxed) < 0 &&
+        key <= floorMS.load(std::memory_order_relaxed)) return;
+
+
+    std::lock_guard<std::mutex> guard(lock);
+    int32_t slot = ent->costSlot.load(std::memory_order_relaxed);
+    if (slot >= 0) {
+        Kept & k = heap[slot];
+        k.stepMS = ent->stepCost;
+        k.drawMS = ent->drawCost;
+        (draw ? k.drawn : k.stepped) = true;
+        siftUp(slot);
+        siftDown(ent->costSlot.load(std::memory_order_relaxed));
+    } else {
+        if (!enabled.load(std::memory_order_relaxed) || key < negligible_ms_c) return;
+        if (heap.size() >= capacity && key <= heap[0].Key()) return;
+
+        // only candidates pay for the ancestry walk.
+        if (subtree.Valid()) {
+            Entity * root = subtree.Identify();
+            if (ent != root && !ent->isWithin(root)) return;
+        }
+
+        Kept k = {ent, &ent->costSlot, ent->GetID(), ent->stepCost, ent->drawCost, !draw, draw};
+        if (heap.size() >= capacity) {
+            heap[0].slot->store(-1, std::memory_order_relaxed);
+            place(0, k);
+            siftDown(0);
+        } else {
+            heap.push_back(k);
+            place(heap.size()-1, k);
+            siftUp(heap.size()-1);
+        }
+    }
+    updateFloor();
+}
+
+void SlowestEntities::Forget(Entity * ent) {
+    if (ent->costSlot.load(std::memory_order_relaxed) < 0) return;
+    std::lock_guard<std::mutex> guard(lock);
+    int32_t slot = ent->costSlot.load(std::memory_order_relaxed);
+    if (slot < 0) return;
+    removeAt(slot);
+    updateFloor();
+}
+
+void SlowestEntities::EndFrame() {
+    bool stepped = anyStepped.exchange(false, std::memory_order_relaxed);
+    bool drawn   = anyDrawn.exchange(false, std::memory_order_relaxed);
+    if (!enabled.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> guard(lock);
+    float keep = 1.f - smoothing.load(std::memory_order_relaxed);
+    for(size_t i = 0; i < heap.size(); ++i) {
+        Kept & k = heap[i];
+        if (stepped && !k.stepped) k.ent->stepCost = (k.stepMS *= keep);
+        if (drawn   && !k.drawn)   k.ent->drawCost = (k.drawMS *= keep);
+        k.stepped = false;
+        k.drawn = false;
+    }
+
+    // decaying only ever lowers keys, so the heap is rebuilt rather than patched.
+    for(size_t i = heap.size(); i > 0; --i) {
+        if (heap[i-1].Key() < negligible_ms_c) {
+            heap[i-1].slot->store(-1, std::memory_order_relaxed);
+            heap[i-1] = heap.back();
+            heap.pop_back();
+        }
+    }
+    for(size_t i = heap.size()/2; i > 0; --i) {
+        siftDown(i-1);
+    }
+    for(size_t i = 0; i < heap.size(); ++i) {
+        heap[i].slot->store(i, std::memory_order_relaxed);
+    }
+    updateFloor();
+}
+
+
+
+
+void SlowestEntities::SetEnabled(bool b) {
+    enabled = b;
+    if (!b) Clear();
+}
+
+bool SlowestEntities::IsEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void SlowestEntities::SetCount(uint32_t count) {
+    std::lock_guard<std::mutex> guard(lock);
+    capacity = count ? count : 1;
+    while(heap.size() > capacity) {
+        removeAt(0);
+    }
+    updateFloor();
+}
+
+void SlowestEntities::SetSmoothing(float s) {
+    if (s <= 0.f) s = .001f;
+    if (s > 1.f)  s = 1.f;
+    smoothing = s;
+}
+
+void SlowestEntities::SetSubtree(Entity::ID id) {
+    std::lock_guard<std::mutex> guard(lock);
+    subtree = id;
+    empty();
+    updateFloor();
+}
+
+Entity::ID SlowestEntities::GetSubtree() {
+    std::lock_guard<std::mutex> guard(lock);
+    return subtree;
+}
+
+std::vector<SlowestEntities::Entry> SlowestEntities::Get() {
+    std::vector<Entry> out;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        out.reserve(heap.size());
+        for(size_t i = 0; i < heap.size(); ++i) {
+            if (!heap[i].id.Valid()) continue;
+            out.push_back({heap[i].id, heap[i].stepMS, heap[i].drawMS});
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Entry & a, const Entry & b) {
+        return a.stepMS + a.drawMS > b.stepMS + b.drawMS;
+    });
+    return out;
+}
+
+void SlowestEntities::Clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    empty();
+    updateFloor();
+}
@@ -41,6 +41,7 @@ DEALINGS IN THE SOFTWARE.
 #ifdef DC_OS_LINUX
     #include <unistd.h>
     #include <time.h>
+    #include <errno.h>
 #endif
 
 
@@ -60,41 +61,116 @@ void Dynacoe::Time::SleepMS(size_t ms) {
 
 
 
+#ifdef DC_OS_WINDOWS
+    struct WindowsTicks {
+        LARGE_INTEGER perSecond;
+        LARGE_INTEGER start;
+    };
+
+    static WindowsTicks windowsTicksBegin() {
+        WindowsTicks out;
+        QueryPerformanceFrequency(&out.perSecond);
+        QueryPerformanceCounter(&out.start);
+        return out;
+    }
+#endif
+
+#ifdef DC_OS_LINUX
+    // CLOCK_MONOTONIC doesn't jump when NTP or the user adjusts the time.
+    static uint64_t monotonicNow() {
+        timespec time;
+        clock_gettime(CLOCK_MONOTONIC, &time);
+        return time.tv_sec * 1000000000ull + time.tv_nsec;
+    }
+
+    // initialized once, even if several threads ask first at once.
+    static uint64_t monotonicBegin() {
+        static const uint64_t begin = monotonicNow();
+        return begin;
+    }
+#endif
+
+
 double Dynacoe::Time::MsSinceStartup() {
-    static bool ticksBegin = false;
+    return NsSinceStartup() / 1000000.0;
+}
+
 
-    
+uint64_t Dynacoe::Time::NsSinceStartup() {
     #ifdef DC_OS_WINDOWS
-        static LARGE_INTEGER ticksPerSecond;
-        static LARGE_INTEGER beginTicks;
-        static LARGE_INTEGER cTicks;
-        if (!ticksBegin) {
-            QueryPerformanceFrequency(&ticksPerSecond);
-            QueryPerformanceCounter(&cTicks);
-            
-            
-            ticksBegin = true;
-        }
+        // initialized once, even if several threads ask first at once.
+        static const WindowsTicks begin = windowsTicksBegin();
+        LARGE_INTEGER cTicks;
         QueryPerformanceCounter(&cTicks);
-        return (cTicks.QuadPart - (double)beginTicks.QuadPart) * (1000.0 / (double)ticksPerSecond.QuadPart);
+        uint64_t ticks = cTicks.QuadPart - begin.start.QuadPart;
+        // split to avoid overflowing the multiply
+        return (ticks / begin.perSecond.QuadPart) * 1000000000ull + 
+               (ticks % begin.perSecond.QuadPart) * 1000000000ull / begin.perSecond.QuadPart;
     #endif
         
 
     #ifdef DC_OS_LINUX
+        uint64_t begin = monotonicBegin();
+        return monotonicNow() - begin;
+    #endif
+}
 
-        static timespec time;
-        static size_t beginTicks;
 
-        if (!ticksBegin) {
-            ticksBegin = true;
-            clock_gettime(CLOCK_REALTIME, &time);
-            beginTicks = (time.tv_nsec / 1000000.0) + (time.tv_sec *1000.0);
-        }
-        
-        clock_gettime(CLOCK_REALTIME, &time);
-        return ((time.tv_nsec / 1000000.0) + (time.tv_sec *1000.0)) - beginTicks;
+void Dynacoe::Time::SleepUntilNs(uint64_t deadline, uint64_t spinNs) {
+    uint64_t now = NsSinceStartup();
+    if (now >= deadline) return;
+
+    if (deadline - now > spinNs) {
+        #ifdef DC_OS_WINDOWS
+            // Sleep() only has millisecond resolution at best.
+            while(deadline - now > spinNs + 2000000) {
+                Sleep(1);
+                now = NsSinceStartup();
+            }
+        #endif
+
+        #ifdef DC_OS_LINUX
+            // An absolute deadline doesn't accumulate the error 
+            // of computing a relative one.
+            uint64_t wake = monotonicBegin() + deadline - spinNs;
+            timespec until;
+            until.tv_sec  = wake / 1000000000ull;
+            until.tv_nsec = wake % 1000000000ull;
+            while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, nullptr) == EINTR);
+        #endif
+    }
+
+    while(NsSinceStartup() < deadline);
+}
 
-    #endif
+
+
+static bool   virtualClock = false;
+static double virtualNow = 0;
+
+// game time minus real time, while the virtual clock is off.
+static double realOffset = 0;
+
+double Dynacoe::Time::GameMsSinceStartup() {
+    if (virtualClock) return virtualNow;
+    return MsSinceStartup() + realOffset;
 }
 
+void Dynacoe::Time::SetVirtualClock(bool enable) {
+    if (enable == virtualClock) return;
+    double now = GameMsSinceStartup();
+    virtualClock = enable;
+    if (enable) {
+        virtualNow = now;
+    } else {
+        realOffset = now - MsSinceStartup();
+    }
+}
 
+bool Dynacoe::Time::GetVirtualClock() {
+    return virtualClock;
+}
+
+void Dynacoe::Time::AdvanceVirtualClock(double ms) {
+    if (virtualClock) virtualNow += ms;
+}
@@ -57,6 +57,7 @@ Transform::Transform() {
     reverse = false;
     scale = {1, 1, 1};
     needsUpdate = true;
+    revision = 1;
 }
 
 
@@ -93,22 +94,26 @@ const Vector & Transform::GetScale() const {
 
 Vector & Transform::Rotation() {
     needsUpdate = true;
+    revision++;
     return rotation;
 }
 
 Vector & Transform::Position() {
     needsUpdate = true;
+    revision++;
     return position;
 }
 
 Vector & Transform::Scale() {
     needsUpdate = true;
+    revision++;
     return scale;
 }
 
 void Transform::SetReverseTranslation(bool d) {
     reverse = d;
     needsUpdate = true;
+    revision++;
 }
 
 
@@ -127,6 +132,10 @@ bool Transform::NeedsUpdate() const {
     return needsUpdate;
 }
 
+uint32_t Transform::GetRevision() const {
+    return revision;
+}
+
 
 void Transform::AddTransformCallback(OnTransformUpdate * cb) {
     for(uint32_t i = 0; i < callbacks.size(); ++i) {
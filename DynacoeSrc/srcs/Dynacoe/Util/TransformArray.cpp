@@ -110,8 +110,35 @@ TransformMatrix TransformArray::Compose() {
 
 TransformArray TransformArray::Lerp(const TransformArray & other, float amt) {
     TransformArray out;    
-    for(int i = 0; i < 10; ++i) {
-        out.data[i] = Mutator::StepTowards(data[i], other.data[i], amt);
+    for(int i = 0; i < 3; ++i) {
+        out.data[i]   = Mutator::StepTowards(data[i],   other.data[i],   amt);
+        out.data[7+i] = Mutator::StepTowards(data[7+i], other.data[7+i], amt);
+    }
+
+    // The rotation is blended as a rotation: along the shorter arc
+    // between the two quaternions, so the result stays a unit quaternion 
+    // instead of shrinking (and skewing the matrix) midway.
+    float dot = data[3]*other.data[3] + data[4]*other.data[4] + 
+                data[5]*other.data[5] + data[6]*other.data[6];
+    float sign = dot < 0.f ? -1.f : 1.f;
+    dot *= sign;
+
+    float from = 1.f - amt;
+    float to   = amt;
+    if (dot < .9995f) {
+        float theta = acos(dot);
+        from = sin(from*theta) / sin(theta);
+        to   = sin(to  *theta) / sin(theta);
+    }
+
+    float len = 0.f;
+    for(int i = 3; i < 7; ++i) {
+        out.data[i] = from*data[i] + to*sign*other.data[i];
+        len += out.data[i]*out.data[i];
+    }
+    len = sqrt(len);
+    for(int i = 3; i < 7; ++i) {
+        out.data[i] /= len;
     }
     return out;
 }
@@ -0,0 +1,125 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+
+/*  Measures the per-frame cost of stepping and drawing a large, 
+    static entity tree. No entities are created or removed once the 
+    tree is built, so every heap allocation counted here is overhead 
+    from the traversal itself.
+ */
+
+
+
+#include <Dynacoe/Library.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace Dynacoe;
+
+
+// Every global allocation passes through here so that 
+// the benchmark can report allocations per frame.
+static size_t allocationCount = 0;
+
+void * operator new(std::size_t size) {
+    allocationCount++;
+    void * out = malloc(size ? size : 1);
+    if (!out) throw std::bad_alloc();
+    return out;
+}
+
+void operator delete(void * ptr) noexcept {
+    free(ptr);
+}
+
+void * operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void * ptr) noexcept {
+    operator delete(ptr);
+}
+
+
+
+// A do-nothing leaf so that the measurement is of the traversal alone.
+class Node : public Entity {
+  public:
+    Node() : Entity("Node") {}
+};
+
+
+
+int main(int argc, char ** argv) {
+    const int zoneCount     = 100;
+    const int nodesPerZone  = 1000;
+    const int frameCount    = argc > 1 ? atoi(argv[1]) : 100;
+
+
+    // 100 zones of 1000 leaves each -> 100k child entities
+    Entity::ID root = Entity::Create();
+    for(int i = 0; i < zoneCount; ++i) {
+        Entity * zone = root.Identify()->CreateChild<Node>();
+        for(int n = 0; n < nodesPerZone; ++n) {
+            zone->CreateChild<Node>();
+        }
+    }
+
+
+    // one warm-up frame so any lazily-built state is in place
+    root.Identify()->Step();
+    root.Identify()->Draw();
+
+
+    size_t allocStart = allocationCount;
+    auto timeStart = std::chrono::steady_clock::now();
+    for(int i = 0; i < frameCount; ++i) {
+        root.Identify()->Step();
+        root.Identify()->Draw();
+    }
+    auto timeEnd = std::chrono::steady_clock::now();
+    size_t allocs = allocationCount - allocStart;
+
+
+    double nsPerFrame = std::chrono::duration<double, std::nano>(timeEnd - timeStart).count() / frameCount;
+    printf("entities,frames,ns_per_frame,allocations_per_frame\n");
+    printf("%d,%d,%.0f,%.2f\n", 
+        zoneCount * nodesPerZone + zoneCount + 1,
+        frameCount,
+        nsPerFrame,
+        allocs / (double)frameCount
+    );
+    return 0;
+}
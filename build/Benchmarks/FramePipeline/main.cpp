@@ -0,0 +1,134 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+/*  Measures how much of each frame's rendering is hidden behind 
+    stepping when Graphics::SetPipelined() is enabled.
+
+    Runs headless. The renderer is replaced by one that spends a fixed 
+    time on each queued 2D vertex, standing in for the cost of 
+    submitting them to a GPU, and the world spends a fixed time stepping.
+    Serially, a frame costs about the sum of the two; pipelined, 
+    about the larger of them.
+
+    Run with the argument "pipelined" to overlap rendering with stepping.
+ */
+
+
+
+#include <Dynacoe/Library.h>
+#include <Dynacoe/Backends/Renderer/NoRender_Multi.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Dynacoe;
+
+
+static const int    shapeCount      = 1000;
+static const double stepCostMS      = 4.0;
+static const double nsPerVertex     = 500.0;
+static int          frameCount      = 300;
+static double       renderNs        = 0;
+
+
+static void spin(double ns) {
+    auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds((long long)ns);
+    while(std::chrono::steady_clock::now() < until);
+}
+
+
+class BusyRenderer : public NoRenderer {
+  public:
+    BusyRenderer() : queued(0) {}
+
+    void Queue2DVertices(const uint32_t *, uint32_t count) {
+        queued += count;
+    }
+
+    void Render2DVertices(const Render2DStaticParameters &) {
+        spin(queued * nsPerVertex);
+        renderNs += queued * nsPerVertex;
+        queued = 0;
+    }
+
+  private:
+    uint32_t queued;
+};
+
+
+class World : public Entity {
+  public:
+    World() : Entity("World") {
+        for(int i = 0; i < shapeCount; ++i) {
+            Entity * e = CreateChild<Entity>();
+            e->Node().Position() = {(float)(i % 40) * 16, (float)(i / 40) * 16};
+            e->AddComponent<Shape2D>()->FormRectangle(12, 12);
+        }
+    }
+
+    void OnStep() {
+        spin(stepCostMS * 1000000.0);
+    }
+};
+
+
+
+int main(int argc, char ** argv) {
+    const bool pipelined  = argc > 1 && !strcmp(argv[1], "pipelined");
+    if (argc > 2) frameCount = atoi(argv[2]);
+
+    Engine::Startup();
+    Graphics::SetRenderer(new BusyRenderer);
+    // the new renderer needs the camera's target attached again.
+    Graphics::SetRenderCamera(Graphics::GetRenderCamera());
+    Graphics::SetPipelined(pipelined);
+
+    Engine::Root() = Entity::Create<World>();
+
+    auto timing = Engine::RunFrames(frameCount, 1000 / 60.0);
+    Graphics::SetPipelined(false);
+
+    double msPerFrame = 0;
+    for(size_t i = 0; i < timing.size(); ++i) {
+        msPerFrame += timing[i].totalMS;
+    }
+    msPerFrame /= frameCount;
+    printf("mode,frames,step_ms,render_ms,ms_per_frame\n");
+    printf("%s,%d,%.2f,%.2f,%.2f\n",
+        pipelined ? "pipelined" : "serial",
+        frameCount,
+        stepCostMS,
+        renderNs / 1000000.0 / frameCount,
+        msPerFrame
+    );
+    return 0;
+}
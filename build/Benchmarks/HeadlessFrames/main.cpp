@@ -0,0 +1,110 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+/*  Checks that the engine starts and runs frames with no window, GPU 
+    or input, as meant for headless servers, tests and benchmarks.
+
+    Build the library with the NoRender, NoDisplay and NoInput 
+    backends for this to check that configuration. It starts the 
+    engine with the library's default backends and runs frames through 
+    Engine::RunFrames(), then does the same again after swapping in a 
+    fresh renderer that has no target attached.
+
+    Exits with 1 and says why if a check fails. "make run" in this 
+    directory builds and runs it.
+ */
+
+
+
+#include <Dynacoe/Library.h>
+#include <Dynacoe/Backends/Renderer/NoRender_Multi.h>
+#include <Dynacoe/Util/Time.h>
+#include <cmath>
+#include <cstdio>
+
+using namespace Dynacoe;
+
+
+static const int    frame_count_c = 120;
+static const double frame_dt_c    = 1000 / 60.0;
+
+static int steps = 0;
+
+class Counter : public Entity {
+  public:
+    Counter() : Entity("Counter") {
+        // something to draw each frame
+        AddComponent<Shape2D>()->FormRectangle(10, 10);
+    }
+
+    void OnStep() {
+        steps++;
+    }
+};
+
+
+static bool check(bool ok, const char * what) {
+    if (!ok) printf("FAILED: %s\n", what);
+    return ok;
+}
+
+// Runs the frames and checks that each one stepped the world once and 
+// moved game time by exactly the requested amount.
+static bool runFrames() {
+    int stepsBefore = steps;
+    double gameBefore = Time::GameMsSinceStartup();
+
+    auto timing = Engine::RunFrames(frame_count_c, frame_dt_c);
+
+    bool ok = true;
+    ok &= check(timing.size() == (size_t)frame_count_c, "RunFrames() returned a timing for every frame");
+    ok &= check(steps - stepsBefore == frame_count_c,   "the root Entity stepped once per frame");
+    ok &= check(fabs((Time::GameMsSinceStartup() - gameBefore) - frame_count_c * frame_dt_c) < 1.0,
+                "game time moved by exactly the frames' time");
+    return ok;
+}
+
+
+int main() {
+    Engine::Startup();
+    printf("Renderer: %s\n", Graphics::GetRenderer()->Name().c_str());
+
+    Engine::Root() = Entity::Create<Counter>();
+
+    bool ok = runFrames();
+
+    // the camera must cope with a renderer that has no target yet.
+    Graphics::SetRenderer(new NoRenderer);
+    ok &= runFrames();
+
+    printf(ok ? "All checks passed\n" : "Some checks failed\n");
+    return ok ? 0 : 1;
+}
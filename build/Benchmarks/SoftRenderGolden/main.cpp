@@ -0,0 +1,232 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+/*  Golden-image check for the software renderer.
+
+    Draws a fixed 2D scene (flat and blended triangles and a textured 
+    quad) with the SoftRenderer into a PixelFB and compares the result 
+    against a checked-in PPM, allowing a small per-channel difference 
+    for rounding.
+
+    Usage:
+        softrender-golden [golden.ppm]            compares, exits with 1 on a mismatch
+        softrender-golden --update [golden.ppm]   rewrites the golden image
+
+    On a mismatch, the rendered frame is written to result.ppm and the 
+    differing pixels to diff.ppm. "make run" and "make update" in 
+    this directory drive the above.
+ */
+
+
+
+#include <Dynacoe/Library.h>
+#include <Dynacoe/Backends/Renderer/SoftRender_Multi.h>
+#include <Dynacoe/Backends/Framebuffer/PixelFB_Multi.h>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <string>
+
+using namespace Dynacoe;
+
+
+const int golden_w_c         = 128;
+const int golden_h_c         = 96;
+const int golden_tolerance_c = 2;
+
+
+
+static Renderer::Vertex2D vertex(float x, float y, float r, float g, float b, float a) {
+    Renderer::Vertex2D v(x, y, r, g, b, a);
+    v.texX = v.texY = 0.f;
+    v.object = -1.f;
+    return v;
+}
+
+static Renderer::Vertex2D texVertex(float x, float y, int tex, float tx, float ty) {
+    Renderer::Vertex2D v(x, y, tex, tx, ty);
+    v.object = -1.f;
+    return v;
+}
+
+static void draw(Renderer * r, const std::vector<Renderer::Vertex2D> & verts) {
+    Renderer::Render2DStaticParameters params;
+    params.contextWidth  = golden_w_c;
+    params.contextHeight = golden_h_c;
+    params.contextTransform = nullptr;
+
+    std::vector<uint32_t> ids;
+    for(size_t i = 0; i < verts.size(); ++i) {
+        uint32_t id = r->Add2DVertex();
+        r->Set2DVertex(id, verts[i]);
+        ids.push_back(id);
+    }
+    r->Queue2DVertices(&ids[0], ids.size());
+    r->Render2DVertices(params);
+    for(size_t i = 0; i < ids.size(); ++i) {
+        r->Remove2DVertex(ids[i]);
+    }
+}
+
+static void renderScene(std::vector<uint8_t> & rgb) {
+    PixelFB fb;
+    fb.Resize(golden_w_c, golden_h_c);
+
+    SoftRenderer r;
+    r.AttachTarget(&fb);
+    r.SetTextureFilter(Renderer::TexFilter::NoFilter);
+    r.ClearRenderedData();
+
+
+    // 8x8 checker, 2 texels per square
+    uint8_t checker[8*8*4];
+    for(int y = 0; y < 8; ++y) {
+        for(int x = 0; x < 8; ++x) {
+            uint8_t * p = checker + (y*8 + x)*4;
+            bool on = ((x/2) + (y/2)) % 2;
+            p[0] = on ? 255 : 20;
+            p[1] = on ? 220 : 20;
+            p[2] = on ? 40  : 90;
+            p[3] = 255;
+        }
+    }
+    int tex = r.AddTexture(8, 8, checker);
+
+
+    r.SetDrawingMode(Renderer::Polygon::Triangle, Renderer::Dimension::D_2D, Renderer::AlphaRule::Opaque);
+    draw(&r, {
+        vertex(4,  4,  1, 0, 0, 1),
+        vertex(60, 8,  0, 1, 0, 1),
+        vertex(16, 56, 0, 0, 1, 1),
+
+        texVertex(70,  10, tex, 0, 0),
+        texVertex(120, 10, tex, 1, 0),
+        texVertex(120, 60, tex, 1, 1),
+        texVertex(70,  10, tex, 0, 0),
+        texVertex(120, 60, tex, 1, 1),
+        texVertex(70,  60, tex, 0, 1)
+    });
+
+    r.SetDrawingMode(Renderer::Polygon::Triangle, Renderer::Dimension::D_2D, Renderer::AlphaRule::Allow);
+    draw(&r, {
+        vertex(30,  30, 1, 1, 1, .5f),
+        vertex(100, 40, 1, 1, 1, .5f),
+        vertex(50,  92, 1, 1, 1, .5f)
+    });
+
+
+    std::vector<uint8_t> rgba(golden_w_c*golden_h_c*4);
+    fb.GetRawData(&rgba[0]);
+    rgb.resize(golden_w_c*golden_h_c*3);
+    for(int i = 0; i < golden_w_c*golden_h_c; ++i) {
+        rgb[i*3]   = rgba[i*4];
+        rgb[i*3+1] = rgba[i*4+1];
+        rgb[i*3+2] = rgba[i*4+2];
+    }
+    r.AttachTarget(nullptr);
+}
+
+
+
+
+static bool writePPM(const std::string & path, const std::vector<uint8_t> & rgb) {
+    FILE * f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", golden_w_c, golden_h_c);
+    bool ok = fwrite(&rgb[0], 1, rgb.size(), f) == rgb.size();
+    fclose(f);
+    return ok;
+}
+
+static bool readPPM(const std::string & path, std::vector<uint8_t> & rgb) {
+    FILE * f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    int w, h, max;
+    if (fscanf(f, "P6 %d %d %d", &w, &h, &max) != 3 || w != golden_w_c || h != golden_h_c || max != 255) {
+        fclose(f);
+        return false;
+    }
+    fgetc(f); // single whitespace before the pixels
+    rgb.resize(w*h*3);
+    bool ok = fread(&rgb[0], 1, rgb.size(), f) == rgb.size();
+    fclose(f);
+    return ok;
+}
+
+
+
+
+int main(int argc, char ** argv) {
+    bool update = argc > 1 && !strcmp(argv[1], "--update");
+    std::string path = argc > (update ? 2 : 1) ? argv[update ? 2 : 1] : "golden.ppm";
+
+    std::vector<uint8_t> result;
+    renderScene(result);
+
+    if (update) {
+        if (!writePPM(path, result)) {
+            printf("Could not write %s\n", path.c_str());
+            return 1;
+        }
+        printf("Wrote %s\n", path.c_str());
+        return 0;
+    }
+
+    std::vector<uint8_t> golden;
+    if (!readPPM(path, golden)) {
+        printf("Could not read %s as a %dx%d PPM\n", path.c_str(), golden_w_c, golden_h_c);
+        return 1;
+    }
+
+    std::vector<uint8_t> diff(result.size(), 0);
+    int bad = 0;
+    for(int i = 0; i < golden_w_c*golden_h_c; ++i) {
+        bool differs = false;
+        for(int c = 0; c < 3; ++c) {
+            if (abs(result[i*3+c] - golden[i*3+c]) > golden_tolerance_c)
+                differs = true;
+        }
+        if (differs) {
+            diff[i*3] = 255;
+            bad++;
+        }
+    }
+
+    if (bad) {
+        writePPM("result.ppm", result);
+        writePPM("diff.ppm", diff);
+        printf("%d of %d pixels differ from %s (see result.ppm, diff.ppm)\n", bad, golden_w_c*golden_h_c, path.c_str());
+        return 1;
+    }
+    printf("Matches %s\n", path.c_str());
+    return 0;
+}
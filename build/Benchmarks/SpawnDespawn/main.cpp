@@ -0,0 +1,126 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+
+
+
+/*  Measures spawning and removing many short-lived entities, 
+    each with a component, as happens with bullets and particles.
+
+    Run with the argument "system" to bypass the Entity / Component 
+    slab pools and use the system allocator, for comparison.
+ */
+
+
+
+#include <Dynacoe/Library.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Dynacoe;
+
+
+class Bullet : public Entity {
+  public:
+    Bullet() : Entity("Bullet") {
+        lifetime = AddComponent<Clock>();
+        lifetime->Set(1000);
+    }
+
+    void OnStep() {
+        Node().Position().x += 1;
+    }
+
+  private:
+    Clock * lifetime;
+    float damage[8];
+};
+
+
+
+int main(int argc, char ** argv) {
+    const bool useSystem = argc > 1 && !strcmp(argv[1], "system");
+    const int  waveSize  = 10000;
+    const int  waveCount = 200;
+
+    // must be decided before the first Entity is allocated.
+    if (useSystem) setenv("DYNACOE_NO_SLAB", "1", 1);
+
+
+    Entity::ID root = Entity::Create();
+    std::vector<Entity::ID> wave(waveSize);
+
+    auto timeStart = std::chrono::steady_clock::now();
+    for(int i = 0; i < waveCount; ++i) {
+        for(int n = 0; n < waveSize; ++n) {
+            wave[n] = root.Identify()->CreateChild<Bullet>()->GetID();
+        }
+
+        root.Identify()->Step();
+
+        for(int n = 0; n < waveSize; ++n) {
+            wave[n].Identify()->Remove();
+        }
+
+        // removed entities are reclaimed here, as the engine 
+        // does at the end of each frame
+        Entity::ReclaimRemoved();
+    }
+    auto timeEnd = std::chrono::steady_clock::now();
+
+
+    double nsPerEntity = std::chrono::duration<double, std::nano>(timeEnd - timeStart).count() / (waveSize * (double)waveCount);
+    printf("allocator,entities,ns_per_spawn_despawn\n");
+    printf("%s,%d,%.1f\n", 
+        useSystem ? "system" : "slab",
+        waveSize * waveCount,
+        nsPerEntity
+    );
+
+
+    printf("\npool,block_size,live,peak,slabs\n");
+    const SlabAllocator * pools[] = {&Entity::GetAllocator(), &Component::GetAllocator()};
+    for(int i = 0; i < 2; ++i) {
+        auto stats = pools[i]->GetStats();
+        for(size_t n = 0; n < stats.size(); ++n) {
+            printf("%s,%u,%llu,%llu,%llu\n",
+                pools[i]->GetName(),
+                stats[n].blockSize,
+                (unsigned long long)stats[n].live,
+                (unsigned long long)stats[n].peak,
+                (unsigned long long)stats[n].slabs
+            );
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,606 @@
+/*
+
+Copyright (c) 2018, Johnathan Corkery. (jcorkery@umich.edu)
+All rights reserved.
+
+This file is part of the Dynacoe project (https://github.com/jcorks/Dynacoe)
+Dynacoe was released under the MIT License, as detailed below.
+
+
+
+Permission is hereby granted, free of charge, to any person obtaining a copy 
+of this software and associated documentation files (the "Software"), to deal 
+in the Software without restriction, including without limitation the rights 
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+copies of the Software, and to permit persons to whom the Software is furnished 
+to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, 
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF 
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. 
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, 
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+DEALINGS IN THE SOFTWARE.
+
+
+
+*/
+/*  A set of headless scenes for catching performance regressions.
+
+    Each scene is run with the NoRender renderer and the NoAudio 
+    audio manager, except sprites-batch-soft, which rasterizes with the 
+    SoftRenderer. Each reports as one CSV row:
+
+        scene,frames,ns_per_frame,allocs_per_frame,peak_rss_kb
+
+    Scenes that run the engine time whole frames through Engine::RunFrames().
+    For scenes that don't, a "frame" is one iteration of the work they 
+    measure: loading an asset, or a DataTable round-trip. The audio scene 
+    times each pass of the mixer, as recorded by the Profiler.
+
+    Usage:
+        suite --list                              lists the scenes
+        suite <scene> <results.csv>               runs a scene, appending its row
+        suite --compare <baseline.csv> <results.csv> [tolerance %]
+
+    Compare exits with 1 if any scene got slower or allocates more than 
+    the tolerance (10% by default) allows. "make run", "make baseline" 
+    and "make compare" in this directory drive all of the above.
+ */
+
+
+
+#include <Dynacoe/Library.h>
+#include <Dynacoe/Backends/Renderer/NoRender_Multi.h>
+#include <Dynacoe/Backends/Renderer/SoftRender_Multi.h>
+#include <Dynacoe/Backends/Framebuffer/PixelFB_Multi.h>
+#include <Dynacoe/AudioBlock.h>
+#include <Dynacoe/Components/DataTable.h>
+#include <Dynacoe/Util/Profiler.h>
+#include <Dynacoe/Util/Time.h>
+#include <sys/resource.h>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <new>
+#include <sstream>
+
+using namespace Dynacoe;
+
+
+// Every allocation made through new, from any thread.
+static std::atomic<uint64_t> allocations(0);
+
+void * operator new(std::size_t size) {
+    allocations++;
+    void * out = malloc(size ? size : 1);
+    if (!out) throw std::bad_alloc();
+    return out;
+}
+
+void * operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void * p) noexcept {
+    free(p);
+}
+
+void operator delete[](void * p) noexcept {
+    free(p);
+}
+
+
+
+
+struct Result {
+    int frames;
+    double nsPerFrame;
+    double allocsPerFrame;
+};
+
+
+// Runs the engine for the given number of frames after a short warmup.
+static Result runFrames(int frames) {
+    Engine::RunFrames(10, 1000 / 60.0);
+
+    uint64_t allocs = allocations;
+    auto timing = Engine::RunFrames(frames, 1000 / 60.0);
+    allocs = allocations - allocs;
+
+    double ms = 0;
+    for(size_t i = 0; i < timing.size(); ++i) {
+        ms += timing[i].totalMS;
+    }
+    return {frames, ms * 1000000.0 / frames, allocs / (double)frames};
+}
+
+
+static std::vector<uint8_t> readFile(const std::string & path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in.is_open()) {
+        fprintf(stderr, "Could not open %s\n", path.c_str());
+        exit(1);
+    }
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+
+
+
+///// static-shapes: 100k Shape2Ds that never move.
+
+static Result sceneStaticShapes() {
+    Entity * world = Entity::Create().Identify();
+    for(int i = 0; i < 100000; ++i) {
+        Entity * e = world->CreateChild<Entity>();
+        e->Node().Position() = {(float)(i % 400) * 4, (float)(i / 400) * 4};
+        e->AddComponent<Shape2D>()->FormRectangle(3, 3);
+    }
+    Engine::Root() = world->GetID();
+    return runFrames(60);
+}
+
+
+
+///// moving-objects: 20k Object2Ds bouncing around a box, colliding.
+
+class Mover : public Entity {
+  public:
+    Mover() : Entity("Mover") {
+        Node().Position() = {Random::Spread(0, 2000), Random::Spread(0, 2000)};
+        object = AddComponent<Object2D>();
+        object->collider = Object2D::Collider(3, 6);
+        object->SetVelocity(Random::Spread(.5, 2), Random::Spread(0, 360));
+    }
+
+    void OnStep() {
+        const Vector & p = Node().GetPosition();
+        if (p.x < 0 || p.x > 2000 || p.y < 0 || p.y > 2000) {
+            object->SetVelocityTowards(object->GetSpeed(), {1000, 1000});
+        }
+    }
+
+  private:
+    Object2D * object;
+};
+
+static Result sceneMovingObjects() {
+    Entity * world = Entity::Create().Identify();
+    for(int i = 0; i < 20000; ++i) {
+        world->CreateChild<Mover>();
+    }
+    Engine::Root() = world->GetID();
+    return runFrames(60);
+}
+
+
+
+///// particles: an emitter spawning 200 particles every frame.
+
+static const char * particleSpec = 
+    "image_name:SPHERE$SYS\n"
+    "duration_max: 120\n"
+    "duration_min: 60\n"
+    "alpha_max: 255\n"
+    "alpha_min: 255\n"
+    "alpha_delta_max: -2\n"
+    "alpha_delta_min: -3\n"
+    "direction_min: 0\n"
+    "direction_max: 360\n"
+    "speed_min: .4\n"
+    "speed_max: 2\n"
+    "red_max: 255\n"
+    "red_min: 200\n"
+    "green_max: 200\n"
+    "green_min: 100\n";
+
+class Storm : public Entity {
+  public:
+    Storm() : Entity("Storm") {
+        std::string spec(particleSpec);
+        particle = Assets::LoadFromBuffer("part", "bench-particle", std::vector<uint8_t>(spec.begin(), spec.end()));
+        emitter = CreateChild<ParticleEmitter2D>();
+        emitter->Node().Position() = {400, 300};
+    }
+
+    void OnStep() {
+        emitter->EmitParticle(particle, 200);
+    }
+
+  private:
+    AssetID particle;
+    ParticleEmitter2D * emitter;
+};
+
+static Result sceneParticles() {
+    Engine::Root() = Entity::Create<Storm>();
+    return runFrames(240);
+}
+
+
+
+///// sprites-shapes: 200k textured quads as Shape2Ds, all moving each frame.
+///// sprites-batch:  the same quads as one SpriteBatch2D.
+///// sprites-batch-soft: sprites-batch, rasterized by the SoftRenderer.
+
+static const int sprite_count_c = 200000;
+
+static Vector spritePosition(int i, int frame) {
+    return {(float)(i % 500) * 4 + (float)((i + frame) % 8), (float)(i / 500) * 4};
+}
+
+class ShapeSprites : public Entity {
+  public:
+    ShapeSprites() : Entity("ShapeSprites") {
+        AssetID image = Assets::Query(Assets::Type::Image, "SPHERE$SYS");
+        for(int i = 0; i < sprite_count_c; ++i) {
+            Entity * e = CreateChild<Entity>();
+            e->AddComponent<Shape2D>()->FormImage(image);
+            shapes.push_back(e);
+        }
+        frame = 0;
+    }
+
+    void OnStep() {
+        frame++;
+        for(int i = 0; i < sprite_count_c; ++i) {
+            shapes[i]->Node().Position() = spritePosition(i, frame);
+        }
+    }
+
+  private:
+    std::vector<Entity *> shapes;
+    int frame;
+};
+
+class BatchSprites : public Entity {
+  public:
+    BatchSprites() : Entity("BatchSprites") {
+        AssetID image = Assets::Query(Assets::Type::Image, "SPHERE$SYS");
+        batch = AddComponent<SpriteBatch2D>();
+        for(int i = 0; i < sprite_count_c; ++i) {
+            batch->Add(image);
+        }
+        frame = 0;
+    }
+
+    void OnStep() {
+        frame++;
+        for(int i = 0; i < sprite_count_c; ++i) {
+            batch->Set(i, spritePosition(i, frame));
+        }
+    }
+
+  private:
+    SpriteBatch2D * batch;
+    int frame;
+};
+
+static Result sceneSpritesShapes() {
+    Engine::Root() = Entity::Create<ShapeSprites>();
+    return runFrames(30);
+}
+
+static Result sceneSpritesBatch() {
+    Engine::Root() = Entity::Create<BatchSprites>();
+    return runFrames(30);
+}
+
+static Result sceneSpritesBatchSoft() {
+    Graphics::SetRenderer(new SoftRenderer);
+    // the new renderer needs the camera's target attached again.
+    Graphics::SetRenderCamera(Graphics::GetRenderCamera());
+
+    // Only pixel array framebuffers can be drawn to in software, but
+    // builds without the software renderer don't create them by default.
+    // The frames are then drawn into a pixel array of the camera's size 
+    // instead, which is never cleared or shown.
+    static PixelFB pixels;
+    Framebuffer * fb = Graphics::GetRenderCamera().GetFramebuffer();
+    if (!fb || fb->GetHandleType() != Framebuffer::Type::RGBA_PixelArray) {
+        int w = Graphics::GetRenderCamera().Width();
+        int h = Graphics::GetRenderCamera().Height();
+        pixels.Resize(w > 0 ? w : 640, h > 0 ? h : 480);
+        Graphics::GetRenderer()->AttachTarget(&pixels);
+    }
+
+    Engine::Root() = Entity::Create<BatchSprites>();
+    return runFrames(30);
+}
+
+
+
+///// audio-mix: 256 voices playing at once.
+
+static Result sceneAudioMix() {
+    // NoAudio only runs the mixer once it has a sample rate.
+    Sound::GetManager()->SetSampleRate(44100);
+
+    AssetID id = Assets::New(Assets::Type::Audio, "bench-tone");
+    std::vector<AudioSample> samples(44100 * 10);
+    for(size_t i = 0; i < samples.size(); ++i) {
+        int16_t v = (int16_t)(sin(i * 0.0626) * 8000);
+        samples[i] = AudioSample(v, v);
+    }
+    Assets::Get<AudioBlock>(id).Define(samples.data(), samples.size());
+
+    for(int i = 0; i < 256; ++i) {
+        Sound::PlayAudio(id, 0, 1.f / 256, i / 255.f);
+    }
+
+
+    // the mixer runs on its own thread about every 16ms, 
+    // so this scene runs in real time.
+    Profiler::SetEnabled(true);
+    const int frames = 120;
+    uint64_t mixNs = 0;
+    uint64_t mixCount = 0;
+    uint64_t allocs = allocations;
+    for(int i = 0; i < frames; ++i) {
+        Engine::RunFrames(1, 1000 / 60.0);
+        const std::vector<Profiler::Zone> & zones = Profiler::GetLastFrame();
+        for(size_t n = 0; n < zones.size(); ++n) {
+            if (strcmp(zones[n].category, "Audio")) continue;
+            mixNs += zones[n].endNs - zones[n].beginNs;
+            mixCount++;
+        }
+        Time::SleepMS(16);
+    }
+    allocs = allocations - allocs;
+    Profiler::SetEnabled(false);
+
+    return {frames, mixCount ? mixNs / (double)mixCount : 0.0, allocs / (double)frames};
+}
+
+
+
+///// asset-loading: decoding the same PNG and sound file many times over.
+
+static Result sceneAssetLoading() {
+    // the example assets double as test data.
+    std::vector<uint8_t> png = readFile("../../Examples/4-Images/image.png");
+    std::vector<uint8_t> wav = readFile("../../Examples/5-SoundEffects/kick.wav");
+    const int count = 200;
+
+    uint64_t allocs = allocations;
+    uint64_t start = Time::NsSinceStartup();
+    for(int i = 0; i < count; ++i) {
+        if (!Assets::LoadFromBuffer("png", Chain() << "bench-image-" << i, png).Valid() ||
+            !Assets::LoadFromBuffer("wav", Chain() << "bench-sound-" << i, wav).Valid()) {
+            fprintf(stderr, "Asset failed to load\n");
+            exit(1);
+        }
+    }
+    uint64_t end = Time::NsSinceStartup();
+    allocs = allocations - allocs;
+
+    return {count*2, (end - start) / (count*2.0), allocs / (count*2.0)};
+}
+
+
+
+///// deep-hierarchy: 20 chains 500 Entities deep, each moved at the root every frame.
+
+class Swinger : public Entity {
+  public:
+    Swinger() : Entity("Swinger"), t(0) {}
+
+    void OnStep() {
+        t += .05f;
+        Node().Position().x = sin(t) * 10;
+        Node().Rotation().z = t;
+    }
+
+  private:
+    float t;
+};
+
+static Result sceneDeepHierarchy() {
+    Entity * world = Entity::Create().Identify();
+    for(int i = 0; i < 20; ++i) {
+        Entity * e = world->CreateChild<Swinger>();
+        for(int depth = 1; depth < 500; ++depth) {
+            e = e->CreateChild<Entity>();
+            e->Node().Position() = {1, 0};
+        }
+    }
+    Engine::Root() = world->GetID();
+    return runFrames(120);
+}
+
+
+
+///// datatable: writing a table, serializing it, and reading it back.
+
+static Result sceneDataTable() {
+    const int count = 2000;
+    DataTable table;
+    DataTable copy;
+    std::vector<std::string> names;
+    for(int i = 0; i < 200; ++i) {
+        names.push_back(Chain() << "value" << i);
+    }
+
+    uint64_t allocs = allocations;
+    uint64_t start = Time::NsSinceStartup();
+    for(int i = 0; i < count; ++i) {
+        table.Clear();
+        for(size_t n = 0; n < names.size(); ++n) {
+            if (n % 4) {
+                table.Write(names[n], (int)(i + n));
+            } else {
+                table.Write(names[n], names[n]);
+            }
+        }
+
+        copy.ReadState(table.WriteState());
+
+        int value = 0;
+        copy.Read(names[1], value);
+        if (value != i + 1) {
+            fprintf(stderr, "DataTable round-trip failed\n");
+            exit(1);
+        }
+    }
+    uint64_t end = Time::NsSinceStartup();
+    allocs = allocations - allocs;
+
+    return {count, (end - start) / (double)count, allocs / (double)count};
+}
+
+
+
+
+struct Scene {
+    const char * name;
+    Result (*run)();
+};
+
+static const Scene scenes[] = {
+    {"static-shapes",   sceneStaticShapes},
+    {"moving-objects",  sceneMovingObjects},
+    {"particles",       sceneParticles},
+    {"audio-mix",       sceneAudioMix},
+    {"asset-loading",   sceneAssetLoading},
+    {"deep-hierarchy",  sceneDeepHierarchy},
+    {"datatable",       sceneDataTable},
+    {"sprites-shapes",  sceneSpritesShapes},
+    {"sprites-batch",   sceneSpritesBatch},
+    {"sprites-batch-soft", sceneSpritesBatchSoft},
+};
+
+static const char * header = "scene,frames,ns_per_frame,allocs_per_frame,peak_rss_kb";
+
+
+
+
+struct Row {
+    double nsPerFrame;
+    double allocsPerFrame;
+    double peakRSS;
+};
+
+static std::map<std::string, Row> readResults(const char * path) {
+    std::map<std::string, Row> out;
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        fprintf(stderr, "Could not open %s\n", path);
+        exit(1);
+    }
+
+    std::string line;
+    std::getline(in, line); // header
+    while(std::getline(in, line)) {
+        for(size_t i = 0; i < line.size(); ++i) {
+            if (line[i] == ',') line[i] = ' ';
+        }
+        std::istringstream fields(line);
+        std::string name;
+        int frames;
+        Row row;
+        if (fields >> name >> frames >> row.nsPerFrame >> row.allocsPerFrame >> row.peakRSS)
+            out[name] = row;
+    }
+    return out;
+}
+
+// Returns whether the metric grew by more than the tolerance.
+static bool compareMetric(const std::string & scene, const char * metric, double base, double cur, double tolerance) {
+    double change = base > 0 ? (cur - base) / base * 100.0 : (cur > 0 ? 100.0 : 0.0);
+    bool regressed = change > tolerance;
+    printf("%s,%s,%.2f,%.2f,%+.1f%%%s\n", scene.c_str(), metric, base, cur, change, regressed ? ",REGRESSED" : "");
+    return regressed;
+}
+
+static int compare(const char * basePath, const char * curPath, double tolerance) {
+    std::map<std::string, Row> base = readResults(basePath);
+    std::map<std::string, Row> cur  = readResults(curPath);
+
+    bool regressed = false;
+    printf("scene,metric,baseline,current,change\n");
+    for(auto it = cur.begin(); it != cur.end(); ++it) {
+        auto b = base.find(it->first);
+        if (b == base.end()) {
+            printf("%s,,,,new\n", it->first.c_str());
+            continue;
+        }
+        regressed |= compareMetric(it->first, "ns_per_frame",     b->second.nsPerFrame,     it->second.nsPerFrame,     tolerance);
+        regressed |= compareMetric(it->first, "allocs_per_frame", b->second.allocsPerFrame, it->second.allocsPerFrame, tolerance);
+        compareMetric(it->first, "peak_rss_kb", b->second.peakRSS, it->second.peakRSS, tolerance);
+    }
+    return regressed ? 1 : 0;
+}
+
+
+
+
+int main(int argc, char ** argv) {
+    const int sceneCount = sizeof(scenes) / sizeof(Scene);
+    if (argc > 1 && !strcmp(argv[1], "--list")) {
+        for(int i = 0; i < sceneCount; ++i) {
+            printf("%s\n", scenes[i].name);
+        }
+        return 0;
+    }
+
+    if (argc > 3 && !strcmp(argv[1], "--compare")) {
+        return compare(argv[2], argv[3], argc > 4 ? atof(argv[4]) : 10.0);
+    }
+
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s --list | <scene> <results.csv> | --compare <baseline.csv> <results.csv> [tolerance %%]\n", argv[0]);
+        return 1;
+    }
+
+    const Scene * scene = nullptr;
+    for(int i = 0; i < sceneCount; ++i) {
+        if (!strcmp(argv[1], scenes[i].name)) scene = scenes + i;
+    }
+    if (!scene) {
+        fprintf(stderr, "No scene named %s\n", argv[1]);
+        return 1;
+    }
+
+
+    Engine::Startup();
+    Graphics::SetRenderer(new NoRenderer);
+    // the new renderer needs the camera's target attached again.
+    Graphics::SetRenderCamera(Graphics::GetRenderCamera());
+    Random::Seed(1);
+
+    Result result = scene->run();
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // the header is only written to a new file.
+    bool fresh;
+    {
+        std::ifstream existing(argv[2]);
+        fresh = !existing.is_open() || existing.peek() == std::ifstream::traits_type::eof();
+    }
+    FILE * out = fopen(argv[2], "a");
+    if (!out) {
+        fprintf(stderr, "Could not open %s\n", argv[2]);
+        return 1;
+    }
+    if (fresh) fprintf(out, "%s\n", header);
+    fprintf(out, "%s,%d,%.1f,%.2f,%ld\n",
+        scene->name,
+        result.frames,
+        result.nsPerFrame,
+        result.allocsPerFrame,
+        usage.ru_maxrss
+    );
+    fclose(out);
+    return 0;
+}
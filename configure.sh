@@ -46,12 +46,14 @@ buildTypes="Static Dynamic"
 renderers="
 ShaderGL_X11
 ShaderGL_Win32
+SoftRender
 NoRender
 "
 
 displays="
 OpenGLFramebuffer_X11
 OpenGLFramebuffer_Win32
+Pixmap_X11
 NoDisplay
 "
 
@@ -88,6 +90,7 @@ BEGIN ShaderGL_X11 X11 END
 BEGIN ShaderGL_Win32 Win32 END
 BEGIN OpenGLFramebuffer_X11 X11 END
 BEGIN OpenGLFramebuffer_Win32 Win32 END
+BEGIN Pixmap_X11 X11 END
 BEGIN X11Input_X11 X11 END
 BEGIN GainputX11 X11 END
 BEGIN GainputWin32 Win32 END
@@ -96,6 +99,7 @@ BEGIN RtAudioOSS Pulse END
 BEGIN RtAudioDirectSound DirectSound END
 BEGIN NoInput ANY END
 BEGIN NoDisplay ANY END
+BEGIN SoftRender ANY END
 BEGIN NoRender ANY END
 BEGIN NoAudio ANY END
 BEGIN ExtraDecoders ANY END
@@ -111,6 +115,7 @@ BEGIN ShaderGL_X11    -lGLEW -lGL  END
 BEGIN ShaderGL_Win32  -lglew-dc -lOpenGL32 END
 BEGIN OpenGLFramebuffer_X11    -lGLEW -lGL  END
 BEGIN OpenGLFramebuffer_Win32  -lglew-dc -lOpenGL32  END
+BEGIN Pixmap_X11 END
 BEGIN X11Input_X11 END
 BEGIN GainputX11   -lgainputstatic END
 BEGIN GainputWin32 -lgainputstatic-dc -lkernel32 -luser32 -lgdi32 -lXinput9_1_0 END
@@ -118,6 +123,7 @@ BEGIN RtAudioAlsa -lpthread END
 BEGIN RtAudioOSS  END
 BEGIN RtAudioDirectSound END
 BEGIN NoInput END
+BEGIN SoftRender -lpthread END
 BEGIN NoRender END
 BEGIN NoDisplay END
 BEGIN NoAudio END
@@ -133,7 +139,7 @@ BEGIN ANY  END
 #TODO: make specific option equivalents for multiple compilers
 CompilerOpts="
 BEGIN Windows -std=c++11 -lpthread  -static -static-libgcc -static-libstdc++ -mwindows END
-BEGIN Linux -std=c++11  -lpthread -I/usr/include/freetype2 -I/usr/include/freetype2/freetype END
+BEGIN Linux -std=c++11  -lpthread -lrt -I/usr/include/freetype2 -I/usr/include/freetype2/freetype END
 BEGIN Debug  -ggdb -pg END
 BEGIN Release  -O2 END
 BEGIN UnixLike -std=c++11 END
@@ -180,6 +186,7 @@ BEGIN ShaderGL_X11                -DDC_BACKENDS_SHADERGL_X11 END
 BEGIN ShaderGL_Win32              -DDC_BACKENDS_SHADERGL_WIN32 END
 BEGIN OpenGLFramebuffer_X11     -DDC_BACKENDS_OPENGLFRAMEBUFFER_X11 END
 BEGIN OpenGLFramebuffer_Win32   -DDC_BACKENDS_OPENGLFRAMEBUFFER_WIN32 END
+BEGIN Pixmap_X11                -DDC_BACKENDS_PIXMAP_X11 END
 BEGIN X11Input_X11               -DDC_BACKENDS_X11INPUT_X11 END
 BEGIN GainputX11                 -DDC_BACKENDS_GAINPUTX11 END
 BEGIN GainputWin32               -DDC_BACKENDS_GAINPUTWIN32 END
@@ -188,6 +195,7 @@ BEGIN RtAudioOSS                 -DDC_BACKENDS_RTAUDIO_OSS END
 BEGIN RtAudioDirectSound         -DDC_BACKENDS_RTAUDIO_WIN32 END
 BEGIN NoInput                    -DDC_BACKENDS_NOINPUT END
 BEGIN NoDisplay                  -DDC_BACKENDS_NODISPLAY END
+BEGIN SoftRender                 -DDC_BACKENDS_SOFTRENDER END
 BEGIN NoRender                   -DDC_BACKENDS_NORENDER END
 BEGIN NoAudio                    -DDC_BACKENDS_NOAUDIO END
 BEGIN Win32                      -DDC_SUBSYSTEM_WIN32 END